@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "scene/Entity.h"
+#include "scene/EntityQuery.h"
+
+// Compares the SceneView iteration that copied the entity list on every step
+// with the iteration over the cached dense entity lists of the QueryCache.
+
+#define CURRENT_MICROS                                                         \
+    (std::chrono::duration_cast<std::chrono::microseconds>(                    \
+        std::chrono::steady_clock::now().time_since_epoch()))
+
+// two components that roughly every second entity has, like the ModelComponent
+// and Transformation of level geometry
+static const int COMPONENT_A = 0;
+static const int COMPONENT_B = 1;
+
+static bool legacyEntityValid(Entity& entity, ComponentMask mask) {
+    return entity.active && mask == (mask & entity.componentMask);
+}
+
+// copy of the old SceneView loop, which copies all entities on every step
+static uint64_t legacyIteration(std::vector<Entity>& sceneEntities, ComponentMask mask) {
+    uint64_t checksum = 0;
+    EntityId index    = 0;
+    auto     entities = sceneEntities;
+    while(index < entities.size() && !legacyEntityValid(entities[index], mask)) {
+        index++;
+    }
+
+    while(index < sceneEntities.size()) {
+        checksum += index;
+
+        auto stepEntities = sceneEntities;
+        do {
+            index++;
+        } while(index < stepEntities.size()
+                && !legacyEntityValid(stepEntities[index], mask));
+    }
+    return checksum;
+}
+
+static uint64_t cachedIteration(const EntityQuery& query) {
+    uint64_t checksum = 0;
+    for(EntityId id : query.entities) {
+        checksum += id;
+    }
+    return checksum;
+}
+
+static void runBenchmark(size_t entityCount, int legacyRuns, int cachedRuns) {
+    std::vector<Entity> entities(entityCount);
+    QueryCache          queryCache;
+
+    ComponentMask mask;
+    mask.set(COMPONENT_A);
+    mask.set(COMPONENT_B);
+
+    const EntityQuery& query = queryCache.getQuery(mask, entities);
+
+    for(EntityId id = 0; id < entityCount; id++) {
+        entities[id].componentMask.set(COMPONENT_A);
+        if(id % 2 == 0) {
+            entities[id].componentMask.set(COMPONENT_B);
+        }
+        queryCache.entityChanged(id, entities[id]);
+    }
+
+    uint64_t legacyChecksum = 0;
+    auto     start          = CURRENT_MICROS;
+    for(int i = 0; i < legacyRuns; i++) {
+        legacyChecksum += legacyIteration(entities, mask);
+    }
+    double legacyMicros = (CURRENT_MICROS - start).count() / double(legacyRuns);
+
+    uint64_t cachedChecksum = 0;
+    start                   = CURRENT_MICROS;
+    for(int i = 0; i < cachedRuns; i++) {
+        cachedChecksum += cachedIteration(query);
+    }
+    double cachedMicros = (CURRENT_MICROS - start).count() / double(cachedRuns);
+
+    if(legacyChecksum / legacyRuns != cachedChecksum / cachedRuns) {
+        std::cout << "checksum mismatch for " << entityCount << " entities\n";
+    }
+
+    std::cout << entityCount << " entities: legacy " << legacyMicros
+              << " us, cached " << cachedMicros << " us, speedup "
+              << legacyMicros / std::max(cachedMicros, 0.001) << "x\n";
+}
+
+int main() {
+    // the legacy iteration is quadratic, so it only runs a few times
+    runBenchmark(10000, 5, 10000);
+    runBenchmark(100000, 1, 1000);
+
+    return 0;
+}
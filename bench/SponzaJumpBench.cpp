@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "box2d/box2d.h"
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "glm/trigonometric.hpp"
+#include "game/PlayerComponent.h"
+#include "physics/PhysicsComponent.h"
+#include "physics/PhysicsSync.h"
+#include "rendering/DrawList.h"
+#include "scene/EntityRegistry.h"
+#include "scene/FrustumCulling.h"
+#include "scene/ModelComponent.h"
+#include "utils/ThreadPool.h"
+
+// Benchmarks of the entity component system and the scene systems that do not
+// need Vulkan. Prints the results as JSON, or writes them to the file given as
+// first argument, so the output of two commits can be diffed.
+//
+// usage: SponzaJumpBench [output.json]
+
+#define CURRENT_NANOS                                                          \
+    (std::chrono::duration_cast<std::chrono::nanoseconds>(                     \
+        std::chrono::steady_clock::now().time_since_epoch()))
+
+static const size_t ENTITY_COUNTS[] = {1000, 10000, 100000};
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::string storageMode;
+    size_t      entityCount;
+    int         runs;
+    // median over all runs
+    double nanosPerRun;
+};
+
+static const char* getStorageModeName(StorageMode storageMode) {
+    return storageMode == StorageMode::Archetype ? "archetype" : "sparse_set";
+}
+
+// Calls setup() (not measured) and run() "runs" times and returns the median
+// duration of run(). setup() runs before every run, so benchmarks that change
+// the registry always start from the same state.
+static double measure(int runs, const std::function<void()>& setup, const std::function<void()>& run) {
+    std::vector<double> durations;
+    for(int i = 0; i < runs; i++) {
+        setup();
+
+        auto start = CURRENT_NANOS;
+        run();
+        durations.push_back(static_cast<double>((CURRENT_NANOS - start).count()));
+    }
+
+    std::sort(durations.begin(), durations.end());
+    return durations[durations.size() / 2];
+}
+
+// a level like scene: all entities have a model, a transformation and bounds,
+// they are lined up along the x axis like in the side scroller, every fourth
+// has physics and one of them is the player
+static std::vector<EntityId> createLevelEntities(EntityRegistry& registry, size_t count) {
+    std::vector<EntityId> ids =
+        registry.createEntities<ModelComponent, Transformation, BoundsComponent>(count);
+    for(size_t i = 0; i < ids.size(); i++) {
+        auto* bounds         = registry.getComponent<BoundsComponent>(ids[i]);
+        bounds->local.min    = glm::vec3(-1);
+        bounds->local.max    = glm::vec3(1);
+        bounds->local.radius = std::sqrt(3.0f);
+
+        auto* transformation          = registry.getComponent<Transformation>(ids[i]);
+        transformation->translation.x = 2.0f * static_cast<float>(i);
+        registry.markTransformationChanged(ids[i], *transformation);
+    }
+    registry.updateTransformations();
+
+    for(size_t i = 0; i < ids.size(); i += 4) {
+        registry.assign<PhysicsComponent>(ids[i]);
+    }
+    registry.assign<PlayerComponent>(ids[0]);
+    return ids;
+}
+
+static void runBenchmarks(StorageMode storageMode, size_t entityCount,
+                          ThreadPool& threadPool, std::vector<BenchmarkResult>& results) {
+    const int runs = entityCount >= 100000 ? 5 : 21;
+
+    std::unique_ptr<EntityRegistry> registry;
+    std::vector<EntityId>           ids;
+
+    auto addResult = [&](const std::string& name, double nanos) {
+        results.push_back({name, getStorageModeName(storageMode), entityCount, runs, nanos});
+    };
+    auto freshRegistry = [&]() {
+        registry = std::make_unique<EntityRegistry>(storageMode);
+    };
+    auto levelRegistry = [&]() {
+        freshRegistry();
+        ids = createLevelEntities(*registry, entityCount);
+    };
+
+    addResult("create_entities", measure(runs, freshRegistry, [&]() {
+                  for(size_t i = 0; i < entityCount; i++) {
+                      registry->addEntity();
+                  }
+              }));
+
+    addResult("create_entities_bulk", measure(runs, freshRegistry, [&]() {
+                  registry->createEntities<ModelComponent, Transformation>(entityCount);
+              }));
+
+    addResult("assign_components", measure(runs, freshRegistry, [&]() {
+                  for(size_t i = 0; i < entityCount; i++) {
+                      EntityId id = registry->addEntity();
+                      registry->assign<ModelComponent>(id)->modelIndex = static_cast<int>(i);
+                      registry->assign<Transformation>(id);
+                  }
+              }));
+
+    addResult("destroy_entities", measure(runs, levelRegistry, [&]() {
+                  registry->destroyEntities(ids);
+              }));
+
+    levelRegistry();
+
+    // queries are built by the first view that uses them, which is not measured
+    registry->getQuery(getComponentMask<ModelComponent, Transformation>());
+    registry->getQuery(getComponentMask<Transformation, PhysicsComponent>());
+
+    double checksum = 0;
+    addResult("view_each_model_transformation", measure(runs, []() {}, [&]() {
+                  SceneView<ModelComponent, Transformation>(*registry).each(
+                      [&](EntityId id, ModelComponent& model, Transformation& transformation) {
+                          checksum += model.modelIndex + transformation.translation.x;
+                      });
+              }));
+
+    addResult("view_each_transformation_physics", measure(runs, []() {}, [&]() {
+                  SceneView<Transformation, PhysicsComponent>(*registry).each(
+                      [&](EntityId id, Transformation& transformation, PhysicsComponent& physics) {
+                          checksum += transformation.translation.y + physics.dynamic;
+                      });
+              }));
+
+    addResult("get_component_by_id", measure(runs, []() {}, [&]() {
+                  for(EntityId id : ids) {
+                      checksum += registry->getComponent<Transformation>(id)->scaling.x;
+                  }
+              }));
+
+    auto markAllChanged = [&]() {
+        for(EntityId id : ids) {
+            auto* transformation = registry->getComponent<Transformation>(id);
+
+            transformation->translation.x += 1.0f;
+            registry->markTransformationChanged(id, *transformation);
+        }
+    };
+    addResult("update_transformations", measure(runs, markAllChanged, [&]() {
+                  registry->updateTransformations();
+              }));
+
+    // gathers the world bounds like VulkanRenderer::extractDrawList() and
+    // culls them against a camera that sees about 100 of the entities
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(100, 0, 60), glm::vec3(100, 0, 0), glm::vec3(0, 1, 0));
+    Frustum   frustum = extractFrustum(projection * view);
+
+    CullingBatch         culling;
+    std::vector<uint8_t> visible;
+    addResult("frustum_culling", measure(runs, []() {}, [&]() {
+                  culling.clear();
+                  SceneView<BoundsComponent>(*registry).each(
+                      [&](EntityId id, BoundsComponent& bounds) { culling.add(bounds.world); });
+                  checksum += cullBatch(frustum, culling, visible);
+              }));
+
+    // extracts three MeshParts per entity like VulkanRenderer::extractDrawList()
+    // and sorts and slices them, the meshes and materials repeat along the level
+    DrawList            drawList;
+    std::vector<size_t> drawSlices;
+    addResult("extract_sort_draw_list", measure(runs, []() {}, [&]() {
+                  drawList.clear();
+                  uint32_t entityIndex = 0;
+                  SceneView<ModelComponent, BoundsComponent>(*registry).each(
+                      [&](EntityId id, ModelComponent& model, BoundsComponent& bounds) {
+                          float depth = std::abs(bounds.world.center.x - 100.0f) / 1000.0f;
+                          for(uint32_t part = 0; part < 3; part++) {
+                              int mesh     = static_cast<int>((entityIndex * 3 + part) % 64);
+                              int material = mesh % 16;
+                              drawList.items.push_back({makeDrawSortKey(0, material, mesh, depth),
+                                                        entityIndex, part, mesh, material});
+                          }
+                          entityIndex++;
+                      });
+                  sortDrawList(drawList);
+                  splitDrawList(drawList, 512, drawSlices);
+                  checksum += drawList.items[0].entityIndex + drawSlices.size();
+              }));
+
+    // physics sync with one dynamic box2d body per physics entity
+    b2World world(b2Vec2(0, -30.0f));
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_dynamicBody;
+
+    std::vector<EntityId> physicsEntities;
+    SceneView<Transformation, PhysicsComponent>(*registry).each(
+        [&](EntityId id, Transformation& transformation, PhysicsComponent& physics) {
+            bodyDef.position.Set(static_cast<float>(physicsEntities.size()), 0);
+            physics.body    = world.CreateBody(&bodyDef);
+            physics.dynamic = true;
+            physicsEntities.push_back(id);
+        });
+
+    // move every body away from its Transformation, so every entity gets synced
+    auto moveTransformations = [&]() {
+        registry->updateTransformations();
+        for(EntityId id : physicsEntities) {
+            registry->getComponent<Transformation>(id)->translation.y += 1.0f;
+        }
+    };
+    addResult("physics_sync", measure(runs, moveTransformations, [&]() {
+                  syncPhysicsTransformations(*registry, threadPool);
+              }));
+
+    // keeps the compiler from removing the iterations
+    if(checksum == 0.123) {
+        std::cerr << checksum;
+    }
+}
+
+static std::string toJson(const std::vector<BenchmarkResult>& results, size_t workerCount) {
+    std::ostringstream json;
+    json << "{\n  \"workers\": " << workerCount << ",\n  \"results\": [\n";
+    for(size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        json << "    {\"name\": \"" << result.name << "\", \"storage\": \""
+             << result.storageMode << "\", \"entities\": " << result.entityCount
+             << ", \"runs\": " << result.runs << ", \"ns\": " << result.nanosPerRun
+             << ", \"ns_per_entity\": " << result.nanosPerRun / result.entityCount << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+int main(int argc, char** argv) {
+    ThreadPool                   threadPool;
+    std::vector<BenchmarkResult> results;
+
+    for(StorageMode storageMode : {StorageMode::SparseSet, StorageMode::Archetype}) {
+        for(size_t entityCount : ENTITY_COUNTS) {
+            runBenchmarks(storageMode, entityCount, threadPool, results);
+        }
+    }
+
+    std::string json = toJson(results, threadPool.getWorkerCount());
+    if(argc > 1) {
+        std::ofstream file(argv[1]);
+        file << json;
+    } else {
+        std::cout << json;
+    }
+
+    return 0;
+}
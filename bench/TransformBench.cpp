@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "glm/ext/matrix_float4x4.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "glm/gtc/matrix_inverse.hpp"
+#include <glm/gtx/euler_angles.hpp>
+#include "scene/TransformBatch.h"
+
+// Compares composeTransformations() with the glm code of
+// Transformation::recalculateMatrices(), which is copied here so the benchmark
+// does not depend on Vulkan.
+
+#define CURRENT_MICROS                                                         \
+    (std::chrono::duration_cast<std::chrono::microseconds>(                    \
+        std::chrono::steady_clock::now().time_since_epoch()))
+
+struct GlmTransformation
+{
+    glm::vec3 translation;
+    glm::vec3 rotation;
+    glm::vec3 scaling;
+
+    glm::mat4 transformation;
+    glm::mat4 normalsTransformation;
+
+    void recalculateMatrices() {
+        glm::mat4 scaleMat = glm::scale(glm::mat4(1), scaling);
+        glm::mat4 rotateMat =
+            glm::eulerAngleXYZ(rotation.x, rotation.y, rotation.z);
+        glm::mat4 translateMat = glm::translate(glm::mat4(1), translation);
+        transformation         = translateMat * rotateMat * scaleMat;
+        normalsTransformation = glm::inverseTranspose(transformation);
+    }
+};
+
+static float maxDifference(const glm::mat4& a, const glm::mat4& b) {
+    float difference = 0;
+    for(int column = 0; column < 4; column++) {
+        for(int row = 0; row < 4; row++) {
+            difference = std::max(difference, std::abs(a[column][row] - b[column][row]));
+        }
+    }
+    return difference;
+}
+
+static void runBenchmark(size_t transformationCount, int runs) {
+    std::mt19937                          random(42);
+    std::uniform_real_distribution<float> translations(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> rotations(-6.3f, 6.3f);
+    std::uniform_real_distribution<float> scalings(0.1f, 4.0f);
+
+    std::vector<GlmTransformation> glmTransformations(transformationCount);
+    for(auto& transformation : glmTransformations) {
+        transformation.translation = {translations(random), translations(random), translations(random)};
+        transformation.rotation    = {rotations(random), rotations(random), rotations(random)};
+        transformation.scaling     = {scalings(random), scalings(random), scalings(random)};
+    }
+
+    auto start = CURRENT_MICROS;
+    for(int i = 0; i < runs; i++) {
+        for(auto& transformation : glmTransformations) {
+            transformation.recalculateMatrices();
+        }
+    }
+    double glmMicros = (CURRENT_MICROS - start).count() / double(runs);
+
+    // gathering into the batch is part of the cost, like in
+    // Scene::updateTransformations()
+    TransformBatch batch;
+    start = CURRENT_MICROS;
+    for(int i = 0; i < runs; i++) {
+        batch.resize(transformationCount);
+        for(size_t j = 0; j < transformationCount; j++) {
+            const GlmTransformation& transformation = glmTransformations[j];
+            batch.set(j, transformation.translation, transformation.rotation, transformation.scaling);
+        }
+        composeTransformations(batch);
+    }
+    double batchMicros = (CURRENT_MICROS - start).count() / double(runs);
+
+    float transformationError = 0;
+    float normalsError        = 0;
+    for(size_t i = 0; i < transformationCount; i++) {
+        transformationError = std::max(transformationError,
+            maxDifference(glmTransformations[i].transformation, batch.transformations[i]));
+        normalsError = std::max(normalsError,
+            maxDifference(glmTransformations[i].normalsTransformation, batch.normalsTransformations[i]));
+    }
+
+    std::cout << transformationCount << " transformations: glm " << glmMicros
+              << " us, batch " << batchMicros << " us, speedup "
+              << glmMicros / std::max(batchMicros, 0.001) << "x, max error "
+              << transformationError << " / " << normalsError << "\n";
+}
+
+int main() {
+    runBenchmark(1000, 1000);
+    runBenchmark(10000, 100);
+    runBenchmark(100000, 10);
+
+    return 0;
+}
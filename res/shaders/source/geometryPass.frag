@@ -7,6 +7,7 @@
 layout (location = 0) in vec3 inNormal;
 layout (location = 1) in vec4 inTangents;
 layout (location = 2) in vec2 inTexCoords;
+layout (location = 3) flat in int inMaterialIndex;
 
 // gBuffer
 layout(location = eNormal) out vec4 outNormal;
@@ -17,11 +18,10 @@ layout(location = ePBR) out vec4 outAoRoughnessMetallic;
 layout (std140, set = 1, binding = eMaterials) readonly buffer Materials {MaterialDescription m[];} materials;
 // textures array
 layout(set = 1, binding = eTextures) uniform sampler2D samplers[];
-layout( push_constant ) uniform _PushConstant { PushConstant pushConstant; };
 
 void main() {
     // fetch material
-    MaterialDescription material = materials.m[pushConstant.materialIndex];
+    MaterialDescription material = materials.m[inMaterialIndex];
 
     vec3 albedo = material.albedo;
     if(material.albedoTextureID != -1) {
@@ -10,21 +10,30 @@ layout(location = 3) in vec2 inTexCoords;
 
 layout(set = 0, binding = eCamera) uniform _CameraUniform {CameraUniform cameraUniform; };
 
-layout( push_constant ) uniform _PushConstant { PushConstant pushConstant; };
+// all instances of this frame, firstInstance of the draw is included in gl_InstanceIndex
+layout (std430, set = 0, binding = eInstances) readonly buffer Instances {InstanceData i[];} instances;
+
+// the transformations of all entities, indexed by InstanceData::objectIndex
+layout (std430, set = 0, binding = eObjects) readonly buffer Objects {ObjectData o[];} objects;
 
 layout(location = 0) out vec3 outNormal;
 layout(location = 1) out vec4 outTangents;
 layout(location = 2) out vec2 outTexCoords;
+layout(location = 3) flat out int outMaterialIndex;
 
 void main() {
-    vec4 worldPosition = pushConstant.transformation * vec4(inPosition, 1);
+    InstanceData instance = instances.i[gl_InstanceIndex];
+    ObjectData object = objects.o[instance.objectIndex];
+
+    vec4 worldPosition = object.transformation * vec4(inPosition, 1);
     
     gl_Position = cameraUniform.proj * cameraUniform.view * worldPosition;
 
     // prepare data for normal mapping
-    mat3 normalTransformation = mat3(pushConstant.normalsTransformation);
+    mat3 normalTransformation = mat3(object.normalsTransformation);
     outNormal = normalize(normalTransformation * inNormal);
     outTangents = normalize(vec4(normalTransformation * inTangents.xyz, inTangents.w));
 
     outTexCoords = inTexCoords;
+    outMaterialIndex = instance.materialIndex;
 }
@@ -4,6 +4,8 @@
 #include "../../../src/rendering/host_device.h"
 #include "BRDF.glsl"
 
+layout(location = 0) flat in int inLightIndex;
+
 layout(location = 0) out vec4 outColor;
 
 layout(set = 0, binding = eCamera) uniform _CameraUniform {CameraUniform cameraUniform; };
@@ -17,6 +19,8 @@ layout (set = 1, binding = eAlbedo) uniform sampler2D gBufferAlbedo;
 layout (set = 1, binding = ePBR) uniform sampler2D gBufferPBR;
 layout (set = 1, binding = eDepth) uniform sampler2D gBufferDepth;
 
+layout (std140, set = 0, binding = eLights) readonly buffer Lights {LightData l[];} lights;
+
 layout (push_constant) uniform _PointLightPushConstant { PointLightPushConstant pushConstant; };
 
 void main() {
@@ -36,23 +40,25 @@ void main() {
     tmp = cameraUniform.viewInverse * (tmp / tmp.w);
     vec3 position = tmp.xyz;
 
+    LightData light = lights.l[inLightIndex];
+
     // lighting calculation
     vec3 V = normalize(lightingInformation.cameraPosition - position);
-    vec3 L = normalize(pushConstant.position - position);
+    vec3 L = normalize(light.position - position);
 
     // calculate attenuation function, so that attenuation is 0 outside the radius
-    float lightDistance = length(pushConstant.position - position);
+    float lightDistance = length(light.position - position);
     // t is a function ranging from 1 at the lightsource to 0 at the radius distance
-    float t = lightDistance / pushConstant.radius;
+    float t = lightDistance / light.radius;
     // the higher the exponent here, the later the light influence fades to 0
     t = -t*t + 1.0;
     float physicalAttenuation = 1 / (lightDistance * lightDistance);
     float attenuation = t * physicalAttenuation;
 
-    vec3 radiance = attenuation * pushConstant.intensity;
+    vec3 radiance = attenuation * light.intensity;
     vec3 color = BRDF(L, V, normal, radiance, albedo, aoRoughnessMetallic.b, aoRoughnessMetallic.g);
     
     outColor = vec4(color, 1);
     // debug output to see on which pixels the fragment shader gets executed
-    //outColor = vec4(normalize(pushConstant.intensity) - 0.9, 1);
+    //outColor = vec4(normalize(light.intensity) - 0.9, 1);
 }
\ No newline at end of file
@@ -8,10 +8,17 @@ layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec4 inTangents;
 layout(location = 3) in vec2 texCoords;
 
+layout(location = 0) flat out int outLightIndex;
+
 layout(set = 0, binding = eCamera) uniform _CameraUniform {CameraUniform cameraUniform; };
 
-layout (push_constant) uniform _PointLightPushConstant { PointLightPushConstant pushConstant; };
+layout (std140, set = 0, binding = eLights) readonly buffer Lights {LightData l[];} lights;
 
 void main() {
-    gl_Position = cameraUniform.proj * cameraUniform.view * pushConstant.transformation * vec4(inPosition, 1);
+    // every instance is the volume of one light, scaled by its radius
+    LightData light = lights.l[gl_InstanceIndex];
+    outLightIndex = gl_InstanceIndex;
+
+    vec3 worldPosition = inPosition * light.radius + light.position;
+    gl_Position = cameraUniform.proj * cameraUniform.view * vec4(worldPosition, 1);
 }
\ No newline at end of file
@@ -19,7 +19,8 @@ layout(set = 0, binding = eCamera) uniform _CameraUniform {CameraUniform cameraU
 layout(set = 0, binding = eLighting) uniform _LightingInformation {LightingInformation lightingInformation; };
 
 // shadow mapping
-layout (set = 1, binding = eShadowDepthBuffer) uniform sampler2D depthSamplers[MAX_CASCADES];
+// one layer per cascade
+layout (set = 1, binding = eShadowDepthBuffer) uniform sampler2DArray shadowMaps;
 
 layout (set = 1, binding = eCascadeSplits) uniform _CascadeSplits {
     SplitDummyStruct split[MAX_CASCADES];
@@ -48,7 +49,7 @@ float getShadow(vec4 shadowCoords, vec2 offset, uint cascadeIndex) {
     float shadow = 1.0;
 
     if (shadowCoords.z > -1.0 && shadowCoords.z < 1.0) {
-        float dist = texture(depthSamplers[cascadeIndex], shadowCoords.st + offset).r;
+        float dist = texture(shadowMaps, vec3(shadowCoords.st + offset, cascadeIndex)).r;
         if (shadowCoords.w > 0.0 && dist < shadowCoords.z)
         {
             shadow = 0.0;
@@ -60,7 +61,7 @@ float getShadow(vec4 shadowCoords, vec2 offset, uint cascadeIndex) {
 
 float filterPCF(vec4 sc, uint cascadeIndex)
 {
-    ivec2 texDim = textureSize(depthSamplers[cascadeIndex], 0);
+    ivec2 texDim = textureSize(shadowMaps, 0).xy;
     float scale = 1;
     float dx = scale * 1.0 / float(texDim.x);
     float dy = scale * 1.0 / float(texDim.y);
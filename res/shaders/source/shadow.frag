@@ -5,19 +5,14 @@
 #include "../../../src/rendering/host_device.h"
 
 layout (location = 0) in vec2 inTexCoords;
+layout (location = 1) flat in int inMaterialIndex;
 
 layout (std140, set = 1, binding = eMaterials) readonly buffer Materials {MaterialDescription m[];} materials;
 
 layout(set = 1, binding = eTextures) uniform sampler2D samplers[];
 
-layout (push_constant) uniform shadowPushConstant {
-    mat4 transform;
-    int cascadeIndex;
-    int materialIndex;
-} pushConstant;
-
 void main() {
-    MaterialDescription material = materials.m[pushConstant.materialIndex];
+    MaterialDescription material = materials.m[inMaterialIndex];
 
     if(material.albedoTextureID != -1) {
         vec4 albedoTexture = texture(samplers[material.albedoTextureID], inTexCoords);
@@ -1,24 +1,29 @@
 #version 460
 #extension GL_GOOGLE_include_directive: enable
+#extension GL_EXT_multiview : enable
 
 #include "../../../src/rendering/host_device.h"
 
+// every draw is expanded to the active cascades with multiview, the cascade is
+// the view, see "shadowLayered.vert" for devices without multiview
+
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inNormal;
 layout (location = 2) in vec4 inTangents;
 layout (location = 3) in vec2 inTexCoords;
 
 layout (location = 0) out vec2 outTexCoords;
+layout (location = 1) flat out int outMaterialIndex;
 
 layout (set = 0, binding = eCamera) uniform SceneTransform {
     mat4 data[MAX_CASCADES];
 } VPMats;
 
-layout (push_constant) uniform ObjectTransform {
-    mat4 transform;
-    int cascadeIndex;
-    int materialIndex;
-} objectTransform;
+layout (std430, set = 0, binding = eInstances) readonly buffer Instances {InstanceData i[];} instances;
+
+layout (std430, set = 0, binding = eObjects) readonly buffer Objects {ObjectData o[];} objects;
+
+layout (push_constant) uniform _ShadowPushConstant { ShadowPushConstant pushConstant; };
 
 out gl_PerVertex
 {
@@ -26,11 +31,26 @@ out gl_PerVertex
 };
 
 void main() {
-    vec4 pos =  VPMats.data[objectTransform.cascadeIndex]
-                * objectTransform.transform * vec4(inPosition, 1);
+    InstanceData instance = instances.i[gl_InstanceIndex];
+
+    uint cascadeMask = pushConstant.cascadeMask != 0 ? pushConstant.cascadeMask
+                                                     : instance.cascadeMask;
 
     outTexCoords = inTexCoords;
+    outMaterialIndex = instance.materialIndex;
+
+    // instances that were culled for this cascade end up behind the near
+    // plane, so all of their triangles are clipped
+    if((cascadeMask & (1u << gl_ViewIndex)) == 0) {
+        gl_Position = vec4(0, 0, -1, 1);
+        return;
+    }
+
+    vec4 pos =  VPMats.data[gl_ViewIndex]
+                * objects.o[instance.objectIndex].transformation * vec4(inPosition, 1);
 
     gl_Position = pos;
     gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;
+    // the farther cascades have larger texels and need more bias
+    gl_Position.z += pushConstant.cascadeDepthBias[gl_ViewIndex] * gl_Position.w;
 }
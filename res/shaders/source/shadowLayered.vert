@@ -0,0 +1,51 @@
+#version 460
+#extension GL_GOOGLE_include_directive: enable
+#extension GL_ARB_shader_viewport_layer_array : enable
+
+#include "../../../src/rendering/host_device.h"
+
+// used instead of "shadow.vert" on devices without multiview, every instance
+// is drawn into a single cascade and selects its layer of the shadow map
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec4 inTangents;
+layout (location = 3) in vec2 inTexCoords;
+
+layout (location = 0) out vec2 outTexCoords;
+layout (location = 1) flat out int outMaterialIndex;
+
+layout (set = 0, binding = eCamera) uniform SceneTransform {
+    mat4 data[MAX_CASCADES];
+} VPMats;
+
+layout (std430, set = 0, binding = eInstances) readonly buffer Instances {InstanceData i[];} instances;
+
+layout (std430, set = 0, binding = eObjects) readonly buffer Objects {ObjectData o[];} objects;
+
+layout (push_constant) uniform _ShadowPushConstant { ShadowPushConstant pushConstant; };
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+void main() {
+    InstanceData instance = instances.i[gl_InstanceIndex];
+
+    uint cascadeMask = pushConstant.cascadeMask != 0 ? pushConstant.cascadeMask
+                                                     : instance.cascadeMask;
+    int cascade = findLSB(cascadeMask);
+
+    vec4 pos =  VPMats.data[cascade]
+                * objects.o[instance.objectIndex].transformation * vec4(inPosition, 1);
+
+    outTexCoords = inTexCoords;
+    outMaterialIndex = instance.materialIndex;
+
+    gl_Layer = cascade;
+    gl_Position = pos;
+    gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0;
+    // the farther cascades have larger texels and need more bias
+    gl_Position.z += pushConstant.cascadeDepthBias[cascade] * gl_Position.w;
+}
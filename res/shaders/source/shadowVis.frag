@@ -5,14 +5,14 @@
 
 layout(location = 0) in vec2 fragTexCoords;
 
-layout (set = 0, binding = eShadowDepthBuffer) uniform sampler2D depthSamplers[MAX_CASCADES];
+layout (set = 0, binding = eShadowDepthBuffer) uniform sampler2DArray shadowMaps;
 
 layout (push_constant) uniform _PushConstant { ShadowControlPushConstant pushConstant; };
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    float val = texture(depthSamplers[pushConstant.cascadeIndex], fragTexCoords).x;
+    float val = texture(shadowMaps, vec3(fragTexCoords, pushConstant.cascadeIndex)).x;
     val = 1 - val;
     val = pow(val, 2);
     outColor = vec4(val, val, val, 1);
@@ -8,8 +8,14 @@ layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec4 inTangents;
 layout(location = 3) in vec2 texCoords;
 
+layout (std140, set = 0, binding = eLights) readonly buffer Lights {LightData l[];} lights;
+
 layout (push_constant) uniform _StencilPushConstant { StencilPushConstant pushConstant; };
 
 void main() {
-    gl_Position = pushConstant.projView * pushConstant.transformation * vec4(inPosition, 1);
+    // every instance is the volume of one light, scaled by its radius
+    LightData light = lights.l[gl_InstanceIndex];
+
+    vec3 worldPosition = inPosition * light.radius + light.position;
+    gl_Position = pushConstant.projView * vec4(worldPosition, 1);
 }
\ No newline at end of file
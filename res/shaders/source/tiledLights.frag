@@ -0,0 +1,78 @@
+#version 460
+#extension GL_GOOGLE_include_directive : enable
+
+#include "../../../src/rendering/host_device.h"
+#include "BRDF.glsl"
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = eCamera) uniform _CameraUniform {CameraUniform cameraUniform; };
+
+// primarily used for the camera position
+layout(set = 0, binding = eLighting) uniform _LightingInformation {LightingInformation lightingInformation; };
+
+layout (std140, set = 0, binding = eLights) readonly buffer Lights {LightData l[];} lights;
+
+// gBuffer
+layout (set = 1, binding = eNormal) uniform sampler2D gBufferNormal;
+layout (set = 1, binding = eAlbedo) uniform sampler2D gBufferAlbedo;
+layout (set = 1, binding = ePBR) uniform sampler2D gBufferPBR;
+layout (set = 1, binding = eDepth) uniform sampler2D gBufferDepth;
+
+// written by "lightTiles.comp"
+layout (std430, set = 2, binding = eTileLights) readonly buffer TileLights {uint l[];} tileLights;
+
+layout (push_constant) uniform _LightTilePushConstant { LightTilePushConstant pushConstant; };
+
+void main() {
+    // pixel coordinates (ranging from (0,0) to (width, height)) for sampling from gBuffer
+    ivec2 intCoords = ivec2(gl_FragCoord.xy - 0.5);
+    vec4 aoRoughnessMetallic = texelFetch(gBufferPBR, intCoords, 0);
+    // aoRoughnessMetallic.a is 1.0 if there is geometry in the gBuffer, else the skybox will be rendered there anyways
+    if(aoRoughnessMetallic.a < 1.0)
+        discard;
+
+    uvec2 tile = uvec2(intCoords) / LIGHT_TILE_SIZE;
+    uint tileOffset = (tile.y * pushConstant.tileCountX + tile.x) * LIGHT_TILE_STRIDE;
+    uint tileLightCount = tileLights.l[tileOffset];
+    if(tileLightCount == 0)
+        discard;
+
+    vec3 normal = texelFetch(gBufferNormal, intCoords, 0).rgb;
+    vec3 albedo = texelFetch(gBufferAlbedo, intCoords, 0).rgb;
+    float depth = texelFetch(gBufferDepth, intCoords, 0).r;
+
+    // reconstruct world position from depth
+    vec2 screenCoords = gl_FragCoord.xy / pushConstant.resolution * 2.0 - 1.0;
+    vec4 tmp = cameraUniform.projInverse * vec4(screenCoords, depth, 1);
+    tmp = cameraUniform.viewInverse * (tmp / tmp.w);
+    vec3 position = tmp.xyz;
+
+    vec3 V = normalize(lightingInformation.cameraPosition - position);
+
+    vec3 color = vec3(0);
+    for(uint i = 0; i < tileLightCount; i++) {
+        LightData light = lights.l[tileLights.l[tileOffset + 1 + i]];
+
+        // the tile only bounds the light volume, unlike the stencil test of
+        // the point light pipeline
+        float lightDistance = length(light.position - position);
+        if(lightDistance >= light.radius)
+            continue;
+
+        vec3 L = normalize(light.position - position);
+
+        // same attenuation as in "pointLights.frag"
+        float t = lightDistance / light.radius;
+        t = -t*t + 1.0;
+        float physicalAttenuation = 1 / (lightDistance * lightDistance);
+        float attenuation = t * physicalAttenuation;
+
+        vec3 radiance = attenuation * light.intensity;
+        color += BRDF(L, V, normal, radiance, albedo, aoRoughnessMetallic.b, aoRoughnessMetallic.g);
+    }
+
+    outColor = vec4(color, 1);
+    // debug output to see how many lights every tile has
+    //outColor = vec4(vec3(float(tileLightCount) / MAX_LIGHTS_PER_TILE), 1);
+}
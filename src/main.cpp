@@ -35,7 +35,7 @@ int main() {
     auto          renderSetupDescription =
         initializeSimpleSceneRenderContext(appContext, renderContext, scene);
 
-    VulkanRenderer renderer(appContext, renderContext);
+    VulkanRenderer renderer(appContext, renderContext, scene.getThreadPool());
 
     InputController inputController;
     scene.setInputController(&inputController);
@@ -74,22 +74,58 @@ int main() {
                              | ImGuiWindowFlags_NoTitleBar);
             ImGui::Text("%.3f ms", 1000.0f / ImGui::GetIO().Framerate);
             ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
-            ImGui::Text("%i geometry pass draw calls", renderContext.imguiData.meshDrawCalls);
-            ImGui::Text("%i shadow pass draw calls", renderContext.imguiData.shadowPassDrawCalls);
-            // lights get drawn once into stencil buffer and once for shading
-            ImGui::Text("%i light draw calls", renderContext.imguiData.lightDrawCalls * 2);
+            ImGui::Text("%i geometry pass draw calls (%i instances)",
+                        renderContext.imguiData.meshDrawCalls, renderContext.imguiData.meshInstances);
+            // the instance counts of the GPU culling are read back once the frame
+            // that wrote them is done, as many frames late as there are in flight
+            if(renderContext.imguiData.gpuCulling && appContext.baseContext.supportsIndirectCount) {
+                ImGui::Text("culled on the GPU");
+            } else {
+                ImGui::Text("%i objects visible, %i culled", renderContext.imguiData.visibleObjects,
+                            renderContext.imguiData.culledObjects);
+            }
+            ImGui::Text("%i shadow pass draw calls (%i instances)",
+                        renderContext.imguiData.shadowPassDrawCalls,
+                        renderContext.imguiData.shadowPassInstances);
+            ImGui::Text("%i of %i cascades cached", renderContext.imguiData.cachedCascades,
+                        renderContext.renderSettings.shadowMappingSettings.numberCascades);
+            ImGui::Text("%i binds skipped", renderContext.imguiData.skippedBinds);
+            // the stencil and the shading draws of the light volumes, or the
+            // single full screen draw of the tiled lighting
+            ImGui::Text("%i light draw calls", renderContext.imguiData.lightDrawCalls);
+            ImGui::Text("%i lights culled", renderContext.imguiData.culledLights);
+            // GPU times of the passes, read back as many frames late as there
+            // are frames in flight
+            const GpuProfiler& gpuProfiler = renderer.getGpuProfiler();
+            if(gpuProfiler.isSupported()) {
+                ImGui::Separator();
+                ImGui::Text("GPU ms (average, max of %u frames)", GPU_PROFILER_HISTORY);
+                for(const GpuProfiler::ScopeTimes& scope : gpuProfiler.getScopeTimes()) {
+                    ImGui::Text("%*s%s %.3f, %.3f", static_cast<int>(2 * scope.depth), "",
+                                scope.name.c_str(), scope.averageMs, scope.maxMs);
+                }
+            }
             ImGui::SetWindowSize(ImVec2(0, 0), ImGuiCond_Once);
             ImGui::End();
         }
-        renderer.render(scene);
-
+        // the systems run in render() together with the ones of the renderer,
+        // if it skips a frame they run with the ones of the next frame
         if (scene.gameplayActive()) {
             delta      = (CURRENT_MILLIS - lastUpdate);
             lastUpdate = CURRENT_MILLIS;
 
+            SystemScheduler& scheduler = scene.getScheduler();
+
             accumulatedDelta += delta;
             if(accumulatedDelta >= targetPhysicsRate) {
-                scene.doPhysicsUpdate(targetPhysicsRate.count());
+                SystemAccess physicsAccess;
+                physicsAccess.componentReads  = getComponentMask<PhysicsComponent>();
+                // the contact listener writes the PlayerComponent during the step
+                physicsAccess.componentWrites = getComponentMask<Transformation, PlayerComponent>();
+                physicsAccess.resourceWrites  = PHYSICS_WORLD_RESOURCE;
+                scheduler.addSystem("physics update", physicsAccess, [&]() {
+                    scene.doPhysicsUpdate(targetPhysicsRate.count());
+                });
 
                 // accumulatedDelta -= targetPhysicsRate;
                 int amountStepsInAcc = accumulatedDelta / targetPhysicsRate;
@@ -100,8 +136,15 @@ int main() {
                 accumulatedDelta = accumulatedDelta % targetPhysicsRate;
             }
 
-            scene.handleUserInput();
+            SystemAccess inputAccess;
+            inputAccess.componentReads  = getComponentMask<PhysicsComponent>();
+            inputAccess.componentWrites = getComponentMask<PlayerComponent>();
+            // getSinglePress() consumes the press
+            inputAccess.resourceWrites  = INPUT_RESOURCE | PHYSICS_WORLD_RESOURCE;
+            scheduler.addSystem("user input", inputAccess, [&]() { scene.handleUserInput(); });
         }
+
+        renderer.render(scene);
     }
     vkDeviceWaitIdle(appContext.baseContext.device);
 
@@ -6,6 +6,8 @@
 #include "box2d/b2_contact.h"
 #include "glm/trigonometric.hpp"
 #include "scene/LevelData.h"
+#include "scene/Scene.h"
+#include "game/PlayerComponent.h"
 
 void GameContactListener::BeginContact(b2Contact* contact) {
     // test if any fixture is player fixture -> early exit
@@ -18,6 +20,10 @@ void GameContactListener::BeginContact(b2Contact* contact) {
     if(!fixture_id)
         return;
 
+    PlayerComponent* playerComponent = getPlayerComponent();
+    if(playerComponent == nullptr)
+        return;
+
     if(playerHitCategory(contact, fixture_id, HAZARD_CATEGORY_BITS)) {
         playerComponent->touchesHazard = true;
     }
@@ -42,6 +48,10 @@ void GameContactListener::EndContact(b2Contact* contact) {
     if(!fixture_id)
         return;
 
+    PlayerComponent* playerComponent = getPlayerComponent();
+    if(playerComponent == nullptr)
+        return;
+
     if(contactIsBelow(contact, fixture_id)) {
         playerComponent->grounded = false;
     }
@@ -55,8 +65,16 @@ void GameContactListener::setPlayerFixture(b2Fixture* fixture) {
     playerFixture = fixture;
 }
 
-void GameContactListener::setPlayerComponent(PlayerComponent* component) {
-    playerComponent = component;
+void GameContactListener::setPlayerEntity(Scene* playerScene, EntityId entityId) {
+    scene        = playerScene;
+    playerEntity = entityId;
+}
+
+PlayerComponent* GameContactListener::getPlayerComponent() {
+    if(scene == nullptr || !scene->isEntityValid(playerEntity))
+        return nullptr;
+
+    return scene->getComponent<PlayerComponent>(playerEntity);
 }
 
 bool GameContactListener::contactIsBelow(b2Contact* contact, int fixture_id) {
@@ -1,5 +1,5 @@
 #include <box2d/b2_world_callbacks.h>
-#include "game/PlayerComponent.h"
+#include "scene/Entity.h"
 
 #ifndef GRAPHICSPRAKTIKUM_GAMECONTACTLISTENER_H
 #define GRAPHICSPRAKTIKUM_GAMECONTACTLISTENER_H
@@ -7,11 +7,17 @@
 #define FIXTURE_ID_A 1
 #define FIXTURE_ID_B 2
 
+class Scene;
+struct PlayerComponent;
+
 class GameContactListener : b2ContactListener {
 
 private:
     b2Fixture *playerFixture;
-    PlayerComponent *playerComponent;
+    // the PlayerComponent is looked up on every contact, a pointer to it would
+    // become invalid when components of the player are added or removed
+    Scene    *scene        = nullptr;
+    EntityId  playerEntity = INVALID_ENTITY_ID;
 
 
 public:
@@ -24,9 +30,11 @@ public:
     void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override;
 
     void setPlayerFixture(b2Fixture *fixture);
-    void setPlayerComponent(PlayerComponent *component);
+    void setPlayerEntity(Scene *scene, EntityId entityId);
 
 private:
+    PlayerComponent *getPlayerComponent();
+
     b2Vec2 getWorldManifoldNormal(b2Contact *contact, int fixture_id);
 
     bool contactMakesGrounded(b2Contact *contact, int fixture_id);
@@ -0,0 +1,22 @@
+#include "PhysicsSync.h"
+#include "PhysicsComponent.h"
+
+void syncPhysicsTransformations(EntityRegistry& registry, ThreadPool& threadPool) {
+    // every entity only touches its own components, so batches can run in parallel
+    SceneView<Transformation, PhysicsComponent>(registry).eachParallel(
+        threadPool, 256,
+        [&registry](EntityId id, Transformation& transform, PhysicsComponent& physicsComponent) {
+            if(physicsComponent.dynamic) {
+                b2Vec2 newPos = physicsComponent.body->GetPosition();
+
+                if(newPos.x != transform.translation.x
+                   || newPos.y != transform.translation.y
+                   || physicsComponent.body->GetAngle() != transform.rotation.z) {
+                    transform.translation =
+                        glm::vec3(newPos.x, newPos.y, transform.translation.z);
+                    transform.rotation.z = physicsComponent.body->GetAngle();
+                    registry.markTransformationChanged(id, transform);
+                }
+            }
+        });
+}
@@ -0,0 +1,12 @@
+#ifndef GRAPHICSPRAKTIKUM_PHYSICSSYNC_H
+#define GRAPHICSPRAKTIKUM_PHYSICSSYNC_H
+
+#include "scene/EntityRegistry.h"
+#include "utils/ThreadPool.h"
+
+// Copies the position and angle of every dynamic body into the Transformation
+// of its entity after a step of the box2d world. Only entities that moved are
+// marked as changed.
+void syncPhysicsTransformations(EntityRegistry& registry, ThreadPool& threadPool);
+
+#endif  // GRAPHICSPRAKTIKUM_PHYSICSSYNC_H
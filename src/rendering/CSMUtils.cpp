@@ -266,3 +266,93 @@ void calculateVPMatsNew(PerspectiveSettings   perspectiveSettings,
         VPMats[i] = projection * cascadeView;
     }
 }
+
+void calculateCascadeSpheres(PerspectiveSettings            perspectiveSettings,
+                             glm::mat4                      inverseViewProjection,
+                             ShadowMappingSettings          shadowSettings,
+                             std::vector<CascadeSphere>&    spheres,
+                             std::vector<SplitDummyStruct>& splitDepths) {
+    int numberCascades = shadowSettings.numberCascades;
+
+    std::vector<float> cascadeSplits(numberCascades);
+    calculateCascadeSplitDepths(perspectiveSettings, numberCascades, cascadeSplits,
+                                shadowSettings.cascadeSplitsBlendFactor);
+
+    float near      = perspectiveSettings.nearPlane;
+    float far       = perspectiveSettings.farPlane;
+    float clipRange = far - near;
+
+    glm::vec3 frustumCorners[8] = {
+        glm::vec3(-1.0f, 1.0f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f),
+        glm::vec3(1.0f, -1.0f, 0.0f), glm::vec3(-1.0f, -1.0f, 0.0f),
+        glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f),
+        glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(-1.0f, -1.0f, 1.0f),
+    };
+
+    for(int i = 0; i < 8; i++) {
+        glm::vec4 frustumCornerHom =
+            inverseViewProjection * glm::vec4(frustumCorners[i], 1);
+        frustumCorners[i] = glm::vec3(frustumCornerHom / frustumCornerHom.w);
+    }
+
+    spheres.resize(numberCascades);
+
+    float lastSplitDepth = 0;
+    for(int i = 0; i < numberCascades; i++) {
+        float currentSplitDepth = cascadeSplits[i];
+
+        glm::vec3 cascadeCorners[8];
+        for(int j = 0; j < 4; j++) {
+            glm::vec3 cornerDiff  = frustumCorners[j + 4] - frustumCorners[j];
+            cascadeCorners[j]     = frustumCorners[j] + (lastSplitDepth * cornerDiff);
+            cascadeCorners[j + 4] = frustumCorners[j] + (currentSplitDepth * cornerDiff);
+        }
+
+        splitDepths[i].splitVal = (near + currentSplitDepth * clipRange) * -1.0f;
+        lastSplitDepth          = currentSplitDepth;
+
+        glm::vec3 center = glm::vec3(0);
+        for(const glm::vec3& corner : cascadeCorners) {
+            center += corner;
+        }
+        center /= 8;
+
+        float radius = 0;
+        for(const glm::vec3& corner : cascadeCorners) {
+            radius = glm::max(radius, glm::length(corner - center));
+        }
+        // rounded up, so floating point noise does not change the size
+        spheres[i].center = center;
+        spheres[i].radius = std::ceil(radius * 16.0f) / 16.0f;
+    }
+}
+
+glm::mat4 calculateStableCascadeMatrix(const CascadeSphere& sphere,
+                                       glm::vec3            lightDirection,
+                                       float                lightCameraZOffset,
+                                       uint32_t             shadowMapSize) {
+    glm::vec3 lightDir = glm::normalize(lightDirection);
+
+    // the orientation of the light camera only depends on the light, any up
+    // vector that is not parallel to it works
+    glm::vec3 upVec = glm::abs(lightDir.y) > 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+    glm::mat4 lightRotation = glm::lookAt(glm::vec3(0), lightDir, upVec);
+
+    // move the center to a whole texel in the plane of the shadow map
+    float     texelSize = 2.0f * sphere.radius / static_cast<float>(shadowMapSize);
+    glm::vec3 lightSpaceCenter = glm::vec3(lightRotation * glm::vec4(sphere.center, 1));
+    lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+    lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+    glm::vec3 center = glm::vec3(glm::inverse(lightRotation) * glm::vec4(lightSpaceCenter, 1));
+
+    // casters up to lightCameraZOffset in front of the sphere still get drawn
+    float     eyeDistance = sphere.radius + lightCameraZOffset;
+    glm::mat4 cascadeView = glm::lookAt(center - lightDir * eyeDistance, center, upVec);
+
+    glm::mat4 projection = glm::ortho(-sphere.radius, sphere.radius, -sphere.radius,
+                                      sphere.radius, 0.0f, eyeDistance + sphere.radius);
+
+    projection[1][1] *= -1;
+
+    return projection * cascadeView;
+}
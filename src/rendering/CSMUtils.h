@@ -31,4 +31,26 @@ void calculateVPMatsNew(PerspectiveSettings   perspectiveSettings,
                         std::vector<glm::mat4>&        VPMats,
                         std::vector<SplitDummyStruct>& splitDepths);
 
+// bounding sphere of the part of the camera frustum a cascade covers, unlike a
+// box in light space its size does not depend on the camera rotation
+typedef struct
+{
+    glm::vec3 center;
+    float     radius;
+} CascadeSphere;
+
+void calculateCascadeSpheres(PerspectiveSettings            perspectiveSettings,
+                             glm::mat4                      inverseViewProjection,
+                             ShadowMappingSettings          shadowSettings,
+                             std::vector<CascadeSphere>&    spheres,
+                             std::vector<SplitDummyStruct>& splitDepths);
+
+// Light projection * view matrix that contains the sphere. The sphere is moved
+// to a whole texel of a shadow map with shadowMapSize texels per side, so
+// static geometry always covers the same texels.
+glm::mat4 calculateStableCascadeMatrix(const CascadeSphere& sphere,
+                                       glm::vec3            lightDirection,
+                                       float                lightCameraZOffset,
+                                       uint32_t             shadowMapSize);
+
 #endif  // GRAPHICSPRAKTIKUM_CSMUTILS_H
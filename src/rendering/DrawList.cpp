@@ -0,0 +1,73 @@
+#include "DrawList.h"
+#include <algorithm>
+#include <array>
+
+uint64_t makeDrawSortKey(uint32_t pipelineIndex, uint32_t materialIndex, uint32_t meshIndex, float depth) {
+    const uint64_t maxDepth = (1ull << DRAW_KEY_DEPTH_BITS) - 1;
+
+    uint64_t depthBits = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * maxDepth);
+
+    uint64_t key = pipelineIndex & ((1u << DRAW_KEY_PIPELINE_BITS) - 1);
+    key = (key << DRAW_KEY_MATERIAL_BITS) | (materialIndex & ((1u << DRAW_KEY_MATERIAL_BITS) - 1));
+    key = (key << DRAW_KEY_MESH_BITS) | (meshIndex & ((1u << DRAW_KEY_MESH_BITS) - 1));
+    key = (key << DRAW_KEY_DEPTH_BITS) | depthBits;
+    return key;
+}
+
+void sortDrawList(DrawList& drawList) {
+    std::vector<DrawItem>& items  = drawList.items;
+    std::vector<DrawItem>& buffer = drawList.sortBuffer;
+    buffer.resize(items.size());
+
+    if(items.size() < 2) {
+        return;
+    }
+
+    // the histograms of all eight bytes are counted in one go
+    std::array<std::array<uint32_t, 256>, 8> histograms{};
+    for(const DrawItem& item : items) {
+        for(int byte = 0; byte < 8; byte++) {
+            histograms[byte][(item.sortKey >> (byte * 8)) & 0xff]++;
+        }
+    }
+
+    for(int byte = 0; byte < 8; byte++) {
+        std::array<uint32_t, 256>& offsets = histograms[byte];
+        int                        shift   = byte * 8;
+
+        // all keys share this byte, the pass would not change the order
+        if(offsets[(items[0].sortKey >> shift) & 0xff] == items.size()) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for(uint32_t& count : offsets) {
+            uint32_t bucketSize = count;
+            count               = offset;
+            offset += bucketSize;
+        }
+
+        for(const DrawItem& item : items) {
+            buffer[offsets[(item.sortKey >> shift) & 0xff]++] = item;
+        }
+        std::swap(items, buffer);
+    }
+}
+
+void splitDrawList(const DrawList& drawList, size_t sliceSize, std::vector<size_t>& sliceBegins) {
+    const std::vector<DrawItem>& items = drawList.items;
+    sliceBegins.clear();
+
+    size_t begin = 0;
+    while(begin < items.size()) {
+        sliceBegins.push_back(begin);
+
+        size_t end = std::min(begin + std::max<size_t>(1, sliceSize), items.size());
+        while(end < items.size() && items[end].meshIndex == items[end - 1].meshIndex
+              && items[end].materialIndex == items[end - 1].materialIndex) {
+            end++;
+        }
+        begin = end;
+    }
+    sliceBegins.push_back(items.size());
+}
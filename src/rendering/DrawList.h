@@ -0,0 +1,52 @@
+#ifndef GRAPHICSPRAKTIKUM_DRAWLIST_H
+#define GRAPHICSPRAKTIKUM_DRAWLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bits of the sort key from most to least significant. Sorting by the key
+// groups draws by pipeline, then material, then mesh, so consecutive draws can
+// share their bindings, and draws with the same mesh go front to back.
+const int DRAW_KEY_PIPELINE_BITS = 4;
+const int DRAW_KEY_MATERIAL_BITS = 16;
+const int DRAW_KEY_MESH_BITS     = 20;
+const int DRAW_KEY_DEPTH_BITS    = 24;
+
+// one MeshPart of one entity
+struct DrawItem
+{
+    uint64_t sortKey;
+    // index of the entity in the list the draw list was extracted from
+    uint32_t entityIndex;
+    // position of the MeshPart in Model::meshPartIndices
+    uint32_t partIndex;
+    int      meshIndex;
+    int      materialIndex;
+};
+
+struct DrawList
+{
+    std::vector<DrawItem> items;
+    // scratch storage of sortDrawList()
+    std::vector<DrawItem> sortBuffer;
+
+    void clear() { items.clear(); }
+};
+
+// "depth" is the distance to the camera divided by the distance to the far
+// plane and gets clamped to [0, 1]. Indices that do not fit into their bits
+// are wrapped, which only makes the sorting less effective.
+uint64_t makeDrawSortKey(uint32_t pipelineIndex, uint32_t materialIndex, uint32_t meshIndex, float depth);
+
+// Sorts the items by their key with a stable least significant digit radix
+// sort (one pass per byte, passes where all keys share the byte are skipped).
+void sortDrawList(DrawList& drawList);
+
+// Splits the sorted items into slices of at least sliceSize items that can be
+// recorded independently. A slice only ends where the mesh or the material
+// changes, so the instances of a MeshPart stay in one slice. "sliceBegins"
+// gets the first item of every slice followed by the number of items.
+void splitDrawList(const DrawList& drawList, size_t sliceSize, std::vector<size_t>& sliceBegins);
+
+#endif  // GRAPHICSPRAKTIKUM_DRAWLIST_H
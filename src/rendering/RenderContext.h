@@ -8,6 +8,7 @@
 #include "RenderSetupDescription.h"
 #include "scene/Camera.h"
 #include "host_device.h"
+#include "vulkan/VulkanSettings.h"
 
 typedef struct
 {
@@ -54,13 +55,30 @@ typedef struct
 
 typedef struct
 {
-    ImageResources depthImages[MAX_CASCADES];
-    VkFramebuffer  depthFrameBuffers[MAX_CASCADES];
-
-    BufferResources transformBuffer;
+    // one layer per cascade, all cascades are drawn in a single render pass
+    ImageResources depthImage;
+    VkFramebuffer  depthFrameBuffer;
+
+    // cache of the static shadow casters of every cascade, its layers are
+    // copied into the depth image before the dynamic casters are drawn on top
+    ImageResources staticDepthImage;
+    VkFramebuffer  staticDepthFrameBuffer;
+    // draws into the cache and leaves it ready to be copied, compatible with
+    // the render pass of the depth image
+    VkRenderPass staticRenderPass;
+
+    // every draw is expanded to the active cascades with multiview, otherwise
+    // every instance selects the layer of its cascade with gl_Layer
+    bool useMultiview;
+    // the cascades the render passes were created for, one bit per view
+    int      cascadeCount;
+    uint32_t viewMask;
+
+    // light projection * view matrices of the cascades, one per frame in flight
+    BufferResources transformBuffers[MAX_FRAMES_IN_FLIGHT];
 
     VkDescriptorSetLayout transformDescriptorSetLayout;
-    VkDescriptorSet       transformDescriptorSet;
+    VkDescriptorSet       transformDescriptorSets[MAX_FRAMES_IN_FLIGHT];
 
     VkDescriptorSetLayout materialDescriptorSetLayout;
     VkDescriptorSet       materialDescriptorSet;
@@ -76,23 +94,46 @@ typedef struct
     ShadowPushConstant shadowPushConstant;
 } ShadowPass;
 
+// number of InstanceData the instance buffer of the main pass starts with
+const uint32_t INITIAL_INSTANCE_CAPACITY = 1024;
+// number of ObjectData the object buffer of the main pass starts with
+const uint32_t INITIAL_OBJECT_CAPACITY   = 1024;
+const uint32_t INITIAL_LIGHT_CAPACITY    = 128;
+
 typedef struct
 {
     // descriptor stuff
 
-    BufferResources transformBuffer;
-    BufferResources lightingBuffer;
+    // the buffers written every frame exist once per frame in flight, so the
+    // CPU never writes into a buffer the GPU is still reading
+    BufferResources transformBuffers[MAX_FRAMES_IN_FLIGHT];
+    BufferResources lightingBuffers[MAX_FRAMES_IN_FLIGHT];
     BufferResources materialBuffer;
-    BufferResources cascadeSplitsBuffer;
+    BufferResources cascadeSplitsBuffers[MAX_FRAMES_IN_FLIGHT];
+    // InstanceData of the geometry pass and all cascades of the shadow pass,
+    // host visible and grown by resizeInstanceBuffer() when it gets too small
+    BufferResources instanceBuffers[MAX_FRAMES_IN_FLIGHT];
+    uint32_t        instanceCapacities[MAX_FRAMES_IN_FLIGHT] = {};
+    // ObjectData of all entities at the index of their handle, read by the
+    // geometry, the shadow and the culling pass. Host visible, only the
+    // entities that changed are rewritten and resizeObjectBuffer() keeps the
+    // content when it grows the buffer
+    BufferResources objectBuffers[MAX_FRAMES_IN_FLIGHT];
+    uint32_t        objectCapacities[MAX_FRAMES_IN_FLIGHT] = {};
+    // LightData of all point lights, host visible and only rewritten when the
+    // lights of the scene changed, grown by resizeLightBuffer()
+    BufferResources lightBuffers[MAX_FRAMES_IN_FLIGHT];
+    uint32_t        lightCapacities[MAX_FRAMES_IN_FLIGHT] = {};
 
     VkDescriptorSetLayout transformDescriptorSetLayout;
-    VkDescriptorSet       transformDescriptorSet;
+    VkDescriptorSet       transformDescriptorSets[MAX_FRAMES_IN_FLIGHT];
 
     VkDescriptorSetLayout materialDescriptorSetLayout;
     VkDescriptorSet       materialDescriptorSet;
 
+    // shadow maps and the cascade splits and matrices of a frame
     VkDescriptorSetLayout depthDescriptorSetLayout;
-    VkDescriptorSet       depthDescriptorSet;
+    VkDescriptorSet       depthDescriptorSets[MAX_FRAMES_IN_FLIGHT];
 
     VkDescriptorSetLayout gBufferDescriptorSetLayout;
     VkDescriptorSet       gBufferDescriptorSet;
@@ -150,11 +191,57 @@ typedef struct
     RenderPassContext renderPassContext;
 } MainPass;
 
+// compute pass that culls all instances of the draw list against the camera
+// and the cascades and writes the indirect draws of the geometry and the
+// shadow pass, all buffers exist once per frame in flight
+typedef struct
+{
+    BufferResources cullingUniformBuffers[MAX_FRAMES_IN_FLIGHT];
+    // one CullInstance per InstanceData, host visible
+    BufferResources cullInstanceBuffers[MAX_FRAMES_IN_FLIGHT];
+    // MAX_CULLING_VIEWS ranges of instanceCapacity DrawCommands, device local
+    BufferResources drawCommandBuffers[MAX_FRAMES_IN_FLIGHT];
+    // MAX_CULLING_VIEWS ranges of instanceCapacity counts, host visible so the
+    // statistics can be read back after the fence of the frame
+    BufferResources drawCountBuffers[MAX_FRAMES_IN_FLIGHT];
+    uint32_t        instanceCapacities[MAX_FRAMES_IN_FLIGHT] = {};
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorSet       descriptorSets[MAX_FRAMES_IN_FLIGHT];
+
+    VkPipelineLayout pipelineLayout;
+    VkPipeline       pipeline;
+} CullingPass;
+
+// compute pass that bins the point lights into screen tiles with the depth of
+// the geometry pass, a full screen pipeline of the main render pass then
+// shades every pixel with the lights of its tile instead of drawing the light
+// volumes with the stencil test
+typedef struct
+{
+    // LIGHT_TILE_STRIDE uints per tile, device local
+    BufferResources tileLightBuffers[MAX_FRAMES_IN_FLIGHT];
+    uint32_t        tileCapacities[MAX_FRAMES_IN_FLIGHT] = {};
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorSet       descriptorSets[MAX_FRAMES_IN_FLIGHT];
+
+    VkPipelineLayout pipelineLayout;
+    VkPipeline       pipeline;
+
+    VkPipelineLayout shadingPipelineLayout;
+    VkPipeline       shadingPipeline;
+} LightTilingPass;
+
 typedef struct
 {
     MainPass mainPass;
 
     ShadowPass shadowPass;
+
+    CullingPass cullingPass;
+
+    LightTilingPass lightTilingPass;
 } RenderPasses;
 
 typedef struct
@@ -173,7 +260,33 @@ typedef struct
     int lightDrawCalls      = 0;
     int shadowPassDrawCalls = 0;
 
+    bool frustumCulling = true;
+    // cull on the GPU and draw with vkCmdDrawIndexedIndirectCount, only
+    // possible if VulkanBaseContext::supportsIndirectCount is set
+    bool gpuCulling = false;
+    // entities with a model that were inside or outside the camera frustum
+    int visibleObjects = 0;
+    int culledObjects  = 0;
+    // instances drawn by the instanced draw calls of the passes
+    int meshInstances        = 0;
+    int shadowPassInstances  = 0;
+    // vertex and index buffer binds that were the same as for the previous draw
+    int skippedBinds         = 0;
+    // cascades whose static casters or whole shadow map were not redrawn
+    int cachedCascades       = 0;
+    // record the cascades and the slices of the geometry pass on the workers
+    // of the thread pool instead of one after the other
+    bool parallelRecording = true;
+
     bool pointLights = true;
+    // shade the point lights per screen tile instead of with light volumes
+    bool tiledLighting = false;
+    // only the maxLights visible point lights with the largest screen
+    // coverage times intensity are drawn
+    bool lightBudget = false;
+    int  maxLights   = 64;
+    // point lights outside the camera frustum or over the budget
+    int culledLights = 0;
     // NOTE: this must always be true on startup, can modify at runtime via ImGui
     bool  shadows  = true;
     bool  autoIbl   = true;
@@ -232,6 +345,22 @@ typedef struct
     float cascadeSplitsBlendFactor = 0.5;
     bool  newCascadeCalculation    = true;
     bool  crossProductUp           = false;
+
+    // bound the cascades by spheres and snap them to shadow map texels, so
+    // the shadows neither change with the camera rotation nor flicker when
+    // the camera moves. Replaces the two calculations above.
+    bool stabilizeCascades = true;
+    // keep the static shadow casters of every cascade in a cached shadow map
+    // and only draw the dynamic ones each frame, needs stabilizeCascades and
+    // the culling on the CPU
+    bool cacheStaticShadows = true;
+    // the cascades are larger by this fraction of their radius when cached,
+    // so the camera can move that far before they have to be redrawn
+    float cacheMargin = 0.15f;
+    // the cascades from firstFarCascade on are only redrawn every
+    // farCascadeInterval frames unless they have to move, needs stabilizeCascades
+    int firstFarCascade    = 2;
+    int farCascadeInterval = 4;
 } ShadowMappingSettings;
 
 typedef struct
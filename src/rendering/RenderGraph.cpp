@@ -0,0 +1,262 @@
+#include "RenderGraph.h"
+#include <stdexcept>
+
+typedef struct
+{
+    VkPipelineStageFlags stages;
+    VkAccessFlags        access;
+    // ignored for buffers
+    VkImageLayout layout;
+    bool          write;
+} UsageInfo;
+
+static UsageInfo getUsageInfo(ResourceUsage usage) {
+    switch(usage) {
+        case ResourceUsage::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true};
+        case ResourceUsage::DepthStencilAttachment:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+                        | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                        | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true};
+        case ResourceUsage::DepthReadStencilAttachment:
+            // storing the stencil counts as write
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+                        | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+                        | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                        | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                        | VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL, true};
+        case ResourceUsage::ComputeDepthSampled:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL, false};
+        case ResourceUsage::FragmentSampled:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+        case ResourceUsage::FragmentDepthSampled:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false};
+        case ResourceUsage::TransferWrite:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true};
+        case ResourceUsage::IndirectRead:
+            return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED, false};
+        case ResourceUsage::ComputeStorageWrite:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED, true};
+        case ResourceUsage::FragmentStorageRead:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED, false};
+        case ResourceUsage::HostRead:
+            return {VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT,
+                    VK_IMAGE_LAYOUT_UNDEFINED, false};
+    }
+    throw std::runtime_error("unknown resource usage!");
+}
+
+// only writes have to be made available
+static const VkAccessFlags WRITE_ACCESS_MASK =
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+    | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+    | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+void RenderGraph::clear() {
+    resources.clear();
+    passes.clear();
+}
+
+RenderResource RenderGraph::addImage(const ImageResources& image, VkImageAspectFlags aspectMask,
+                                     uint32_t layerCount, bool transient) {
+    Resource resource;
+    resource.image      = &image;
+    resource.aspectMask = aspectMask;
+    resource.layerCount = layerCount;
+
+    // the last accesses stay, the next write still has to wait for them
+    if(transient) {
+        imageStates[&image].layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    }
+
+    resources.push_back(resource);
+    return static_cast<RenderResource>(resources.size() - 1);
+}
+
+RenderResource RenderGraph::addBuffer(const BufferResources& buffer) {
+    Resource resource;
+    resource.buffer = &buffer;
+
+    resources.push_back(resource);
+    return static_cast<RenderResource>(resources.size() - 1);
+}
+
+uint32_t RenderGraph::addPass(const std::string& name, std::function<void()> record) {
+    passes.push_back({name, std::move(record), {}});
+    return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void RenderGraph::use(uint32_t pass, RenderResource resource, ResourceUsage usage) {
+    use(pass, resource, usage, usage);
+}
+
+void RenderGraph::use(uint32_t pass, RenderResource resource, ResourceUsage usage,
+                      ResourceUsage endUsage) {
+    // a single barrier per resource and pass, the usages combine all
+    // accesses of a pass
+    for(const ResourceAccess& access : passes[pass].accesses) {
+        if(access.resource == resource) {
+            throw std::runtime_error("render graph pass uses a resource twice!");
+        }
+    }
+    passes[pass].accesses.push_back({resource, usage, endUsage});
+}
+
+void RenderGraph::setFinalUsage(RenderResource resource, ResourceUsage usage) {
+    resources[resource].hasFinalUsage = true;
+    resources[resource].finalUsage    = usage;
+}
+
+RenderGraph::ResourceState& RenderGraph::getState(Resource& resource) {
+    return resource.image != nullptr ? imageStates[resource.image] : resource.bufferState;
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer, GpuProfiler& profiler) {
+    for(Pass& pass : passes) {
+        profiler.beginScope(commandBuffer, pass.name);
+
+        BarrierBatch batch;
+        for(const ResourceAccess& access : pass.accesses) {
+            addBarrier(resources[access.resource], access.usage, batch);
+        }
+        recordBarriers(commandBuffer, batch);
+
+        pass.record();
+
+        profiler.endScope(commandBuffer);
+
+        // the pass transitioned the image or changed the access itself
+        for(const ResourceAccess& access : pass.accesses) {
+            if(access.endUsage == access.usage) {
+                continue;
+            }
+            UsageInfo      info  = getUsageInfo(access.endUsage);
+            ResourceState& state = getState(resources[access.resource]);
+            state.layout         = info.layout;
+            if(info.write) {
+                state.writeStages = info.stages;
+                state.writeAccess = info.access & WRITE_ACCESS_MASK;
+                state.readStages  = 0;
+                state.readAccess  = 0;
+            } else {
+                state.readStages |= info.stages;
+                state.readAccess |= info.access;
+            }
+        }
+    }
+
+    BarrierBatch finalBatch;
+    for(Resource& resource : resources) {
+        if(resource.hasFinalUsage) {
+            addBarrier(resource, resource.finalUsage, finalBatch);
+        }
+    }
+    recordBarriers(commandBuffer, finalBatch);
+}
+
+void RenderGraph::addBarrier(Resource& resource, ResourceUsage usage, BarrierBatch& batch) {
+    UsageInfo      info  = getUsageInfo(usage);
+    ResourceState& state = getState(resource);
+
+    bool transition = resource.image != nullptr && state.layout != info.layout;
+
+    VkPipelineStageFlags srcStages = 0;
+    VkAccessFlags        srcAccess = 0;
+    if(transition || info.write) {
+        // waits for all earlier accesses, the reads since the last write
+        // already wait for it
+        srcStages = state.readStages != 0 ? state.readStages : state.writeStages;
+        srcAccess = state.readStages != 0 ? 0 : state.writeAccess;
+    } else if(state.writeStages != 0
+              && ((info.stages & ~state.readStages) != 0 || (info.access & ~state.readAccess) != 0)) {
+        // read after write that no earlier barrier made visible to the stage
+        srcStages = state.writeStages;
+        srcAccess = state.writeAccess;
+    }
+
+    bool needsBarrier = transition || srcStages != 0;
+    if(needsBarrier) {
+        // the first access ever or of a transient image in this frame
+        if(srcStages == 0) {
+            srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        }
+        batch.srcStages |= srcStages;
+        batch.dstStages |= info.stages;
+
+        if(resource.image != nullptr) {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcAccessMask                   = srcAccess;
+            barrier.dstAccessMask                   = info.access;
+            barrier.oldLayout                       = state.layout;
+            barrier.newLayout                       = info.layout;
+            barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image                           = resource.image->image;
+            barrier.subresourceRange.aspectMask     = resource.aspectMask;
+            barrier.subresourceRange.baseMipLevel   = 0;
+            barrier.subresourceRange.levelCount     = 1;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount     = resource.layerCount;
+            batch.imageBarriers.push_back(barrier);
+        } else {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask       = srcAccess;
+            barrier.dstAccessMask       = info.access;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer              = resource.buffer->buffer;
+            barrier.offset              = 0;
+            barrier.size                = VK_WHOLE_SIZE;
+            batch.bufferBarriers.push_back(barrier);
+        }
+    }
+
+    if(resource.image != nullptr) {
+        state.layout = info.layout;
+    }
+
+    if(info.write) {
+        state.writeStages = info.stages;
+        state.writeAccess = info.access & WRITE_ACCESS_MASK;
+        state.readStages  = 0;
+        state.readAccess  = 0;
+    } else if(transition) {
+        // the transition is a write that is done before the stages of the
+        // barrier, later reads wait for these stages
+        state.writeStages = info.stages;
+        state.writeAccess = 0;
+        state.readStages  = info.stages;
+        state.readAccess  = info.access;
+    } else {
+        state.readStages |= info.stages;
+        state.readAccess |= info.access;
+    }
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch) {
+    if(batch.imageBarriers.empty() && batch.bufferBarriers.empty()) {
+        return;
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, batch.srcStages, batch.dstStages, 0, 0, nullptr,
+                         static_cast<uint32_t>(batch.bufferBarriers.size()),
+                         batch.bufferBarriers.data(),
+                         static_cast<uint32_t>(batch.imageBarriers.size()),
+                         batch.imageBarriers.data());
+}
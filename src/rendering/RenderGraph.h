@@ -0,0 +1,151 @@
+#ifndef GRAPHICSPRAKTIKUM_RENDERGRAPH_H
+#define GRAPHICSPRAKTIKUM_RENDERGRAPH_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+#include "RenderContext.h"
+#include "vulkan/GpuProfiler.h"
+
+// How a pass accesses a resource, decides the stages and accesses a barrier
+// waits for and the layout an image is moved to.
+enum class ResourceUsage
+{
+    // images
+    ColorAttachment,
+    // depth and stencil test and write
+    DepthStencilAttachment,
+    // read only depth test, stencil test and write and the depth sampled by
+    // the fragment shader at the same time
+    DepthReadStencilAttachment,
+    // depth sampled by a compute shader, same layout as
+    // DepthReadStencilAttachment
+    ComputeDepthSampled,
+    FragmentSampled,
+    // sampled by a fragment shader in the read only depth stencil layout
+    FragmentDepthSampled,
+    TransferWrite,
+
+    // buffers
+    IndirectRead,
+    // read and written by a compute shader
+    ComputeStorageWrite,
+    FragmentStorageRead,
+    // read by the host after the fence of the frame
+    HostRead
+};
+
+// index of a resource added to the graph this frame
+typedef uint32_t RenderResource;
+
+// Records the passes of a frame in the order they were added and the barriers
+// in front of them. Every pass declares the resources it uses and how, the
+// graph derives the layout transitions and the execution and memory
+// dependencies from the earlier accesses to each resource, batched into one
+// vkCmdPipelineBarrier per pass. Reads after reads need no barrier and a read
+// that an earlier barrier already made the write visible to is skipped.
+//
+// The passes and resources are added again every frame, the layouts and the
+// last accesses of the images are kept across frames because the barriers of
+// a frame also have to wait for the accesses of the previous one.
+class RenderGraph
+{
+  private:
+    struct ResourceState
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // the stages of the last write and the accesses that wrote
+        VkPipelineStageFlags writeStages = 0;
+        VkAccessFlags        writeAccess = 0;
+        // the reads since the last write, the write is visible to them
+        VkPipelineStageFlags readStages = 0;
+        VkAccessFlags        readAccess = 0;
+    };
+
+    struct Resource
+    {
+        // the handles are read when the barriers are recorded, so the passes
+        // can still recreate a buffer that grew
+        const ImageResources*  image  = nullptr;
+        const BufferResources* buffer = nullptr;
+        VkImageAspectFlags     aspectMask = 0;
+        uint32_t               layerCount = 1;
+        // per frame buffers start without accesses, the state of an image is
+        // in imageStates
+        ResourceState bufferState;
+
+        bool          hasFinalUsage = false;
+        ResourceUsage finalUsage;
+    };
+
+    struct ResourceAccess
+    {
+        RenderResource resource;
+        ResourceUsage  usage;
+        // the access the pass ends with if it changes the layout itself
+        ResourceUsage endUsage;
+    };
+
+    struct Pass
+    {
+        std::string                 name;
+        std::function<void()>       record;
+        std::vector<ResourceAccess> accesses;
+    };
+
+    struct BarrierBatch
+    {
+        VkPipelineStageFlags               srcStages = 0;
+        VkPipelineStageFlags               dstStages = 0;
+        std::vector<VkImageMemoryBarrier>  imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    };
+
+    std::vector<Resource> resources;
+    std::vector<Pass>     passes;
+
+    // layouts and last accesses of all images ever added
+    std::unordered_map<const ImageResources*, ResourceState> imageStates;
+
+  public:
+    // removes the passes and resources of the last frame
+    void clear();
+
+    // An image whose state is kept between frames. A transient image is only
+    // needed within a frame, its content is discarded by the first access.
+    RenderResource addImage(const ImageResources& image, VkImageAspectFlags aspectMask,
+                            uint32_t layerCount, bool transient);
+
+    // a buffer of the current frame in flight, it is only reused once the fence
+    // of its frame was waited for
+    RenderResource addBuffer(const BufferResources& buffer);
+
+    // the pass records into the command buffer passed to execute(), returns
+    // the index for use()
+    uint32_t addPass(const std::string& name, std::function<void()> record);
+
+    void use(uint32_t pass, RenderResource resource, ResourceUsage usage);
+
+    // the pass changes the layout or the access itself before it ends, for
+    // example with a render pass whose final layout is the one of endUsage
+    void use(uint32_t pass, RenderResource resource, ResourceUsage usage, ResourceUsage endUsage);
+
+    // the usage after the last pass, for example reads by the host
+    void setFinalUsage(RenderResource resource, ResourceUsage usage);
+
+    // records the passes and the barriers between them, each pass with its
+    // barriers is a scope of the profiler
+    void execute(VkCommandBuffer commandBuffer, GpuProfiler& profiler);
+
+  private:
+    ResourceState& getState(Resource& resource);
+
+    // adds the barrier the usage needs to the batch and updates the state
+    void addBarrier(Resource& resource, ResourceUsage usage, BarrierBatch& batch);
+
+    void recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch);
+};
+
+#endif  // GRAPHICSPRAKTIKUM_RENDERGRAPH_H
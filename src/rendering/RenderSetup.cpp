@@ -1,5 +1,6 @@
 #include <stdexcept>
 #include <filesystem>
+#include <array>
 #include "RenderSetup.h"
 #include "vulkan/VulkanUtils.h"
 #include "rendering/host_device.h"
@@ -90,6 +91,25 @@ void initializeRenderContext(ApplicationVulkanContext& appContext,
     // after main Render Pass since we need materials buffer
     createShadowPassDescriptorSets(appContext, renderContext, scene);
 
+    // both passes read the instance buffers of the main pass, the light
+    // volumes of the main pass the light buffers
+    for(uint32_t frame = 0; frame < appContext.graphicSettings.framesInFlight; frame++) {
+        updateInstanceDescriptorSets(appContext, renderContext, frame);
+        updateLightDescriptorSet(appContext, renderContext, frame);
+    }
+
+    // --- Culling Pass
+    initializeCullingPass(appContext, renderContext);
+
+    // the geometry, the shadow and the culling pass read the object buffers
+    for(uint32_t frame = 0; frame < appContext.graphicSettings.framesInFlight; frame++) {
+        updateObjectDescriptorSets(appContext, renderContext, frame);
+    }
+
+    // --- Light Tiling Pass
+    // after main Render Pass since the pipelines use its sets and render pass
+    initializeLightTilingPass(appContext, renderContext);
+
     renderContext.renderSetupDescription = renderSetupDescription;
     createFrameBuffers(appContext, renderContext);
 
@@ -160,6 +180,10 @@ void cleanupRenderContext(const VulkanBaseContext& baseContext, RenderContext& r
 
     cleanShadowPass(baseContext, renderContext.renderPasses.shadowPass);
 
+    cleanCullingPass(baseContext, renderContext.renderPasses.cullingPass);
+
+    cleanLightTilingPass(baseContext, renderContext.renderPasses.lightTilingPass);
+
     vkDestroyDescriptorPool(baseContext.device, renderContext.descriptorPool, nullptr);
 }
 
@@ -245,7 +269,9 @@ void createMainRenderPass(const ApplicationVulkanContext& appContext,
     renderPassInfo.subpassCount    = 1;
     renderPassInfo.pSubpasses      = &subpass;
 
-    std::array<VkSubpassDependency, 2> dependencies;
+    // only the color attachment, the depth attachment of the gBuffer is
+    // synchronized by the render graph
+    std::array<VkSubpassDependency, 1> dependencies;
 
     dependencies[0].srcSubpass      = VK_SUBPASS_EXTERNAL;
     dependencies[0].dstSubpass      = 0;
@@ -268,14 +294,6 @@ void createMainRenderPass(const ApplicationVulkanContext& appContext,
                                                                                // VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     }
 
-    dependencies[1].srcSubpass    = 0;
-    dependencies[1].dstSubpass    = VK_SUBPASS_EXTERNAL;
-    dependencies[1].srcStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    dependencies[1].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
     renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
     renderPassInfo.pDependencies   = dependencies.data();
 
@@ -322,18 +340,17 @@ void createGeometryRenderPass(const ApplicationVulkanContext& appContext,
         attachmentDescs[i].storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
         attachmentDescs[i].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         attachmentDescs[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        // need special case for depth attachment
+        // need special case for depth attachment, the render graph moves the
+        // attachments into and out of the layouts of the subpass
         if(i == 3) {
-            attachmentDescs[i].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            // attachmentDescs[i].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            attachmentDescs[i].finalLayout =
-                VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_STENCIL_ATTACHMENT_OPTIMAL;
+            attachmentDescs[i].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            attachmentDescs[i].finalLayout   = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
             // stencil buffer should be conserved within a frame
             attachmentDescs[i].stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR;
             attachmentDescs[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
         } else {
-            attachmentDescs[i].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            attachmentDescs[i].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            attachmentDescs[i].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            attachmentDescs[i].finalLayout   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
         }
     }
 
@@ -363,25 +380,8 @@ void createGeometryRenderPass(const ApplicationVulkanContext& appContext,
     subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
     subpass.pDepthStencilAttachment = &depthReference;
 
-    std::array<VkSubpassDependency, 2> dependencies;
-
-    dependencies[0].srcSubpass   = VK_SUBPASS_EXTERNAL;
-    dependencies[0].dstSubpass   = 0;
-    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT
-                                    | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    dependencies[1].srcSubpass = 0;
-    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependencies[1].dstStageMask  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT
-                                    | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    dependencies[1].dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT;
-    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+    // no external dependencies, the barriers of the render graph in front of
+    // the geometry pass and the passes reading the gBuffer synchronize it
 
     // create render pass
     VkRenderPassCreateInfo renderPassCreateInfo = {};
@@ -390,8 +390,8 @@ void createGeometryRenderPass(const ApplicationVulkanContext& appContext,
     renderPassCreateInfo.attachmentCount = static_cast<uint32_t>(attachmentDescs.size());
     renderPassCreateInfo.subpassCount    = 1;
     renderPassCreateInfo.pSubpasses      = &subpass;
-    renderPassCreateInfo.dependencyCount = 2;
-    renderPassCreateInfo.pDependencies   = dependencies.data();
+    renderPassCreateInfo.dependencyCount = 0;
+    renderPassCreateInfo.pDependencies   = nullptr;
     if(vkCreateRenderPass(appContext.baseContext.device, &renderPassCreateInfo,
                           nullptr, &renderContext.renderPasses.mainPass.geometryPass)
        != VK_SUCCESS) {
@@ -448,6 +448,12 @@ void initializeShadowPass(const ApplicationVulkanContext& appContext,
     bindings.push_back(createLayoutBinding(SceneBindings::eCamera, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                                            getStageFlag(ShaderStage::VERTEX_SHADER)));
 
+    bindings.push_back(createLayoutBinding(SceneBindings::eInstances, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           getStageFlag(ShaderStage::VERTEX_SHADER)));
+
+    bindings.push_back(createLayoutBinding(SceneBindings::eObjects, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           getStageFlag(ShaderStage::VERTEX_SHADER)));
+
     materialBindings.push_back(
         createLayoutBinding(MaterialsBindings::eMaterials, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                             getStageFlag(ShaderStage::FRAGMENT_SHADER)));
@@ -469,66 +475,27 @@ void initializeShadowPass(const ApplicationVulkanContext& appContext,
     shadowPassLayouts.push_back(shadowPass.transformDescriptorSetLayout);
     shadowPassLayouts.push_back(shadowPass.materialDescriptorSetLayout);
 
-    // Shadow Depth Buffer Attachment
-    VkAttachmentDescription depthAttachment{};
-    createBlankAttachment(appContext, depthAttachment, VK_SAMPLE_COUNT_1_BIT,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
-
-    depthAttachment.format  = findDepthFormat(appContext.baseContext);
-    depthAttachment.loadOp  = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-
-    VkAttachmentReference depthAttachmentRef{};
-    depthAttachmentRef.attachment = 0;
-    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount    = 0;
-    subpass.pColorAttachments       = VK_NULL_HANDLE;
-    subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-    VkRenderPassCreateInfo renderPassInfo{};
-    renderPassInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments    = &depthAttachment;
-    renderPassInfo.subpassCount    = 1;
-    renderPassInfo.pSubpasses      = &subpass;
-
-    std::array<VkSubpassDependency, 2> dependencies;
-
-    dependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
-    dependencies[0].dstSubpass    = 0;
-    dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    dependencies[1].srcSubpass   = 0;
-    dependencies[1].dstSubpass   = VK_SUBPASS_EXTERNAL;
-    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    dependencies[1].dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
-    dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
-    renderPassInfo.pDependencies   = dependencies.data();
-
-    if(vkCreateRenderPass(appContext.baseContext.device, &renderPassInfo,
-                          nullptr, &shadowPass.renderPassContext.renderPass)
-       != VK_SUCCESS) {
-        throw std::runtime_error("failed to create render pass!");
+    if(appContext.baseContext.supportsMultiview) {
+        shadowPass.useMultiview = true;
+    } else if(appContext.baseContext.supportsShaderOutputLayer) {
+        shadowPass.useMultiview = false;
+    } else {
+        throw std::runtime_error("shadow pass needs multiview or shaderOutputLayer!");
     }
 
+    createShadowRenderPasses(appContext, shadowPass,
+                             renderContext.renderSettings.shadowMappingSettings.numberCascades);
+
     std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 
     descriptorSetLayouts.push_back(shadowPass.transformDescriptorSetLayout);
     descriptorSetLayouts.push_back(shadowPass.materialDescriptorSetLayout);
 
     shadowPass.renderPassContext.renderPassDescription = renderPassDescription;
+    if(!shadowPass.useMultiview) {
+        shadowPass.renderPassContext.renderPassDescription.vertexShader.shaderSourceName =
+            "shadowLayered.vert";
+    }
     createShadowPipeline(appContext, shadowPass);
 
     /*
@@ -547,40 +514,173 @@ void initializeShadowPass(const ApplicationVulkanContext& appContext,
 
     VkFormat depthFormat = findDepthFormat(appContext.baseContext);
 
-    for(size_t i = 0; i < MAX_CASCADES; i++) {
-        ImageResources& currentDepthImage = shadowPass.depthImages[i];
+    ImageResources& depthImage = shadowPass.depthImage;
+
+    createImage(appContext.baseContext, SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT, 1, MAX_CASCADES,
+                VK_SAMPLE_COUNT_1_BIT, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+                    | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage.image, depthImage.memory);
+
+    depthImage.imageFormat = depthFormat;
+    depthImage.imageView   = createImageArrayView(appContext.baseContext, depthImage.image,
+                                                  depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT,
+                                                  MAX_CASCADES);
+
+    ImageResources& staticDepthImage = shadowPass.staticDepthImage;
+
+    createImage(appContext.baseContext, SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT, 1, MAX_CASCADES,
+                VK_SAMPLE_COUNT_1_BIT, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+                    | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, staticDepthImage.image,
+                staticDepthImage.memory);
+
+    staticDepthImage.imageFormat = depthFormat;
+    staticDepthImage.imageView =
+        createImageArrayView(appContext.baseContext, staticDepthImage.image, depthFormat,
+                             VK_IMAGE_ASPECT_DEPTH_BIT, MAX_CASCADES);
+
+    initializeShadowDepthBuffer(appContext, shadowPass, SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT);
+}
+
+void createShadowRenderPasses(const ApplicationVulkanContext& appContext,
+                              ShadowPass&                     shadowPass,
+                              int                             cascadeCount) {
+    // multiview only draws the active cascades, without it every instance
+    // selects its cascade anyway
+    shadowPass.cascadeCount = cascadeCount;
+    shadowPass.viewMask     = (1u << cascadeCount) - 1;
+
+    // the layers of the depth image are cleared or copied from the cache
+    // before the render pass loads them
+    std::array<VkSubpassDependency, 2> dependencies;
+
+    dependencies[0].srcSubpass    = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass    = 0;
+    dependencies[0].srcStageMask  = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[0].dstStageMask  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+                                   | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                                    | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[0].dependencyFlags = 0;
+
+    // the cache is copied into the shadow maps, both render passes need the
+    // same dependencies to be compatible with the pipeline and the secondary
+    // command buffers, the reads of the shadow maps by the lighting pass are
+    // synchronized by the render graph
+    dependencies[1].srcSubpass      = 0;
+    dependencies[1].dstSubpass      = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask    = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].dstStageMask    = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[1].srcAccessMask   = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstAccessMask   = VK_ACCESS_TRANSFER_READ_BIT;
+    dependencies[1].dependencyFlags = 0;
+
+    createShadowRenderPass(appContext, shadowPass.useMultiview, shadowPass.viewMask,
+                           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, dependencies,
+                           shadowPass.renderPassContext.renderPass);
+
+    createShadowRenderPass(appContext, shadowPass.useMultiview, shadowPass.viewMask,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dependencies,
+                           shadowPass.staticRenderPass);
+}
+
+void recreateShadowRenderPasses(const ApplicationVulkanContext& appContext,
+                                ShadowPass&                     shadowPass,
+                                int                             cascadeCount) {
+    vkDestroyFramebuffer(appContext.baseContext.device, shadowPass.depthFrameBuffer, nullptr);
+    vkDestroyFramebuffer(appContext.baseContext.device, shadowPass.staticDepthFrameBuffer,
+                         nullptr);
+    vkDestroyRenderPass(appContext.baseContext.device, shadowPass.renderPassContext.renderPass,
+                        nullptr);
+    vkDestroyRenderPass(appContext.baseContext.device, shadowPass.staticRenderPass, nullptr);
+    cleanShadowPipeline(appContext.baseContext, shadowPass);
+
+    createShadowRenderPasses(appContext, shadowPass, cascadeCount);
+    initializeShadowDepthBuffer(appContext, shadowPass, shadowPass.shadowMapWidth,
+                                shadowPass.shadowMapHeight);
+    createShadowPipeline(appContext, shadowPass);
+}
+
+void createShadowRenderPass(const ApplicationVulkanContext&           appContext,
+                            bool                                      useMultiview,
+                            uint32_t                                  viewMask,
+                            VkImageLayout                             finalLayout,
+                            const std::array<VkSubpassDependency, 2>& dependencies,
+                            VkRenderPass&                             renderPass) {
+    // Shadow Depth Buffer Attachment, the layers that are drawn were cleared
+    // or copied before and the others are kept
+    VkAttachmentDescription depthAttachment{};
+    createBlankAttachment(appContext, depthAttachment, VK_SAMPLE_COUNT_1_BIT,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout);
+
+    depthAttachment.format  = findDepthFormat(appContext.baseContext);
+    depthAttachment.loadOp  = VK_ATTACHMENT_LOAD_OP_LOAD;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 0;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount    = 0;
+    subpass.pColorAttachments       = VK_NULL_HANDLE;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments    = &depthAttachment;
+    renderPassInfo.subpassCount    = 1;
+    renderPassInfo.pSubpasses      = &subpass;
+
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies   = dependencies.data();
 
-        createImage(appContext.baseContext, SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT, 1,
-                    1, VK_SAMPLE_COUNT_1_BIT, depthFormat, VK_IMAGE_TILING_OPTIMAL,
-                    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    currentDepthImage.image, currentDepthImage.memory);
+    // one view per active cascade, the views of the cascades are not related
+    VkRenderPassMultiviewCreateInfo multiviewInfo{};
+    multiviewInfo.sType        = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+    multiviewInfo.subpassCount = 1;
+    multiviewInfo.pViewMasks   = &viewMask;
 
-        currentDepthImage.imageView =
-            createImageView(appContext.baseContext, currentDepthImage.image,
-                            depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
+    if(useMultiview) {
+        renderPassInfo.pNext = &multiviewInfo;
+    }
 
-        initializeShadowDepthBuffer(appContext, shadowPass, SHADOW_MAP_WIDTH,
-                                    SHADOW_MAP_HEIGHT, i);
+    if(vkCreateRenderPass(appContext.baseContext.device, &renderPassInfo, nullptr, &renderPass)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create render pass!");
     }
 }
 
 void initializeShadowDepthBuffer(const ApplicationVulkanContext& appContext,
                                  ShadowPass&                     shadowPass,
                                  uint32_t                        width,
-                                 uint32_t                        height,
-                                 uint32_t                        index) {
+                                 uint32_t                        height) {
     VkFramebufferCreateInfo framebufferInfo{};
     framebufferInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
     framebufferInfo.renderPass      = shadowPass.renderPassContext.renderPass;
     framebufferInfo.attachmentCount = 1;
-    framebufferInfo.pAttachments    = &shadowPass.depthImages[index].imageView;
+    framebufferInfo.pAttachments    = &shadowPass.depthImage.imageView;
     framebufferInfo.width           = width;
     framebufferInfo.height          = height;
-    framebufferInfo.layers          = 1;
+    // multiview selects the layers with the view mask
+    framebufferInfo.layers = shadowPass.useMultiview ? 1 : MAX_CASCADES;
+
+    if(vkCreateFramebuffer(appContext.baseContext.device, &framebufferInfo,
+                           nullptr, &shadowPass.depthFrameBuffer)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create framebuffer!");
+    }
+
+    framebufferInfo.renderPass   = shadowPass.staticRenderPass;
+    framebufferInfo.pAttachments = &shadowPass.staticDepthImage.imageView;
 
     if(vkCreateFramebuffer(appContext.baseContext.device, &framebufferInfo,
-                           nullptr, &shadowPass.depthFrameBuffers[index])
+                           nullptr, &shadowPass.staticDepthFrameBuffer)
        != VK_SUCCESS) {
         throw std::runtime_error("failed to create framebuffer!");
     }
@@ -1021,7 +1121,9 @@ void createDescriptorPool(const VulkanBaseContext& baseContext, RenderContext& r
 
     uint32_t maxSets = 0;
 
-    uint32_t shadowTransformCount = 1;
+    // the sets with buffers that are written every frame exist once per frame
+    // in flight
+    uint32_t shadowTransformCount = MAX_FRAMES_IN_FLIGHT;
     maxSets += shadowTransformCount;
 
     VkDescriptorPoolSize shadowTransformPoolSize;
@@ -1029,7 +1131,7 @@ void createDescriptorPool(const VulkanBaseContext& baseContext, RenderContext& r
     shadowTransformPoolSize.descriptorCount = shadowTransformCount;
     poolSizes.push_back(shadowTransformPoolSize);
 
-    uint32_t mainTransformCount = 2;
+    uint32_t mainTransformCount = 2 * MAX_FRAMES_IN_FLIGHT;
     maxSets += mainTransformCount;
 
     VkDescriptorPoolSize mainTransformPoolSize;
@@ -1037,6 +1139,38 @@ void createDescriptorPool(const VulkanBaseContext& baseContext, RenderContext& r
     mainTransformPoolSize.descriptorCount = mainTransformCount;
     poolSizes.push_back(mainTransformPoolSize);
 
+    // instance and object buffer in the transform sets of the main and the
+    // shadow pass, light buffer in the one of the main pass
+    uint32_t instanceCount = 5 * MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorPoolSize instancePoolSize;
+    instancePoolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    instancePoolSize.descriptorCount = instanceCount;
+    poolSizes.push_back(instancePoolSize);
+
+    // uniform and instance, command, count and object buffer of the culling pass
+    uint32_t cullingCount = MAX_FRAMES_IN_FLIGHT;
+    maxSets += cullingCount;
+
+    VkDescriptorPoolSize cullingUniformPoolSize;
+    cullingUniformPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    cullingUniformPoolSize.descriptorCount = cullingCount;
+    poolSizes.push_back(cullingUniformPoolSize);
+
+    VkDescriptorPoolSize cullingStoragePoolSize;
+    cullingStoragePoolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    cullingStoragePoolSize.descriptorCount = 4 * cullingCount;
+    poolSizes.push_back(cullingStoragePoolSize);
+
+    // tile light buffer of the light tiling pass
+    uint32_t lightTilingCount = MAX_FRAMES_IN_FLIGHT;
+    maxSets += lightTilingCount;
+
+    VkDescriptorPoolSize lightTilingPoolSize;
+    lightTilingPoolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    lightTilingPoolSize.descriptorCount = lightTilingCount;
+    poolSizes.push_back(lightTilingPoolSize);
+
     uint32_t mainMaterialCount = 1;
     maxSets += mainMaterialCount;
 
@@ -1055,7 +1189,7 @@ void createDescriptorPool(const VulkanBaseContext& baseContext, RenderContext& r
     mainTexturePoolSize.descriptorCount = mainTextureCount;
     poolSizes.push_back(mainTexturePoolSize);
 
-    uint32_t mainDepthCount = 1;
+    uint32_t mainDepthCount = MAX_FRAMES_IN_FLIGHT;
     maxSets += mainDepthCount;
 
     VkDescriptorPoolSize mainDepthPoolSize;
@@ -1080,38 +1214,44 @@ void createDescriptorPool(const VulkanBaseContext& baseContext, RenderContext& r
 void createShadowPassDescriptorSets(const ApplicationVulkanContext& appContext,
                                     RenderContext& renderContext,
                                     Scene&         scene) {
-    ShadowPass& shadowPass = renderContext.renderPasses.shadowPass;
+    ShadowPass& shadowPass     = renderContext.renderPasses.shadowPass;
+    uint32_t    framesInFlight = appContext.graphicSettings.framesInFlight;
+
+    std::vector<VkDescriptorSetLayout> transformLayouts(
+        framesInFlight, renderContext.renderPasses.shadowPass.transformDescriptorSetLayout);
 
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = renderContext.descriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &renderContext.renderPasses.shadowPass.transformDescriptorSetLayout;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts = transformLayouts.data();
 
     if(vkAllocateDescriptorSets(appContext.baseContext.device, &allocInfo,
-                                &shadowPass.transformDescriptorSet)
+                                shadowPass.transformDescriptorSets)
        != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 
     std::vector<VkWriteDescriptorSet> descriptorWrites;
 
-    VkDescriptorBufferInfo bufferInfo{};
-    bufferInfo.buffer = shadowPass.transformBuffer.buffer;
-    bufferInfo.offset = 0;
-    bufferInfo.range  = MAX_CASCADES * sizeof(glm::mat4);
-
-    VkWriteDescriptorSet descriptorWrite;
-    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrite.pNext           = nullptr;
-    descriptorWrite.dstSet          = shadowPass.transformDescriptorSet;
-    descriptorWrite.dstBinding      = SceneBindings::eCamera;
-    descriptorWrite.dstArrayElement = 0;
-    descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrite.descriptorCount = 1;
-    descriptorWrite.pBufferInfo     = &bufferInfo;
-
-    descriptorWrites.emplace_back(descriptorWrite);
+    std::vector<VkDescriptorBufferInfo> bufferInfos(framesInFlight);
+    for(uint32_t frame = 0; frame < framesInFlight; frame++) {
+        bufferInfos[frame].buffer = shadowPass.transformBuffers[frame].buffer;
+        bufferInfos[frame].offset = 0;
+        bufferInfos[frame].range  = MAX_CASCADES * sizeof(glm::mat4);
+
+        VkWriteDescriptorSet descriptorWrite;
+        descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.pNext           = nullptr;
+        descriptorWrite.dstSet          = shadowPass.transformDescriptorSets[frame];
+        descriptorWrite.dstBinding      = SceneBindings::eCamera;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo     = &bufferInfos[frame];
+
+        descriptorWrites.emplace_back(descriptorWrite);
+    }
 
 
     VkDescriptorSetAllocateInfo allocInfoMaterial{};
@@ -1171,15 +1311,21 @@ void createShadowPassDescriptorSets(const ApplicationVulkanContext& appContext,
 void createShadowPassResources(const ApplicationVulkanContext& appContext,
                                RenderContext&                  renderContext) {
 
-    createBufferResources(appContext, MAX_CASCADES * sizeof(glm::mat4),
-                          renderContext.renderPasses.shadowPass.transformBuffer);
+    for(uint32_t frame = 0; frame < appContext.graphicSettings.framesInFlight; frame++) {
+        createBufferResources(appContext, MAX_CASCADES * sizeof(glm::mat4),
+                              renderContext.renderPasses.shadowPass.transformBuffers[frame]);
+    }
 }
 
 void cleanShadowPass(const VulkanBaseContext& baseContext, const ShadowPass& shadowPass) {
-    vkDestroyBuffer(baseContext.device, shadowPass.transformBuffer.buffer, nullptr);
-    vkFreeMemory(baseContext.device, shadowPass.transformBuffer.bufferMemory, nullptr);
+    // buffers of unused frames are VK_NULL_HANDLE, destroying them does nothing
+    for(const BufferResources& transformBuffer : shadowPass.transformBuffers) {
+        vkDestroyBuffer(baseContext.device, transformBuffer.buffer, nullptr);
+        vkFreeMemory(baseContext.device, transformBuffer.bufferMemory, nullptr);
+    }
 
     vkDestroyRenderPass(baseContext.device, shadowPass.renderPassContext.renderPass, nullptr);
+    vkDestroyRenderPass(baseContext.device, shadowPass.staticRenderPass, nullptr);
 
     cleanShadowPipeline(baseContext, shadowPass);
 
@@ -1189,34 +1335,769 @@ void cleanShadowPass(const VulkanBaseContext& baseContext, const ShadowPass& sha
     vkDestroyDescriptorSetLayout(baseContext.device,
                                  shadowPass.materialDescriptorSetLayout, nullptr);
 
-    for(size_t i = 0; i < MAX_CASCADES; i++) {
-        ImageResources currentDepthImage = shadowPass.depthImages[i];
+    for(const ImageResources& depthImage : {shadowPass.depthImage, shadowPass.staticDepthImage}) {
+        vkDestroyImageView(baseContext.device, depthImage.imageView, nullptr);
+
+        vkDestroyImage(baseContext.device, depthImage.image, nullptr);
+        vkFreeMemory(baseContext.device, depthImage.memory, nullptr);
+    }
+
+    vkDestroyFramebuffer(baseContext.device, shadowPass.depthFrameBuffer, nullptr);
+    vkDestroyFramebuffer(baseContext.device, shadowPass.staticDepthFrameBuffer, nullptr);
+}
+
+void initializeCullingPass(const ApplicationVulkanContext& appContext,
+                           RenderContext&                  renderContext) {
+    CullingPass& cullingPass = renderContext.renderPasses.cullingPass;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    bindings.push_back(createLayoutBinding(CullingBindings::eCullingUniform, 1,
+                                           VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                           getStageFlag(ShaderStage::COMPUTE_SHADER)));
+    bindings.push_back(createLayoutBinding(CullingBindings::eCullInstances, 1,
+                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           getStageFlag(ShaderStage::COMPUTE_SHADER)));
+    bindings.push_back(createLayoutBinding(CullingBindings::eDrawCommands, 1,
+                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           getStageFlag(ShaderStage::COMPUTE_SHADER)));
+    bindings.push_back(createLayoutBinding(CullingBindings::eDrawCounts, 1,
+                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           getStageFlag(ShaderStage::COMPUTE_SHADER)));
+    bindings.push_back(createLayoutBinding(CullingBindings::eCullObjects, 1,
+                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           getStageFlag(ShaderStage::COMPUTE_SHADER)));
+
+    createDescriptorSetLayout(appContext.baseContext, cullingPass.descriptorSetLayout, bindings);
+
+    uint32_t framesInFlight = appContext.graphicSettings.framesInFlight;
+
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, cullingPass.descriptorSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool     = renderContext.descriptorPool;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts        = layouts.data();
+
+    if(vkAllocateDescriptorSets(appContext.baseContext.device, &allocInfo,
+                                cullingPass.descriptorSets)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    for(uint32_t frame = 0; frame < framesInFlight; frame++) {
+        createBufferResources(appContext, sizeof(CullingUniform),
+                              cullingPass.cullingUniformBuffers[frame]);
+        createCullingBuffers(appContext, cullingPass, frame, INITIAL_INSTANCE_CAPACITY);
+        updateCullingDescriptorSet(appContext, cullingPass, frame);
+    }
+
+    createCullingPipeline(appContext, cullingPass);
+}
+
+void createCullingBuffers(const ApplicationVulkanContext& appContext,
+                          CullingPass&                    cullingPass,
+                          uint32_t                        frame,
+                          uint32_t                        instanceCapacity) {
+    cullingPass.instanceCapacities[frame] = instanceCapacity;
+
+    createBufferResources(appContext, instanceCapacity * sizeof(CullInstance),
+                          cullingPass.cullInstanceBuffers[frame],
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    createBuffer(appContext.baseContext, MAX_CULLING_VIEWS * instanceCapacity * sizeof(DrawCommand),
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, cullingPass.drawCommandBuffers[frame].buffer,
+                 cullingPass.drawCommandBuffers[frame].bufferMemory);
+
+    // cleared with vkCmdFillBuffer before every dispatch
+    createBufferResources(appContext, MAX_CULLING_VIEWS * instanceCapacity * sizeof(uint32_t),
+                          cullingPass.drawCountBuffers[frame],
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                              | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+}
+
+void cleanCullingBuffers(const VulkanBaseContext& baseContext,
+                         const CullingPass&       cullingPass,
+                         uint32_t                 frame) {
+    vkDestroyBuffer(baseContext.device, cullingPass.cullInstanceBuffers[frame].buffer, nullptr);
+    vkFreeMemory(baseContext.device, cullingPass.cullInstanceBuffers[frame].bufferMemory, nullptr);
+
+    vkDestroyBuffer(baseContext.device, cullingPass.drawCommandBuffers[frame].buffer, nullptr);
+    vkFreeMemory(baseContext.device, cullingPass.drawCommandBuffers[frame].bufferMemory, nullptr);
+
+    vkDestroyBuffer(baseContext.device, cullingPass.drawCountBuffers[frame].buffer, nullptr);
+    vkFreeMemory(baseContext.device, cullingPass.drawCountBuffers[frame].bufferMemory, nullptr);
+}
+
+void updateCullingDescriptorSet(const ApplicationVulkanContext& appContext,
+                                const CullingPass&              cullingPass,
+                                uint32_t                        frame) {
+    std::array<uint32_t, 4> bindings = {CullingBindings::eCullingUniform,
+                                        CullingBindings::eCullInstances,
+                                        CullingBindings::eDrawCommands,
+                                        CullingBindings::eDrawCounts};
+    std::array<VkBuffer, 4> buffers  = {cullingPass.cullingUniformBuffers[frame].buffer,
+                                        cullingPass.cullInstanceBuffers[frame].buffer,
+                                        cullingPass.drawCommandBuffers[frame].buffer,
+                                        cullingPass.drawCountBuffers[frame].buffer};
+
+    std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+    std::array<VkWriteDescriptorSet, 4>   descriptorWrites{};
+
+    for(size_t i = 0; i < descriptorWrites.size(); i++) {
+        bufferInfos[i].buffer = buffers[i];
+        bufferInfos[i].offset = 0;
+        bufferInfos[i].range  = VK_WHOLE_SIZE;
+
+        descriptorWrites[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet          = cullingPass.descriptorSets[frame];
+        descriptorWrites[i].dstBinding      = bindings[i];
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType  = bindings[i] == CullingBindings::eCullingUniform
+                                                  ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+                                                  : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo     = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(appContext.baseContext.device,
+                           static_cast<uint32_t>(descriptorWrites.size()),
+                           descriptorWrites.data(), 0, nullptr);
+}
+
+void resizeCullingBuffers(const ApplicationVulkanContext& appContext,
+                          RenderContext&                  renderContext,
+                          uint32_t                        frame,
+                          uint32_t                        instanceCount) {
+    CullingPass& cullingPass = renderContext.renderPasses.cullingPass;
+    if(instanceCount <= cullingPass.instanceCapacities[frame]) {
+        return;
+    }
+
+    uint32_t instanceCapacity = cullingPass.instanceCapacities[frame];
+    while(instanceCapacity < instanceCount) {
+        instanceCapacity *= 2;
+    }
+
+    cleanCullingBuffers(appContext.baseContext, cullingPass, frame);
+    createCullingBuffers(appContext, cullingPass, frame, instanceCapacity);
+    updateCullingDescriptorSet(appContext, cullingPass, frame);
+}
+
+void createCullingPipeline(const ApplicationVulkanContext& appContext, CullingPass& cullingPass) {
+    Shader computeShader;
+    computeShader.shaderStage      = ShaderStage::COMPUTE_SHADER;
+    computeShader.shaderSourceName = "cull.comp";
+    computeShader.sourceDirectory  = "res/shaders/source/";
+    computeShader.spvDirectory     = "res/shaders/spv/";
 
-        vkDestroyImageView(baseContext.device, currentDepthImage.imageView, nullptr);
+    VkShaderModule computeShaderModule =
+        createShaderModule(appContext.baseContext, computeShader, true);
 
-        vkDestroyImage(baseContext.device, currentDepthImage.image, nullptr);
-        vkFreeMemory(baseContext.device, currentDepthImage.memory, nullptr);
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts    = &cullingPass.descriptorSetLayout;
 
-        vkDestroyFramebuffer(baseContext.device, shadowPass.depthFrameBuffers[i], nullptr);
+    if(vkCreatePipelineLayout(appContext.baseContext.device, &pipelineLayoutInfo,
+                              nullptr, &cullingPass.pipelineLayout)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
     }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = computeShaderModule;
+    pipelineInfo.stage.pName  = "main";
+    pipelineInfo.layout       = cullingPass.pipelineLayout;
+
+    if(vkCreateComputePipelines(appContext.baseContext.device, VK_NULL_HANDLE, 1,
+                                &pipelineInfo, nullptr, &cullingPass.pipeline)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+
+    vkDestroyShaderModule(appContext.baseContext.device, computeShaderModule, nullptr);
+}
+
+void cleanCullingPass(const VulkanBaseContext& baseContext, const CullingPass& cullingPass) {
+    // buffers of unused frames are VK_NULL_HANDLE, destroying them does nothing
+    for(uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+        vkDestroyBuffer(baseContext.device, cullingPass.cullingUniformBuffers[frame].buffer, nullptr);
+        vkFreeMemory(baseContext.device, cullingPass.cullingUniformBuffers[frame].bufferMemory,
+                     nullptr);
+
+        cleanCullingBuffers(baseContext, cullingPass, frame);
+    }
+
+    cleanCullingPipeline(baseContext, cullingPass);
+
+    vkDestroyDescriptorSetLayout(baseContext.device, cullingPass.descriptorSetLayout, nullptr);
+}
+
+void cleanCullingPipeline(const VulkanBaseContext& baseContext, const CullingPass& cullingPass) {
+    vkDestroyPipeline(baseContext.device, cullingPass.pipeline, nullptr);
+    vkDestroyPipelineLayout(baseContext.device, cullingPass.pipelineLayout, nullptr);
+}
+
+void initializeLightTilingPass(const ApplicationVulkanContext& appContext,
+                               RenderContext&                  renderContext) {
+    LightTilingPass& lightTilingPass = renderContext.renderPasses.lightTilingPass;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    bindings.push_back(createLayoutBinding(LightTileBindings::eTileLights, 1,
+                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           getStageFlag(ShaderStage::COMPUTE_SHADER)
+                                               | getStageFlag(ShaderStage::FRAGMENT_SHADER)));
+
+    createDescriptorSetLayout(appContext.baseContext, lightTilingPass.descriptorSetLayout,
+                              bindings);
+
+    uint32_t framesInFlight = appContext.graphicSettings.framesInFlight;
+
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight,
+                                               lightTilingPass.descriptorSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool     = renderContext.descriptorPool;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts        = layouts.data();
+
+    if(vkAllocateDescriptorSets(appContext.baseContext.device, &allocInfo,
+                                lightTilingPass.descriptorSets)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    // enough tiles for the current window, resizeTileLightBuffer() grows them
+    VkExtent2D extent    = appContext.swapchainContext.swapChainExtent;
+    uint32_t   tileCount = getTileCountX(extent) * getTileCountY(extent);
+
+    for(uint32_t frame = 0; frame < framesInFlight; frame++) {
+        createTileLightBuffer(appContext, lightTilingPass, frame, tileCount);
+        updateTileLightDescriptorSet(appContext, lightTilingPass, frame);
+    }
+
+    createLightTilingPipeline(appContext, renderContext);
+    createTiledLightingPipeline(appContext, renderContext);
+}
+
+uint32_t getTileCountX(VkExtent2D extent) {
+    return (extent.width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+}
+
+uint32_t getTileCountY(VkExtent2D extent) {
+    return (extent.height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+}
+
+void createTileLightBuffer(const ApplicationVulkanContext& appContext,
+                           LightTilingPass&                lightTilingPass,
+                           uint32_t                        frame,
+                           uint32_t                        tileCapacity) {
+    lightTilingPass.tileCapacities[frame] = tileCapacity;
+
+    // every tile gets written by the compute shader before it is read
+    createBuffer(appContext.baseContext, tileCapacity * LIGHT_TILE_STRIDE * sizeof(uint32_t),
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                 lightTilingPass.tileLightBuffers[frame].buffer,
+                 lightTilingPass.tileLightBuffers[frame].bufferMemory);
+}
+
+void updateTileLightDescriptorSet(const ApplicationVulkanContext& appContext,
+                                  const LightTilingPass&          lightTilingPass,
+                                  uint32_t                        frame) {
+    VkDescriptorBufferInfo tileLightBufferInfo{};
+    tileLightBufferInfo.buffer = lightTilingPass.tileLightBuffers[frame].buffer;
+    tileLightBufferInfo.offset = 0;
+    tileLightBufferInfo.range  = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet          = lightTilingPass.descriptorSets[frame];
+    descriptorWrite.dstBinding      = LightTileBindings::eTileLights;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo     = &tileLightBufferInfo;
+
+    vkUpdateDescriptorSets(appContext.baseContext.device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void resizeTileLightBuffer(const ApplicationVulkanContext& appContext,
+                           RenderContext&                  renderContext,
+                           uint32_t                        frame,
+                           uint32_t                        tileCount) {
+    LightTilingPass& lightTilingPass = renderContext.renderPasses.lightTilingPass;
+    if(tileCount <= lightTilingPass.tileCapacities[frame]) {
+        return;
+    }
+
+    uint32_t tileCapacity = lightTilingPass.tileCapacities[frame];
+    while(tileCapacity < tileCount) {
+        tileCapacity *= 2;
+    }
+
+    vkDestroyBuffer(appContext.baseContext.device,
+                    lightTilingPass.tileLightBuffers[frame].buffer, nullptr);
+    vkFreeMemory(appContext.baseContext.device,
+                 lightTilingPass.tileLightBuffers[frame].bufferMemory, nullptr);
+
+    createTileLightBuffer(appContext, lightTilingPass, frame, tileCapacity);
+    updateTileLightDescriptorSet(appContext, lightTilingPass, frame);
+}
+
+void createLightTilingPipeline(const ApplicationVulkanContext& appContext,
+                               RenderContext&                  renderContext) {
+    MainPass&        mainPass        = renderContext.renderPasses.mainPass;
+    LightTilingPass& lightTilingPass = renderContext.renderPasses.lightTilingPass;
+
+    Shader computeShader;
+    computeShader.shaderStage      = ShaderStage::COMPUTE_SHADER;
+    computeShader.shaderSourceName = "lightTiles.comp";
+    computeShader.sourceDirectory  = "res/shaders/source/";
+    computeShader.spvDirectory     = "res/shaders/spv/";
+
+    VkShaderModule computeShaderModule =
+        createShaderModule(appContext.baseContext, computeShader, true);
+
+    // camera and lights, depth of the gBuffer, tile lights
+    std::array<VkDescriptorSetLayout, 3> descriptorSetLayouts = {
+        mainPass.transformDescriptorSetLayout, mainPass.gBufferDescriptorSetLayout,
+        lightTilingPass.descriptorSetLayout};
+
+    VkPushConstantRange pushConstantRange =
+        createPushConstantRange(0, sizeof(LightTilePushConstant),
+                                getStageFlag(ShaderStage::COMPUTE_SHADER));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts    = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+    if(vkCreatePipelineLayout(appContext.baseContext.device, &pipelineLayoutInfo,
+                              nullptr, &lightTilingPass.pipelineLayout)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = computeShaderModule;
+    pipelineInfo.stage.pName  = "main";
+    pipelineInfo.layout       = lightTilingPass.pipelineLayout;
+
+    if(vkCreateComputePipelines(appContext.baseContext.device, VK_NULL_HANDLE, 1,
+                                &pipelineInfo, nullptr, &lightTilingPass.pipeline)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+
+    vkDestroyShaderModule(appContext.baseContext.device, computeShaderModule, nullptr);
+}
+
+void cleanLightTilingPipeline(const VulkanBaseContext& baseContext,
+                              const LightTilingPass&   lightTilingPass) {
+    vkDestroyPipeline(baseContext.device, lightTilingPass.pipeline, nullptr);
+    vkDestroyPipelineLayout(baseContext.device, lightTilingPass.pipelineLayout, nullptr);
+}
+
+/*
+ * Full screen quad in the main render pass that adds the point lights of the
+ * tile of every pixel, replaces the stencil and the point light pipeline.
+ */
+void createTiledLightingPipeline(const ApplicationVulkanContext& appContext,
+                                 RenderContext&                  renderContext) {
+    MainPass&        mainPass        = renderContext.renderPasses.mainPass;
+    LightTilingPass& lightTilingPass = renderContext.renderPasses.lightTilingPass;
+
+    Shader vertexShader;
+    vertexShader.shaderStage      = ShaderStage::VERTEX_SHADER;
+    vertexShader.shaderSourceName = "primaryLighting.vert";
+    vertexShader.sourceDirectory  = "res/shaders/source/";
+    vertexShader.spvDirectory     = "res/shaders/spv/";
+
+    Shader fragmentShader;
+    fragmentShader.shaderStage      = ShaderStage::FRAGMENT_SHADER;
+    fragmentShader.shaderSourceName = "tiledLights.frag";
+    fragmentShader.sourceDirectory  = "res/shaders/source/";
+    fragmentShader.spvDirectory     = "res/shaders/spv/";
+
+    VkShaderModule vertShaderModule =
+        createShaderModule(appContext.baseContext, vertexShader, true);
+    VkShaderModule fragShaderModule =
+        createShaderModule(appContext.baseContext, fragmentShader, true);
+
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage  = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module = vertShaderModule;
+    vertShaderStageInfo.pName  = "main";
+
+    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragShaderStageInfo.stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragShaderStageInfo.module = fragShaderModule;
+    fragShaderStageInfo.pName  = "main";
+
+    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+
+    // same vertex input as the primary lighting pipeline, the quad is
+    // hardcoded in the vertex shader
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    auto bindingDescription = Vertex::getBindingDescription();
+
+    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.vertexAttributeDescriptionCount =
+        static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInputInfo.pVertexBindingDescriptions   = &bindingDescription;
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount  = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable        = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode             = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth               = 1.0f;
+    rasterizer.cullMode                = VK_CULL_MODE_NONE;
+    rasterizer.frontFace               = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable         = VK_FALSE;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable  = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_FALSE;
+    // like the primary lighting the quad has depth 1.0 and skips the skybox
+    depthStencil.depthCompareOp        = VK_COMPARE_OP_GREATER;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable     = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable  = VK_TRUE;
+    multisampling.minSampleShading     = .2f;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // the point lights are added onto the primary lighting
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.colorWriteMask =
+        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+        | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable   = VK_FALSE;
+    colorBlending.logicOp         = VK_LOGIC_OP_COPY;  // Optional
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments    = &colorBlendAttachment;
+
+    std::vector<VkDynamicState>      dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT,
+                                                      VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    // same sets as the light tiling compute shader
+    std::array<VkDescriptorSetLayout, 3> descriptorSetLayouts = {
+        mainPass.transformDescriptorSetLayout, mainPass.gBufferDescriptorSetLayout,
+        lightTilingPass.descriptorSetLayout};
+
+    VkPushConstantRange pushConstantRange =
+        createPushConstantRange(0, sizeof(LightTilePushConstant),
+                                getStageFlag(ShaderStage::FRAGMENT_SHADER));
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts    = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+    if(vkCreatePipelineLayout(appContext.baseContext.device, &pipelineLayoutInfo,
+                              nullptr, &lightTilingPass.shadingPipelineLayout)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType      = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages    = shaderStages;
+
+    pipelineInfo.pVertexInputState   = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState      = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState   = &multisampling;
+    pipelineInfo.pDepthStencilState  = &depthStencil;
+    pipelineInfo.pColorBlendState    = &colorBlending;
+    pipelineInfo.pDynamicState       = &dynamicState;
+
+    pipelineInfo.layout = lightTilingPass.shadingPipelineLayout;
+
+    pipelineInfo.renderPass = mainPass.renderPassContext.renderPass;
+    pipelineInfo.subpass    = 0;
+
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;  // Optional
+    pipelineInfo.basePipelineIndex  = -1;              // Optional
+
+    if(vkCreateGraphicsPipelines(appContext.baseContext.device, VK_NULL_HANDLE, 1,
+                                 &pipelineInfo, nullptr, &lightTilingPass.shadingPipeline)
+       != VK_SUCCESS) {
+        throw std::runtime_error("failed to create graphics pipeline!");
+    }
+
+    vkDestroyShaderModule(appContext.baseContext.device, fragShaderModule, nullptr);
+    vkDestroyShaderModule(appContext.baseContext.device, vertShaderModule, nullptr);
+}
+
+void cleanTiledLightingPipeline(const VulkanBaseContext& baseContext,
+                                const LightTilingPass&   lightTilingPass) {
+    vkDestroyPipeline(baseContext.device, lightTilingPass.shadingPipeline, nullptr);
+    vkDestroyPipelineLayout(baseContext.device, lightTilingPass.shadingPipelineLayout, nullptr);
+}
+
+void cleanLightTilingPass(const VulkanBaseContext& baseContext,
+                          const LightTilingPass&   lightTilingPass) {
+    // buffers of unused frames are VK_NULL_HANDLE, destroying them does nothing
+    for(uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+        vkDestroyBuffer(baseContext.device, lightTilingPass.tileLightBuffers[frame].buffer,
+                        nullptr);
+        vkFreeMemory(baseContext.device, lightTilingPass.tileLightBuffers[frame].bufferMemory,
+                     nullptr);
+    }
+
+    cleanLightTilingPipeline(baseContext, lightTilingPass);
+    cleanTiledLightingPipeline(baseContext, lightTilingPass);
+
+    vkDestroyDescriptorSetLayout(baseContext.device, lightTilingPass.descriptorSetLayout, nullptr);
 }
 
 void createMainPassResources(const ApplicationVulkanContext& appContext,
                              RenderContext&                  renderContext,
                              Scene&                          scene) {
 
-    createBufferResources(appContext, sizeof(CameraUniform),
-                          renderContext.renderPasses.mainPass.transformBuffer);
+    MainPass& mainPass = renderContext.renderPasses.mainPass;
+
+    for(uint32_t frame = 0; frame < appContext.graphicSettings.framesInFlight; frame++) {
+        createBufferResources(appContext, sizeof(CameraUniform), mainPass.transformBuffers[frame]);
+
+        createBufferResources(appContext, sizeof(LightingInformation),
+                              mainPass.lightingBuffers[frame]);
+
+        createBufferResources(appContext, MAX_CASCADES * sizeof(SplitDummyStruct),
+                              mainPass.cascadeSplitsBuffers[frame]);
+
+        mainPass.instanceCapacities[frame] = INITIAL_INSTANCE_CAPACITY;
+        createBufferResources(appContext, INITIAL_INSTANCE_CAPACITY * sizeof(InstanceData),
+                              mainPass.instanceBuffers[frame], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 
-    createBufferResources(appContext, sizeof(LightingInformation),
-                          renderContext.renderPasses.mainPass.lightingBuffer);
+        mainPass.objectCapacities[frame] = INITIAL_OBJECT_CAPACITY;
+        createBufferResources(appContext, INITIAL_OBJECT_CAPACITY * sizeof(ObjectData),
+                              mainPass.objectBuffers[frame], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 
-    createBufferResources(appContext, MAX_CASCADES * sizeof(SplitDummyStruct),
-                          renderContext.renderPasses.mainPass.cascadeSplitsBuffer);
+        mainPass.lightCapacities[frame] = INITIAL_LIGHT_CAPACITY;
+        createBufferResources(appContext, INITIAL_LIGHT_CAPACITY * sizeof(LightData),
+                              mainPass.lightBuffers[frame], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
 
     createMaterialsBuffer(appContext, renderContext, scene);
 }
 
+void updateInstanceDescriptorSets(const ApplicationVulkanContext& appContext,
+                                  RenderContext&                  renderContext,
+                                  uint32_t                        frame) {
+    MainPass&   mainPass   = renderContext.renderPasses.mainPass;
+    ShadowPass& shadowPass = renderContext.renderPasses.shadowPass;
+
+    VkDescriptorBufferInfo instanceBufferInfo{};
+    instanceBufferInfo.buffer = mainPass.instanceBuffers[frame].buffer;
+    instanceBufferInfo.offset = 0;
+    instanceBufferInfo.range  = VK_WHOLE_SIZE;
+
+    std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+    std::array<VkDescriptorSet, 2>      descriptorSets = {mainPass.transformDescriptorSets[frame],
+                                                          shadowPass.transformDescriptorSets[frame]};
+
+    for(size_t i = 0; i < descriptorWrites.size(); i++) {
+        descriptorWrites[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet          = descriptorSets[i];
+        descriptorWrites[i].dstBinding      = SceneBindings::eInstances;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo     = &instanceBufferInfo;
+    }
+
+    vkUpdateDescriptorSets(appContext.baseContext.device,
+                           static_cast<uint32_t>(descriptorWrites.size()),
+                           descriptorWrites.data(), 0, nullptr);
+}
+
+void resizeInstanceBuffer(const ApplicationVulkanContext& appContext,
+                          RenderContext&                  renderContext,
+                          uint32_t                        frame,
+                          uint32_t                        instanceCount) {
+    MainPass&        mainPass       = renderContext.renderPasses.mainPass;
+    BufferResources& instanceBuffer = mainPass.instanceBuffers[frame];
+    uint32_t&        capacity       = mainPass.instanceCapacities[frame];
+    if(instanceCount <= capacity) {
+        return;
+    }
+
+    vkDestroyBuffer(appContext.baseContext.device, instanceBuffer.buffer, nullptr);
+    vkFreeMemory(appContext.baseContext.device, instanceBuffer.bufferMemory, nullptr);
+
+    while(capacity < instanceCount) {
+        capacity *= 2;
+    }
+    createBufferResources(appContext, capacity * sizeof(InstanceData), instanceBuffer,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    updateInstanceDescriptorSets(appContext, renderContext, frame);
+}
+
+void updateObjectDescriptorSets(const ApplicationVulkanContext& appContext,
+                                RenderContext&                  renderContext,
+                                uint32_t                        frame) {
+    MainPass&    mainPass    = renderContext.renderPasses.mainPass;
+    ShadowPass&  shadowPass  = renderContext.renderPasses.shadowPass;
+    CullingPass& cullingPass = renderContext.renderPasses.cullingPass;
+
+    VkDescriptorBufferInfo objectBufferInfo{};
+    objectBufferInfo.buffer = mainPass.objectBuffers[frame].buffer;
+    objectBufferInfo.offset = 0;
+    objectBufferInfo.range  = VK_WHOLE_SIZE;
+
+    std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+    std::array<VkDescriptorSet, 3>      descriptorSets = {mainPass.transformDescriptorSets[frame],
+                                                          shadowPass.transformDescriptorSets[frame],
+                                                          cullingPass.descriptorSets[frame]};
+    std::array<uint32_t, 3>             bindings       = {SceneBindings::eObjects,
+                                                          SceneBindings::eObjects,
+                                                          CullingBindings::eCullObjects};
+
+    for(size_t i = 0; i < descriptorWrites.size(); i++) {
+        descriptorWrites[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet          = descriptorSets[i];
+        descriptorWrites[i].dstBinding      = bindings[i];
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo     = &objectBufferInfo;
+    }
+
+    vkUpdateDescriptorSets(appContext.baseContext.device,
+                           static_cast<uint32_t>(descriptorWrites.size()),
+                           descriptorWrites.data(), 0, nullptr);
+}
+
+void resizeObjectBuffer(const ApplicationVulkanContext& appContext,
+                        RenderContext&                  renderContext,
+                        uint32_t                        frame,
+                        uint32_t                        objectCount) {
+    MainPass&        mainPass     = renderContext.renderPasses.mainPass;
+    BufferResources& objectBuffer = mainPass.objectBuffers[frame];
+    uint32_t&        capacity     = mainPass.objectCapacities[frame];
+    if(objectCount <= capacity) {
+        return;
+    }
+
+    uint32_t oldCapacity = capacity;
+    while(capacity < objectCount) {
+        capacity *= 2;
+    }
+    BufferResources newObjectBuffer;
+    createBufferResources(appContext, capacity * sizeof(ObjectData), newObjectBuffer,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    // the objects that did not change since the frame wrote them are not
+    // written again, so they have to be kept
+    memcpy(newObjectBuffer.bufferMemoryMapping, objectBuffer.bufferMemoryMapping,
+           oldCapacity * sizeof(ObjectData));
+
+    vkDestroyBuffer(appContext.baseContext.device, objectBuffer.buffer, nullptr);
+    vkFreeMemory(appContext.baseContext.device, objectBuffer.bufferMemory, nullptr);
+    objectBuffer = newObjectBuffer;
+
+    updateObjectDescriptorSets(appContext, renderContext, frame);
+}
+
+void updateLightDescriptorSet(const ApplicationVulkanContext& appContext,
+                              RenderContext&                  renderContext,
+                              uint32_t                        frame) {
+    MainPass& mainPass = renderContext.renderPasses.mainPass;
+
+    VkDescriptorBufferInfo lightBufferInfo{};
+    lightBufferInfo.buffer = mainPass.lightBuffers[frame].buffer;
+    lightBufferInfo.offset = 0;
+    lightBufferInfo.range  = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet          = mainPass.transformDescriptorSets[frame];
+    descriptorWrite.dstBinding      = SceneBindings::eLights;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo     = &lightBufferInfo;
+
+    vkUpdateDescriptorSets(appContext.baseContext.device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void resizeLightBuffer(const ApplicationVulkanContext& appContext,
+                       RenderContext&                  renderContext,
+                       uint32_t                        frame,
+                       uint32_t                        lightCount) {
+    MainPass&        mainPass    = renderContext.renderPasses.mainPass;
+    BufferResources& lightBuffer = mainPass.lightBuffers[frame];
+    uint32_t&        capacity    = mainPass.lightCapacities[frame];
+    if(lightCount <= capacity) {
+        return;
+    }
+
+    vkDestroyBuffer(appContext.baseContext.device, lightBuffer.buffer, nullptr);
+    vkFreeMemory(appContext.baseContext.device, lightBuffer.bufferMemory, nullptr);
+
+    while(capacity < lightCount) {
+        capacity *= 2;
+    }
+    createBufferResources(appContext, capacity * sizeof(LightData), lightBuffer,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+    updateLightDescriptorSet(appContext, renderContext, frame);
+}
+
 void createDepthSampler(const ApplicationVulkanContext& appContext, MainPass& mainPass) {
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType     = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
@@ -1258,9 +2139,11 @@ void createMainPassDescriptorSetLayouts(const ApplicationVulkanContext& appConte
     std::vector<VkDescriptorSetLayoutBinding> skyboxBindings;
 
 
+    // the light tiling compute shader reads the camera and the lights
     transformBindings.push_back(createLayoutBinding(
         SceneBindings::eCamera, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-        getStageFlag(ShaderStage::VERTEX_SHADER) | VK_SHADER_STAGE_FRAGMENT_BIT));
+        getStageFlag(ShaderStage::VERTEX_SHADER) | VK_SHADER_STAGE_FRAGMENT_BIT
+            | getStageFlag(ShaderStage::COMPUTE_SHADER)));
 
     transformBindings.push_back(
         createLayoutBinding(SceneBindings::eLight, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
@@ -1270,6 +2153,19 @@ void createMainPassDescriptorSetLayouts(const ApplicationVulkanContext& appConte
         createLayoutBinding(SceneBindings::eLighting, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                             getStageFlag(ShaderStage::FRAGMENT_SHADER)));
 
+    transformBindings.push_back(
+        createLayoutBinding(SceneBindings::eInstances, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                            getStageFlag(ShaderStage::VERTEX_SHADER)));
+
+    transformBindings.push_back(
+        createLayoutBinding(SceneBindings::eObjects, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                            getStageFlag(ShaderStage::VERTEX_SHADER)));
+
+    transformBindings.push_back(createLayoutBinding(
+        SceneBindings::eLights, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        getStageFlag(ShaderStage::VERTEX_SHADER) | getStageFlag(ShaderStage::FRAGMENT_SHADER)
+            | getStageFlag(ShaderStage::COMPUTE_SHADER)));
+
     materialBindings.push_back(createLayoutBinding(
         MaterialsBindings::eMaterials, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
         getStageFlag(ShaderStage::VERTEX_SHADER) | getStageFlag(ShaderStage::FRAGMENT_SHADER)));
@@ -1280,7 +2176,7 @@ void createMainPassDescriptorSetLayouts(const ApplicationVulkanContext& appConte
         getStageFlag(ShaderStage::FRAGMENT_SHADER)));
 
     depthBindings.push_back(
-        createLayoutBinding(DepthBindings::eShadowDepthBuffer, MAX_CASCADES,
+        createLayoutBinding(DepthBindings::eShadowDepthBuffer, 1,
                             VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                             getStageFlag(ShaderStage::FRAGMENT_SHADER)));
 
@@ -1306,9 +2202,11 @@ void createMainPassDescriptorSetLayouts(const ApplicationVulkanContext& appConte
         createLayoutBinding(GBufferBindings::ePBR, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                             getStageFlag(ShaderStage::FRAGMENT_SHADER)));
 
+    // the light tiling compute shader reads the depth too
     gBufferBindings.push_back(
         createLayoutBinding(GBufferBindings::eDepth, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                            getStageFlag(ShaderStage::FRAGMENT_SHADER)));
+                            getStageFlag(ShaderStage::FRAGMENT_SHADER)
+                                | getStageFlag(ShaderStage::COMPUTE_SHADER)));
 
     // stuff for image based lighting and skybox
     skyboxBindings.push_back(
@@ -1374,75 +2272,87 @@ void createMainPassDescriptorSets(const ApplicationVulkanContext& appContext,
                                   RenderContext&                  renderContext,
                                   Scene&                          scene) {
 
-    MainPass& mainPass = renderContext.renderPasses.mainPass;
+    MainPass& mainPass       = renderContext.renderPasses.mainPass;
+    uint32_t  framesInFlight = appContext.graphicSettings.framesInFlight;
+
+    std::vector<VkDescriptorSetLayout> transformLayouts(framesInFlight,
+                                                        mainPass.transformDescriptorSetLayout);
 
     VkDescriptorSetAllocateInfo transformAllocInfo{};
     transformAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     transformAllocInfo.descriptorPool     = renderContext.descriptorPool;
-    transformAllocInfo.descriptorSetCount = 1;
-    transformAllocInfo.pSetLayouts = &mainPass.transformDescriptorSetLayout;
+    transformAllocInfo.descriptorSetCount = framesInFlight;
+    transformAllocInfo.pSetLayouts = transformLayouts.data();
 
     if(vkAllocateDescriptorSets(appContext.baseContext.device, &transformAllocInfo,
-                                &mainPass.transformDescriptorSet)
+                                mainPass.transformDescriptorSets)
        != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 
-    std::vector<VkWriteDescriptorSet> descriptorWrites;
-
+    // the transform set of every frame points to the buffers of that frame
+    for(uint32_t frame = 0; frame < framesInFlight; frame++) {
+        std::array<VkWriteDescriptorSet, 3> frameWrites;
+
+        VkDescriptorBufferInfo transformBufferInfo{};
+        transformBufferInfo.buffer = mainPass.transformBuffers[frame].buffer;
+        transformBufferInfo.offset = 0;
+        transformBufferInfo.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet transformDescriptorWrite;
+        transformDescriptorWrite.sType  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        transformDescriptorWrite.pNext  = nullptr;
+        transformDescriptorWrite.dstSet = mainPass.transformDescriptorSets[frame];
+        transformDescriptorWrite.dstBinding      = SceneBindings::eCamera;
+        transformDescriptorWrite.dstArrayElement = 0;
+        transformDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        transformDescriptorWrite.descriptorCount = 1;
+        transformDescriptorWrite.pBufferInfo     = &transformBufferInfo;
+
+        frameWrites[0] = transformDescriptorWrite;
+
+
+        VkDescriptorBufferInfo lightTransformBufferInfo{};
+        lightTransformBufferInfo.buffer =
+            renderContext.renderPasses.shadowPass.transformBuffers[frame].buffer;
+        lightTransformBufferInfo.offset = 0;
+        lightTransformBufferInfo.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet lightTransformDescriptorWrite;
+        lightTransformDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        lightTransformDescriptorWrite.pNext      = nullptr;
+        lightTransformDescriptorWrite.dstSet     = mainPass.transformDescriptorSets[frame];
+        lightTransformDescriptorWrite.dstBinding = SceneBindings::eLight;
+        lightTransformDescriptorWrite.dstArrayElement = 0;
+        lightTransformDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        lightTransformDescriptorWrite.descriptorCount = 1;
+        lightTransformDescriptorWrite.pBufferInfo     = &lightTransformBufferInfo;
+
+        frameWrites[1] = lightTransformDescriptorWrite;
+
+        VkDescriptorBufferInfo lightingInformationBufferInfo{};
+        lightingInformationBufferInfo.buffer = mainPass.lightingBuffers[frame].buffer;
+        lightingInformationBufferInfo.offset = 0;
+        lightingInformationBufferInfo.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet lightingInformationDescriptorWrite;
+        lightingInformationDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        lightingInformationDescriptorWrite.pNext  = nullptr;
+        lightingInformationDescriptorWrite.dstSet = mainPass.transformDescriptorSets[frame];
+        lightingInformationDescriptorWrite.dstBinding = SceneBindings::eLighting;
+        lightingInformationDescriptorWrite.dstArrayElement = 0;
+        lightingInformationDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        lightingInformationDescriptorWrite.descriptorCount = 1;
+        lightingInformationDescriptorWrite.pBufferInfo = &lightingInformationBufferInfo;
+
+        frameWrites[2] = lightingInformationDescriptorWrite;
+
+        vkUpdateDescriptorSets(appContext.baseContext.device,
+                               static_cast<uint32_t>(frameWrites.size()), frameWrites.data(), 0,
+                               nullptr);
+    }
 
-    VkDescriptorBufferInfo transformBufferInfo{};
-    transformBufferInfo.buffer = mainPass.transformBuffer.buffer;
-    transformBufferInfo.offset = 0;
-    transformBufferInfo.range  = VK_WHOLE_SIZE;
-
-    VkWriteDescriptorSet transformDescriptorWrite;
-    transformDescriptorWrite.sType  = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    transformDescriptorWrite.pNext  = nullptr;
-    transformDescriptorWrite.dstSet = mainPass.transformDescriptorSet;
-    transformDescriptorWrite.dstBinding      = SceneBindings::eCamera;
-    transformDescriptorWrite.dstArrayElement = 0;
-    transformDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    transformDescriptorWrite.descriptorCount = 1;
-    transformDescriptorWrite.pBufferInfo     = &transformBufferInfo;
-
-    descriptorWrites.emplace_back(transformDescriptorWrite);
-
-
-    VkDescriptorBufferInfo lightTransformBufferInfo{};
-    lightTransformBufferInfo.buffer =
-        renderContext.renderPasses.shadowPass.transformBuffer.buffer;
-    lightTransformBufferInfo.offset = 0;
-    lightTransformBufferInfo.range  = VK_WHOLE_SIZE;
-
-    VkWriteDescriptorSet lightTransformDescriptorWrite;
-    lightTransformDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    lightTransformDescriptorWrite.pNext      = nullptr;
-    lightTransformDescriptorWrite.dstSet     = mainPass.transformDescriptorSet;
-    lightTransformDescriptorWrite.dstBinding = SceneBindings::eLight;
-    lightTransformDescriptorWrite.dstArrayElement = 0;
-    lightTransformDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    lightTransformDescriptorWrite.descriptorCount = 1;
-    lightTransformDescriptorWrite.pBufferInfo     = &lightTransformBufferInfo;
-
-    descriptorWrites.emplace_back(lightTransformDescriptorWrite);
-
-    VkDescriptorBufferInfo lightingInformationBufferInfo{};
-    lightingInformationBufferInfo.buffer = mainPass.lightingBuffer.buffer;
-    lightingInformationBufferInfo.offset = 0;
-    lightingInformationBufferInfo.range  = VK_WHOLE_SIZE;
-
-    VkWriteDescriptorSet lightingInformationDescriptorWrite;
-    lightingInformationDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    lightingInformationDescriptorWrite.pNext  = nullptr;
-    lightingInformationDescriptorWrite.dstSet = mainPass.transformDescriptorSet;
-    lightingInformationDescriptorWrite.dstBinding = SceneBindings::eLighting;
-    lightingInformationDescriptorWrite.dstArrayElement = 0;
-    lightingInformationDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    lightingInformationDescriptorWrite.descriptorCount = 1;
-    lightingInformationDescriptorWrite.pBufferInfo = &lightingInformationBufferInfo;
-
-    descriptorWrites.emplace_back(lightingInformationDescriptorWrite);
+    std::vector<VkWriteDescriptorSet> descriptorWrites;
 
 
     VkDescriptorSetAllocateInfo materialAllocInfo{};
@@ -1510,81 +2420,87 @@ void createMainPassDescriptorSets(const ApplicationVulkanContext& appContext,
     // fill content of gBuffer descriptor set
     updateGBufferDescriptor(appContext, renderContext);
 
+    std::vector<VkDescriptorSetLayout> depthLayouts(framesInFlight,
+                                                    mainPass.depthDescriptorSetLayout);
+
     VkDescriptorSetAllocateInfo depthAllocInfo{};
     depthAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     depthAllocInfo.descriptorPool     = renderContext.descriptorPool;
-    depthAllocInfo.descriptorSetCount = 1;
-    depthAllocInfo.pSetLayouts        = &mainPass.depthDescriptorSetLayout;
+    depthAllocInfo.descriptorSetCount = framesInFlight;
+    depthAllocInfo.pSetLayouts        = depthLayouts.data();
 
     auto depthAllocateRes =
         vkAllocateDescriptorSets(appContext.baseContext.device, &depthAllocInfo,
-                                 &mainPass.depthDescriptorSet);
+                                 mainPass.depthDescriptorSets);
 
     if(depthAllocateRes != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 
-    std::array<VkDescriptorImageInfo, MAX_CASCADES> imageInfos{};
-
-    for(size_t i = 0; i < MAX_CASCADES; i++) {
-        VkDescriptorImageInfo imageInfo;
-        imageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-        imageInfo.imageView =
-            renderContext.renderPasses.shadowPass.depthImages[i].imageView;
-        imageInfo.sampler = renderContext.renderPasses.mainPass.depthSampler;
-
-        imageInfos[i] = imageInfo;
+    // the cascades are the layers of one array image
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    imageInfo.imageView   = renderContext.renderPasses.shadowPass.depthImage.imageView;
+    imageInfo.sampler     = renderContext.renderPasses.mainPass.depthSampler;
+
+    // all frames share the shadow maps, the splits and matrices are per frame
+    for(uint32_t frame = 0; frame < framesInFlight; frame++) {
+        std::array<VkWriteDescriptorSet, 3> frameWrites;
+
+        VkWriteDescriptorSet depthDescriptorWrite;
+        depthDescriptorWrite.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        depthDescriptorWrite.pNext      = nullptr;
+        depthDescriptorWrite.dstSet     = mainPass.depthDescriptorSets[frame];
+        depthDescriptorWrite.dstBinding = DepthBindings::eShadowDepthBuffer;
+        depthDescriptorWrite.dstArrayElement = 0;
+        depthDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        depthDescriptorWrite.descriptorCount = 1;
+        depthDescriptorWrite.pImageInfo      = &imageInfo;
+
+        frameWrites[0] = depthDescriptorWrite;
+
+
+        VkDescriptorBufferInfo cascadeSplitBufferInfo{};
+        cascadeSplitBufferInfo.buffer = mainPass.cascadeSplitsBuffers[frame].buffer;
+        cascadeSplitBufferInfo.offset = 0;
+        cascadeSplitBufferInfo.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet depthCascadeSplitsWrite;
+        depthCascadeSplitsWrite.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        depthCascadeSplitsWrite.pNext      = nullptr;
+        depthCascadeSplitsWrite.dstSet     = mainPass.depthDescriptorSets[frame];
+        depthCascadeSplitsWrite.dstBinding = DepthBindings::eCascadeSplits;
+        depthCascadeSplitsWrite.dstArrayElement = 0;
+        depthCascadeSplitsWrite.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        depthCascadeSplitsWrite.descriptorCount = 1;
+        depthCascadeSplitsWrite.pBufferInfo     = &cascadeSplitBufferInfo;
+
+        frameWrites[1] = depthCascadeSplitsWrite;
+
+
+        VkDescriptorBufferInfo inverseLightVPBufferInfo{};
+        inverseLightVPBufferInfo.buffer =
+            renderContext.renderPasses.shadowPass.transformBuffers[frame].buffer;
+        inverseLightVPBufferInfo.offset = 0;
+        inverseLightVPBufferInfo.range  = VK_WHOLE_SIZE;
+
+        VkWriteDescriptorSet inverseLightVPWrite;
+        inverseLightVPWrite.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        inverseLightVPWrite.pNext      = nullptr;
+        inverseLightVPWrite.dstSet     = mainPass.depthDescriptorSets[frame];
+        inverseLightVPWrite.dstBinding = DepthBindings::eLightVPs;
+        inverseLightVPWrite.dstArrayElement = 0;
+        inverseLightVPWrite.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        inverseLightVPWrite.descriptorCount = 1;
+        inverseLightVPWrite.pBufferInfo     = &inverseLightVPBufferInfo;
+
+        frameWrites[2] = inverseLightVPWrite;
+
+        vkUpdateDescriptorSets(appContext.baseContext.device,
+                               static_cast<uint32_t>(frameWrites.size()), frameWrites.data(), 0,
+                               nullptr);
     }
 
-    VkWriteDescriptorSet depthDescriptorWrite;
-    depthDescriptorWrite.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    depthDescriptorWrite.pNext      = nullptr;
-    depthDescriptorWrite.dstSet     = mainPass.depthDescriptorSet;
-    depthDescriptorWrite.dstBinding = DepthBindings::eShadowDepthBuffer;
-    depthDescriptorWrite.dstArrayElement = 0;
-    depthDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    depthDescriptorWrite.descriptorCount = MAX_CASCADES;
-    depthDescriptorWrite.pImageInfo      = imageInfos.data();
-
-    descriptorWrites.emplace_back(depthDescriptorWrite);
-
-
-    VkDescriptorBufferInfo cascadeSplitBufferInfo{};
-    cascadeSplitBufferInfo.buffer = mainPass.cascadeSplitsBuffer.buffer;
-    cascadeSplitBufferInfo.offset = 0;
-    cascadeSplitBufferInfo.range  = VK_WHOLE_SIZE;
-
-    VkWriteDescriptorSet depthCascadeSplitsWrite;
-    depthCascadeSplitsWrite.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    depthCascadeSplitsWrite.pNext      = nullptr;
-    depthCascadeSplitsWrite.dstSet     = mainPass.depthDescriptorSet;
-    depthCascadeSplitsWrite.dstBinding = DepthBindings::eCascadeSplits;
-    depthCascadeSplitsWrite.dstArrayElement = 0;
-    depthCascadeSplitsWrite.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    depthCascadeSplitsWrite.descriptorCount = 1;
-    depthCascadeSplitsWrite.pBufferInfo     = &cascadeSplitBufferInfo;
-
-    descriptorWrites.emplace_back(depthCascadeSplitsWrite);
-
-
-    VkDescriptorBufferInfo inverseLightVPBufferInfo{};
-    inverseLightVPBufferInfo.buffer =
-        renderContext.renderPasses.shadowPass.transformBuffer.buffer;
-    inverseLightVPBufferInfo.offset = 0;
-    inverseLightVPBufferInfo.range  = VK_WHOLE_SIZE;
-
-    VkWriteDescriptorSet inverseLightVPWrite;
-    inverseLightVPWrite.sType      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    inverseLightVPWrite.pNext      = nullptr;
-    inverseLightVPWrite.dstSet     = mainPass.depthDescriptorSet;
-    inverseLightVPWrite.dstBinding = DepthBindings::eLightVPs;
-    inverseLightVPWrite.dstArrayElement = 0;
-    inverseLightVPWrite.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    inverseLightVPWrite.descriptorCount = 1;
-    inverseLightVPWrite.pBufferInfo     = &inverseLightVPBufferInfo;
-
-    descriptorWrites.emplace_back(inverseLightVPWrite);
-
     // Image Based Lighting
     VkDescriptorSetAllocateInfo skyboxAllocInfo{};
     skyboxAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -1728,14 +2644,16 @@ void updateGBufferDescriptor(const ApplicationVulkanContext& appContext,
 void cleanMainPass(const VulkanBaseContext& baseContext, const MainPass& mainPass) {
     vkDestroySampler(baseContext.device, mainPass.depthSampler, nullptr);
 
-    vkDestroyBuffer(baseContext.device, mainPass.transformBuffer.buffer, nullptr);
-    vkFreeMemory(baseContext.device, mainPass.transformBuffer.bufferMemory, nullptr);
-
-    vkDestroyBuffer(baseContext.device, mainPass.lightingBuffer.buffer, nullptr);
-    vkFreeMemory(baseContext.device, mainPass.lightingBuffer.bufferMemory, nullptr);
-
-    vkDestroyBuffer(baseContext.device, mainPass.cascadeSplitsBuffer.buffer, nullptr);
-    vkFreeMemory(baseContext.device, mainPass.cascadeSplitsBuffer.bufferMemory, nullptr);
+    // buffers of unused frames are VK_NULL_HANDLE, destroying them does nothing
+    for(uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+        for(const BufferResources* buffer :
+            {&mainPass.transformBuffers[frame], &mainPass.lightingBuffers[frame],
+             &mainPass.cascadeSplitsBuffers[frame], &mainPass.instanceBuffers[frame],
+             &mainPass.objectBuffers[frame], &mainPass.lightBuffers[frame]}) {
+            vkDestroyBuffer(baseContext.device, buffer->buffer, nullptr);
+            vkFreeMemory(baseContext.device, buffer->bufferMemory, nullptr);
+        }
+    }
 
     vkDestroyBuffer(baseContext.device, mainPass.materialBuffer.buffer, nullptr);
     vkFreeMemory(baseContext.device, mainPass.materialBuffer.bufferMemory, nullptr);
@@ -1793,8 +2711,9 @@ void cleanDeferredFramebuffer(const VulkanBaseContext& baseContext, const MainPa
 
 void createBufferResources(const ApplicationVulkanContext& appContext,
                            VkDeviceSize                    bufferSize,
-                           BufferResources&                bufferResources) {
-    createBuffer(appContext.baseContext, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                           BufferResources&                bufferResources,
+                           VkBufferUsageFlags              usage) {
+    createBuffer(appContext.baseContext, bufferSize, usage,
                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                  bufferResources.buffer, bufferResources.bufferMemory);
 
@@ -2511,8 +3430,9 @@ void createStencilPipeline(const ApplicationVulkanContext& appContext,
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;  // descriptorSetLayouts.size();
-    // pipelineLayoutInfo.pSetLayouts    = //descriptorSetLayouts.data();
+    // the light volumes are fetched from the light buffer
+    pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
+    pipelineLayoutInfo.pSetLayouts    = descriptorSetLayouts.data();
 
     // the used pushconstant will be only the struct "StencilPushConstant"
     VkPushConstantRange pushConstantRange =
@@ -1,6 +1,7 @@
 #ifndef GRAPHICSPRAKTIKUM_RENDERSETUP_H
 #define GRAPHICSPRAKTIKUM_RENDERSETUP_H
 
+#include <array>
 #include "vulkan/ApplicationContext.h"
 #include "RenderContext.h"
 #include "Shader.h"
@@ -29,11 +30,31 @@ void initializeShadowPass(const ApplicationVulkanContext& appContext,
                           const RenderPassDescription& renderPassDescription,
                           Scene& scene);
 
+// the render passes of the shadow maps and the cache, with multiview they
+// only draw the first "cascadeCount" cascades
+void createShadowRenderPasses(const ApplicationVulkanContext& appContext,
+                              ShadowPass&                     shadowPass,
+                              int                             cascadeCount);
+
+// Recreates the render passes, framebuffers and the pipeline of the shadow
+// pass for another number of cascades. The device must be idle.
+void recreateShadowRenderPasses(const ApplicationVulkanContext& appContext,
+                                ShadowPass&                     shadowPass,
+                                int                             cascadeCount);
+
+// render pass with a single depth attachment, all of them are compatible with
+// the shadow pipeline if they have the same view mask
+void createShadowRenderPass(const ApplicationVulkanContext&           appContext,
+                            bool                                      useMultiview,
+                            uint32_t                                  viewMask,
+                            VkImageLayout                             finalLayout,
+                            const std::array<VkSubpassDependency, 2>& dependencies,
+                            VkRenderPass&                             renderPass);
+
 void initializeShadowDepthBuffer(const ApplicationVulkanContext& appContext,
                                  ShadowPass&                     shadowPass,
                                  uint32_t                        width,
-                                 uint32_t                        height,
-                                 uint32_t                        index = 0);
+                                 uint32_t                        height);
 
 void createShadowPassResources(const ApplicationVulkanContext& appContext,
                                RenderContext&                  renderContext);
@@ -48,6 +69,93 @@ void cleanShadowPipeline(const VulkanBaseContext& baseContext, const ShadowPass&
 
 void cleanShadowPass(const VulkanBaseContext& baseContext, const ShadowPass& shadowPass);
 
+// ----- Culling Pass
+
+void initializeCullingPass(const ApplicationVulkanContext& appContext,
+                           RenderContext&                  renderContext);
+
+// instance, command and count buffer of a frame for "instanceCapacity" instances
+void createCullingBuffers(const ApplicationVulkanContext& appContext,
+                          CullingPass&                    cullingPass,
+                          uint32_t                        frame,
+                          uint32_t                        instanceCapacity);
+
+void cleanCullingBuffers(const VulkanBaseContext& baseContext,
+                         const CullingPass&       cullingPass,
+                         uint32_t                 frame);
+
+void updateCullingDescriptorSet(const ApplicationVulkanContext& appContext,
+                                const CullingPass&              cullingPass,
+                                uint32_t                        frame);
+
+// Recreates the culling buffers of a frame with at least "instanceCount"
+// instances if they are smaller. The fence of the frame must have been waited for.
+void resizeCullingBuffers(const ApplicationVulkanContext& appContext,
+                          RenderContext&                  renderContext,
+                          uint32_t                        frame,
+                          uint32_t                        instanceCount);
+
+// points the eLights binding of the main pass set of a frame to the current
+// light buffer of that frame
+void updateLightDescriptorSet(const ApplicationVulkanContext& appContext,
+                              RenderContext&                  renderContext,
+                              uint32_t                        frame);
+
+// Recreates the light buffer of a frame with at least "lightCount" lights if
+// it is smaller. The fence of the frame must have been waited for.
+void resizeLightBuffer(const ApplicationVulkanContext& appContext,
+                       RenderContext&                  renderContext,
+                       uint32_t                        frame,
+                       uint32_t                        lightCount);
+
+void createCullingPipeline(const ApplicationVulkanContext& appContext, CullingPass& cullingPass);
+
+void cleanCullingPipeline(const VulkanBaseContext& baseContext, const CullingPass& cullingPass);
+
+void cleanCullingPass(const VulkanBaseContext& baseContext, const CullingPass& cullingPass);
+
+// ----- Light Tiling Pass
+
+void initializeLightTilingPass(const ApplicationVulkanContext& appContext,
+                               RenderContext&                  renderContext);
+
+// number of screen tiles in each direction for a framebuffer of "extent"
+uint32_t getTileCountX(VkExtent2D extent);
+
+uint32_t getTileCountY(VkExtent2D extent);
+
+// tile light buffer of a frame for "tileCapacity" tiles
+void createTileLightBuffer(const ApplicationVulkanContext& appContext,
+                           LightTilingPass&                lightTilingPass,
+                           uint32_t                        frame,
+                           uint32_t                        tileCapacity);
+
+void updateTileLightDescriptorSet(const ApplicationVulkanContext& appContext,
+                                  const LightTilingPass&          lightTilingPass,
+                                  uint32_t                        frame);
+
+// Recreates the tile light buffer of a frame with at least "tileCount" tiles
+// if it is smaller. The fence of the frame must have been waited for.
+void resizeTileLightBuffer(const ApplicationVulkanContext& appContext,
+                           RenderContext&                  renderContext,
+                           uint32_t                        frame,
+                           uint32_t                        tileCount);
+
+void createLightTilingPipeline(const ApplicationVulkanContext& appContext,
+                               RenderContext&                  renderContext);
+
+void cleanLightTilingPipeline(const VulkanBaseContext& baseContext,
+                              const LightTilingPass&   lightTilingPass);
+
+void createTiledLightingPipeline(const ApplicationVulkanContext& appContext,
+                                 RenderContext&                  renderContext);
+
+void cleanTiledLightingPipeline(const VulkanBaseContext& baseContext,
+                                const LightTilingPass&   lightTilingPass);
+
+void cleanLightTilingPass(const VulkanBaseContext& baseContext,
+                          const LightTilingPass&   lightTilingPass);
+
 // -----
 
 
@@ -93,6 +201,34 @@ void createMaterialsBuffer(const ApplicationVulkanContext& appContext,
                            RenderContext&                  renderContext,
                            Scene&                          scene);
 
+// points the eInstances binding of the main and the shadow pass sets of a
+// frame to the current instance buffer of that frame
+void updateInstanceDescriptorSets(const ApplicationVulkanContext& appContext,
+                                  RenderContext&                  renderContext,
+                                  uint32_t                        frame);
+
+// Recreates the instance buffer of a frame with at least "instanceCount"
+// instances if it is smaller. The fence of the frame must have been waited for.
+void resizeInstanceBuffer(const ApplicationVulkanContext& appContext,
+                          RenderContext&                  renderContext,
+                          uint32_t                        frame,
+                          uint32_t                        instanceCount);
+
+// points the eObjects binding of the main and the shadow pass sets and the
+// eCullObjects binding of the culling set of a frame to the current object
+// buffer of that frame
+void updateObjectDescriptorSets(const ApplicationVulkanContext& appContext,
+                                RenderContext&                  renderContext,
+                                uint32_t                        frame);
+
+// Recreates the object buffer of a frame with at least "objectCount" objects
+// if it is smaller and copies the objects of the old buffer into it. The fence
+// of the frame must have been waited for.
+void resizeObjectBuffer(const ApplicationVulkanContext& appContext,
+                        RenderContext&                  renderContext,
+                        uint32_t                        frame,
+                        uint32_t                        objectCount);
+
 void createMainPassDescriptorSetLayouts(const ApplicationVulkanContext& appContext,
                                         MainPass& mainPass,
                                         Scene&    scene);
@@ -194,9 +330,11 @@ VkPushConstantRange createPushConstantRange(uint32_t offset, uint32_t size, VkSh
 
 void createDescriptorPool(const VulkanBaseContext& baseContext, RenderContext& renderContext);
 
+// creates a host visible buffer that stays mapped
 void createBufferResources(const ApplicationVulkanContext& appContext,
                            VkDeviceSize                    bufferSize,
-                           BufferResources&                bufferResources);
+                           BufferResources&                bufferResources,
+                           VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
 // ---
 
 
@@ -8,6 +8,7 @@ VkShaderStageFlags getStageFlag(ShaderStage stage) {
     switch (stage) {
         case ShaderStage::VERTEX_SHADER: return VK_SHADER_STAGE_VERTEX_BIT;
         case ShaderStage::FRAGMENT_SHADER: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case ShaderStage::COMPUTE_SHADER: return VK_SHADER_STAGE_COMPUTE_BIT;
     }
     return 0;
 }
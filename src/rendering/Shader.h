@@ -7,6 +7,7 @@
 enum class ShaderStage {
     VERTEX_SHADER,
     FRAGMENT_SHADER,
+    COMPUTE_SHADER,
 };
 
 VkShaderStageFlags getStageFlag(ShaderStage stage);
@@ -9,6 +9,7 @@
 #include "glm/glm.hpp"
 using ivec2 = glm::ivec2;
 using vec3 = glm::vec3;
+using vec4 = glm::vec4;
 using mat3 = glm::mat3;
 using mat4 = glm::mat4;
 using uint = unsigned int;
@@ -30,7 +31,10 @@ using uint = unsigned int;
 START_BINDING(SceneBindings)
     eCamera   = 0,  // Global uniform containing camera matrices
     eLight    = 1,  // Global uniform containing camera matrices
-    eLighting = 2
+    eLighting = 2,
+    eInstances = 3, // storage buffer containing the InstanceData of all draws
+    eLights    = 4, // storage buffer containing the LightData of all point lights
+    eObjects   = 5  // storage buffer containing the ObjectData of all entities
 END_BINDING();
 
 START_BINDING(MaterialsBindings)
@@ -51,6 +55,18 @@ START_BINDING(GBufferBindings)
     eDepth = 3
 END_BINDING();
 
+START_BINDING(CullingBindings)
+    eCullingUniform = 0,  // frustum planes of all views
+    eCullInstances  = 1,  // storage buffer containing a CullInstance per InstanceData
+    eDrawCommands   = 2,  // indirect draw commands written by the culling shader
+    eDrawCounts     = 3,  // number of draw commands per view and geometry block
+    eCullObjects    = 4   // storage buffer containing the ObjectData of all entities
+END_BINDING();
+
+START_BINDING(LightTileBindings)
+    eTileLights = 0  // light count and light indices of every screen tile
+END_BINDING();
+
 START_BINDING(SkyboxBindings)
     eSkybox = 0,
     eIrradiance = 1,
@@ -63,6 +79,20 @@ const uint MAX_CASCADES = 4;
 const uint PCF_CONTROL_BIT          = 0x01;
 const uint CASCADE_VIS_CONTROL_BIT  = 0x02;
 
+// the camera and every cascade are culled in one dispatch
+const uint MAX_CULLING_VIEWS = MAX_CASCADES + 1;
+const uint CULLING_WORKGROUP_SIZE = 64;
+
+const uint CULL_SHADOW_CASTER_BIT = 0x01;
+
+// the tiled lighting bins the point lights into screen tiles of
+// LIGHT_TILE_SIZE x LIGHT_TILE_SIZE pixels, one workgroup per tile
+const uint LIGHT_TILE_SIZE = 16;
+// every tile stores its light count followed by at most MAX_LIGHTS_PER_TILE
+// light indices
+const uint MAX_LIGHTS_PER_TILE = 255;
+const uint LIGHT_TILE_STRIDE   = MAX_LIGHTS_PER_TILE + 1;
+
 // clang-format on
 
 // copy of "Material"-struct from "scene/Model.h" for use on GPU
@@ -91,15 +121,72 @@ struct SplitDummyStruct
     ALIGN_AS(16) float splitVal;
 };
 
-struct PushConstant
+// transformation and world bounds of an entity with a model, stored at the
+// index of its handle and only rewritten when the entity changed
+struct ObjectData
 {
-    // transformation matrix of the current instance
+    // transformation matrix of the entity
     ALIGN_AS(16) mat4 transformation;
     // is only needed in the geometry pass to correctly transform normals
     ALIGN_AS(16) mat4 normalsTransformation;
-    ALIGN_AS(16) vec3 worldCamPosition;
-    // index of the material (in the material buffer) for the current MeshPart
+    ALIGN_AS(16) vec4 sphere;     // center and radius
+    ALIGN_AS(16) vec4 boxCenter;
+    ALIGN_AS(16) vec4 boxExtent;
+};
+
+// one instance of a MeshPart, read with gl_InstanceIndex in the geometry and
+// the shadow pass
+struct InstanceData
+{
+    // index of the ObjectData of the entity
+    ALIGN_AS(4) uint objectIndex;
+    // index of the material (in the material buffer) for the MeshPart
     ALIGN_AS(4) int materialIndex;
+    // bit i is set if the instance is drawn into cascade i of the shadow pass
+    ALIGN_AS(4) uint cascadeMask;
+};
+
+// one InstanceData for the culling shader, the bounds are the ones of its
+// ObjectData
+struct CullInstance
+{
+    ALIGN_AS(4) uint objectIndex;
+    // first command of the geometry block in the command range of a view
+    ALIGN_AS(4) uint firstCommand;
+    // index of the geometry block in the count range of a view
+    ALIGN_AS(4) uint batchIndex;
+    ALIGN_AS(4) uint flags;
+    // position of the mesh in the geometry block
+    ALIGN_AS(4) uint indexCount;
+    ALIGN_AS(4) uint firstIndex;
+    ALIGN_AS(4) int vertexOffset;
+};
+
+struct CullingUniform
+{
+    // six planes per view like "Frustum" in "scene/FrustumCulling.h", the
+    // camera is view 0 and cascade i is view i + 1
+    ALIGN_AS(16) vec4 planes[MAX_CULLING_VIEWS * 6];
+    ALIGN_AS(4) uint instanceCount;
+    ALIGN_AS(4) uint viewCount;
+    // size of the command and the count range of each view
+    ALIGN_AS(4) uint commandsPerView;
+    ALIGN_AS(4) uint countsPerView;
+};
+
+// same layout as VkDrawIndexedIndirectCommand
+struct DrawCommand
+{
+    ALIGN_AS(4) uint indexCount;
+    ALIGN_AS(4) uint instanceCount;
+    ALIGN_AS(4) uint firstIndex;
+    ALIGN_AS(4) int vertexOffset;
+    ALIGN_AS(4) uint firstInstance;
+};
+
+struct PushConstant
+{
+    ALIGN_AS(16) vec3 worldCamPosition;
     ALIGN_AS(4) int cascadeCount;
     ALIGN_AS(4) int controlFlags;
     ALIGN_AS(8) ivec2 resolution;
@@ -107,19 +194,31 @@ struct PushConstant
 
 struct StencilPushConstant
 {
-    ALIGN_AS(16) mat4 transformation;
     ALIGN_AS(16) mat4 projView;
 };
 
 // used in the point light pipeline
 struct PointLightPushConstant
 {
-    ALIGN_AS(16) mat4 transformation;
     ALIGN_AS(16) vec3 worldCamPosition;
-    ALIGN_AS(4) float radius;
+    ALIGN_AS(8) ivec2 resolution;
+};
+
+// one point light, the light volumes of the stencil and the point light
+// pipeline are instances of the point light mesh indexed by gl_InstanceIndex
+struct LightData
+{
     ALIGN_AS(16) vec3 position;
+    ALIGN_AS(4) float radius;
     ALIGN_AS(16) vec3 intensity;
+};
+
+// used by the light tiling compute shader and the tiled lighting pipeline
+struct LightTilePushConstant
+{
     ALIGN_AS(8) ivec2 resolution;
+    ALIGN_AS(4) uint lightCount;
+    ALIGN_AS(4) uint tileCountX;
 };
 
 // used in skybox pipeline
@@ -130,9 +229,11 @@ struct SkyboxPushConstant
 
 struct ShadowPushConstant
 {
-    ALIGN_AS(16) mat4 transform;
-    ALIGN_AS(4) int cascadeIndex;
-    ALIGN_AS(4) int materialIndex;
+    // replaces the cascadeMask of all instances if not 0, the indirect draws
+    // of the GPU culling are drawn into one cascade at a time
+    ALIGN_AS(4) uint cascadeMask;
+    // depth offset of every cascade on top of the depth bias of the pipeline
+    ALIGN_AS(4) float cascadeDepthBias[MAX_CASCADES];
 };
 
 struct ShadowControlPushConstant
@@ -0,0 +1,310 @@
+#include "Archetype.h"
+#include <algorithm>
+#include <cstring>
+
+static size_t alignOffset(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+void ArchetypeStorage::removeEntity(EntityId entityId) {
+    uint32_t entityIndex = getEntityIndex(entityId);
+    if(locations.size() <= entityIndex || locations[entityIndex].archetypeIndex == -1) {
+        return;
+    }
+
+    freeRow(locations[entityIndex]);
+    locations[entityIndex] = EntityLocation();
+}
+
+void ArchetypeStorage::removeEntities(const std::vector<EntityId>& entityIds) {
+    // the rows of removed entities are marked with an invalid id
+    std::vector<bool> changedArchetypes(archetypes.size(), false);
+    for(EntityId entityId : entityIds) {
+        uint32_t entityIndex = getEntityIndex(entityId);
+        if(locations.size() <= entityIndex || locations[entityIndex].archetypeIndex == -1) {
+            continue;
+        }
+
+        EntityLocation location = locations[entityIndex];
+        Archetype&     archetype = *archetypes[location.archetypeIndex];
+        archetype.getEntities(archetype.chunks[location.chunkIndex])[location.row] =
+            INVALID_ENTITY_ID;
+        changedArchetypes[location.archetypeIndex] = true;
+        locations[entityIndex]                     = EntityLocation();
+    }
+
+    for(size_t archetypeIndex = 0; archetypeIndex < archetypes.size(); archetypeIndex++) {
+        if(!changedArchetypes[archetypeIndex]) {
+            continue;
+        }
+        Archetype& archetype = *archetypes[archetypeIndex];
+
+        // moves the remaining rows to the front, a row is only ever moved to
+        // a position before it
+        uint32_t keptCount = 0;
+        for(uint32_t chunkIndex = 0; chunkIndex < archetype.chunks.size(); chunkIndex++) {
+            ArchetypeChunk& chunk = archetype.chunks[chunkIndex];
+            for(uint32_t row = 0; row < chunk.count; row++) {
+                EntityId entityId = archetype.getEntities(chunk)[row];
+                if(entityId == INVALID_ENTITY_ID) {
+                    continue;
+                }
+
+                EntityLocation to;
+                to.archetypeIndex = static_cast<int>(archetypeIndex);
+                to.chunkIndex     = keptCount / archetype.chunkCapacity;
+                to.row            = keptCount % archetype.chunkCapacity;
+                keptCount++;
+
+                if(to.chunkIndex == chunkIndex && to.row == row) {
+                    continue;
+                }
+
+                ArchetypeChunk& toChunk = archetype.chunks[to.chunkIndex];
+                for(ComponentTypeId typeId : archetype.componentTypes) {
+                    uint32_t size = componentInfos[typeId].size;
+                    memcpy(archetype.getColumn(toChunk, typeId) + to.row * size,
+                           archetype.getColumn(chunk, typeId) + row * size, size);
+                }
+                archetype.getEntities(toChunk)[to.row] = entityId;
+                locations[getEntityIndex(entityId)]    = to;
+            }
+        }
+
+        // the chunks that are not needed anymore are released
+        size_t usedChunks = (keptCount + archetype.chunkCapacity - 1) / archetype.chunkCapacity;
+        archetype.chunks.erase(archetype.chunks.begin() + usedChunks, archetype.chunks.end());
+        for(size_t chunkIndex = 0; chunkIndex < usedChunks; chunkIndex++) {
+            archetype.chunks[chunkIndex].count =
+                std::min(archetype.chunkCapacity,
+                         keptCount - static_cast<uint32_t>(chunkIndex) * archetype.chunkCapacity);
+        }
+    }
+}
+
+void ArchetypeStorage::removeComponent(EntityId entityId, ComponentTypeId componentTypeId) {
+    uint32_t entityIndex = getEntityIndex(entityId);
+    if(locations.size() <= entityIndex || locations[entityIndex].archetypeIndex == -1) {
+        return;
+    }
+
+    EntityLocation oldLocation = locations[entityIndex];
+
+    ComponentMask newMask = archetypes[oldLocation.archetypeIndex]->componentMask;
+    if(!newMask.test(componentTypeId)) {
+        return;
+    }
+    newMask.reset(componentTypeId);
+
+    if(newMask.none()) {
+        removeEntity(entityId);
+        return;
+    }
+
+    EntityLocation newLocation = allocateRow(getOrCreateArchetype(newMask), entityId);
+    copyRow(oldLocation, newLocation);
+    freeRow(oldLocation);
+
+    locations[entityIndex] = newLocation;
+}
+
+char* ArchetypeStorage::addComponentData(EntityId entityId, ComponentTypeId componentTypeId) {
+    uint32_t entityIndex = getEntityIndex(entityId);
+    if(locations.size() <= entityIndex) {
+        locations.resize(entityIndex + 1);
+    }
+
+    EntityLocation oldLocation = locations[entityIndex];
+
+    ComponentMask newMask;
+    if(oldLocation.archetypeIndex != -1) {
+        newMask = archetypes[oldLocation.archetypeIndex]->componentMask;
+
+        if(newMask.test(componentTypeId)) {
+            return getComponentData(entityId, componentTypeId);
+        }
+    }
+    newMask.set(componentTypeId);
+
+    int            newArchetypeIndex = getOrCreateArchetype(newMask);
+    EntityLocation newLocation       = allocateRow(newArchetypeIndex, entityId);
+
+    if(oldLocation.archetypeIndex != -1) {
+        copyRow(oldLocation, newLocation);
+        freeRow(oldLocation);
+    }
+
+    locations[entityIndex] = newLocation;
+
+    return getComponentData(entityId, componentTypeId);
+}
+
+void ArchetypeStorage::addEntityRows(const EntityId* entityIds, size_t count,
+                                     ComponentMask componentMask, std::vector<EntityLocation>& newLocations) {
+    int        archetypeIndex = getOrCreateArchetype(componentMask);
+    Archetype& archetype      = *archetypes[archetypeIndex];
+
+    uint32_t maxIndex = 0;
+    for(size_t i = 0; i < count; i++) {
+        maxIndex = std::max(maxIndex, getEntityIndex(entityIds[i]));
+    }
+    if(locations.size() <= maxIndex) {
+        locations.resize(maxIndex + 1);
+    }
+
+    size_t freeRows = archetype.chunks.empty()
+                          ? 0
+                          : archetype.chunkCapacity - archetype.chunks.back().count;
+    if(count > freeRows) {
+        size_t newChunks = (count - freeRows + archetype.chunkCapacity - 1) / archetype.chunkCapacity;
+        reserveAdditional(archetype.chunks, newChunks);
+    }
+
+    newLocations.resize(count);
+    for(size_t i = 0; i < count; i++) {
+        newLocations[i]                         = allocateRow(archetypeIndex, entityIds[i]);
+        locations[getEntityIndex(entityIds[i])] = newLocations[i];
+    }
+}
+
+char* ArchetypeStorage::getComponentData(EntityId entityId, ComponentTypeId componentTypeId) {
+    uint32_t entityIndex = getEntityIndex(entityId);
+    if(locations.size() <= entityIndex) {
+        return nullptr;
+    }
+
+    EntityLocation location = locations[entityIndex];
+    if(location.archetypeIndex == -1) {
+        return nullptr;
+    }
+
+    Archetype& archetype = *archetypes[location.archetypeIndex];
+    if(archetype.columnOffsets[componentTypeId] == -1) {
+        return nullptr;
+    }
+
+    return archetype.getColumn(archetype.chunks[location.chunkIndex], componentTypeId)
+           + location.row * archetype.columnStrides[componentTypeId];
+}
+
+int ArchetypeStorage::getOrCreateArchetype(ComponentMask componentMask) {
+    auto archetypeIt = archetypeLookup.find(componentMask);
+    if(archetypeIt != archetypeLookup.end()) {
+        return archetypeIt->second;
+    }
+
+    auto archetype           = std::make_unique<Archetype>();
+    archetype->componentMask = componentMask;
+    archetype->columnOffsets.fill(-1);
+    archetype->columnStrides.fill(0);
+
+    size_t bytesPerEntity = sizeof(EntityId);
+    size_t alignmentSlack = 0;
+    for(ComponentTypeId typeId = 0; typeId < MAX_COMPONENT_TYPES; typeId++) {
+        if(componentMask.test(typeId)) {
+            archetype->componentTypes.push_back(typeId);
+            bytesPerEntity += componentInfos[typeId].size;
+            alignmentSlack += componentInfos[typeId].alignment;
+        }
+    }
+
+    size_t usableChunkSize = ARCHETYPE_CHUNK_SIZE - alignmentSlack;
+    archetype->chunkCapacity =
+        static_cast<uint32_t>(std::max<size_t>(1, usableChunkSize / bytesPerEntity));
+
+    // the entity array is at the start of each chunk, followed by one array
+    // per component type
+    size_t offset = archetype->chunkCapacity * sizeof(EntityId);
+    for(ComponentTypeId typeId : archetype->componentTypes) {
+        offset = alignOffset(offset, componentInfos[typeId].alignment);
+
+        archetype->columnOffsets[typeId] = static_cast<int32_t>(offset);
+        archetype->columnStrides[typeId] = componentInfos[typeId].size;
+
+        offset += archetype->chunkCapacity * componentInfos[typeId].size;
+    }
+    archetype->chunkSize = std::max(ARCHETYPE_CHUNK_SIZE, offset);
+
+    archetypes.push_back(std::move(archetype));
+
+    int archetypeIndex = static_cast<int>(archetypes.size() - 1);
+    archetypeLookup[componentMask] = archetypeIndex;
+
+    return archetypeIndex;
+}
+
+EntityLocation ArchetypeStorage::allocateRow(int archetypeIndex, EntityId entityId) {
+    Archetype& archetype = *archetypes[archetypeIndex];
+
+    if(archetype.chunks.empty() || archetype.chunks.back().count == archetype.chunkCapacity) {
+        size_t elementCount = alignOffset(archetype.chunkSize, sizeof(std::max_align_t))
+                              / sizeof(std::max_align_t);
+
+        // not value initialized, rows are always written before they are read
+        ArchetypeChunk& chunk = archetype.chunks.emplace_back();
+        chunk.data.reset(new std::max_align_t[elementCount]);
+    }
+
+    EntityLocation location;
+    location.archetypeIndex = archetypeIndex;
+    location.chunkIndex     = static_cast<uint32_t>(archetype.chunks.size() - 1);
+
+    ArchetypeChunk& chunk = archetype.chunks.back();
+    location.row          = chunk.count++;
+
+    archetype.getEntities(chunk)[location.row] = entityId;
+
+    return location;
+}
+
+void ArchetypeStorage::copyRow(EntityLocation from, EntityLocation to) {
+    Archetype&      fromArchetype = *archetypes[from.archetypeIndex];
+    Archetype&      toArchetype   = *archetypes[to.archetypeIndex];
+    ArchetypeChunk& fromChunk     = fromArchetype.chunks[from.chunkIndex];
+    ArchetypeChunk& toChunk       = toArchetype.chunks[to.chunkIndex];
+
+    for(ComponentTypeId typeId : toArchetype.componentTypes) {
+        if(fromArchetype.columnOffsets[typeId] == -1) {
+            continue;
+        }
+
+        uint32_t size = componentInfos[typeId].size;
+        memcpy(toArchetype.getColumn(toChunk, typeId) + to.row * size,
+               fromArchetype.getColumn(fromChunk, typeId) + from.row * size, size);
+    }
+}
+
+void ArchetypeStorage::freeRow(EntityLocation location) {
+    Archetype& archetype = *archetypes[location.archetypeIndex];
+
+    // the last row that gets moved into the freed one has to be in the last
+    // chunk, so a kept empty chunk is released now
+    if(archetype.chunks.back().count == 0) {
+        archetype.chunks.pop_back();
+    }
+
+    ArchetypeChunk& chunk     = archetype.chunks[location.chunkIndex];
+    ArchetypeChunk& lastChunk = archetype.chunks.back();
+
+    uint32_t lastRow = lastChunk.count - 1;
+
+    // keep the chunks densely packed by moving the last entity of the last
+    // chunk into the freed row
+    if(&chunk != &lastChunk || location.row != lastRow) {
+        EntityId movedEntity = archetype.getEntities(lastChunk)[lastRow];
+
+        for(ComponentTypeId typeId : archetype.componentTypes) {
+            uint32_t size = componentInfos[typeId].size;
+            memcpy(archetype.getColumn(chunk, typeId) + location.row * size,
+                   archetype.getColumn(lastChunk, typeId) + lastRow * size, size);
+        }
+        archetype.getEntities(chunk)[location.row] = movedEntity;
+
+        locations[getEntityIndex(movedEntity)].chunkIndex = location.chunkIndex;
+        locations[getEntityIndex(movedEntity)].row        = location.row;
+    }
+
+    // an empty last chunk is kept, otherwise an entity that moves back and
+    // forth at a chunk boundary would allocate and free a chunk every time
+    lastChunk.count--;
+}
@@ -0,0 +1,173 @@
+#ifndef GRAPHICSPRAKTIKUM_ARCHETYPE_H
+#define GRAPHICSPRAKTIKUM_ARCHETYPE_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Entity.h"
+#include "Component.h"
+
+// chunks of archetypes with very large components get bigger than this, so
+// that at least one entity fits into every chunk
+inline const size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+
+struct ComponentInfo
+{
+    uint32_t size      = 0;
+    uint32_t alignment = 0;
+};
+
+struct ArchetypeChunk
+{
+    std::unique_ptr<std::max_align_t[]> data;
+    uint32_t                            count = 0;
+
+    char* bytes() { return reinterpret_cast<char*>(data.get()); }
+};
+
+// All entities that have exactly the same set of components. Their components
+// live in fixed size chunks, each chunk holds one array per component type
+// (structure of arrays) and one array with the owning entities. Only the last
+// chunk can be partially filled or empty.
+struct Archetype
+{
+    ComponentMask                componentMask;
+    std::vector<ComponentTypeId> componentTypes;
+
+    // byte offset of the array of each component type inside a chunk, -1 if
+    // the archetype does not contain the component type
+    std::array<int32_t, MAX_COMPONENT_TYPES>  columnOffsets;
+    std::array<uint32_t, MAX_COMPONENT_TYPES> columnStrides;
+
+    uint32_t chunkCapacity;
+    size_t   chunkSize;
+
+    std::vector<ArchetypeChunk> chunks;
+
+    EntityId* getEntities(ArchetypeChunk& chunk) {
+        return reinterpret_cast<EntityId*>(chunk.bytes());
+    }
+
+    char* getColumn(ArchetypeChunk& chunk, ComponentTypeId componentTypeId) {
+        return chunk.bytes() + columnOffsets[componentTypeId];
+    }
+
+    template <typename T>
+    T* getColumn(ArchetypeChunk& chunk) {
+        return reinterpret_cast<T*>(getColumn(chunk, getComponentTypeId<T>()));
+    }
+};
+
+struct EntityLocation
+{
+    int      archetypeIndex = -1;
+    uint32_t chunkIndex     = 0;
+    uint32_t row            = 0;
+};
+
+// Archetype based component storage. Adding a component to an entity moves
+// all of its components into the archetype matching its new component set,
+// so every pointer to a component of that entity becomes invalid.
+class ArchetypeStorage
+{
+  private:
+    std::array<ComponentInfo, MAX_COMPONENT_TYPES> componentInfos;
+
+    // unique_ptr so Archetype references stay valid when new ones are created
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::unordered_map<ComponentMask, int>  archetypeLookup;
+
+    std::vector<EntityLocation> locations;
+
+  public:
+    template <typename T>
+    T* addComponent(EntityId entityId) {
+        // components are moved between archetypes and chunks with memcpy
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "archetype components have to be trivially copyable");
+        static_assert(alignof(T) <= alignof(std::max_align_t));
+
+        ComponentTypeId componentTypeId = getComponentTypeId<T>();
+        componentInfos[componentTypeId] = {sizeof(T), alignof(T)};
+
+        return new(addComponentData(entityId, componentTypeId)) T();
+    }
+
+    // Puts entities that do not have any components yet directly into the
+    // archetype of ComponentTypes instead of moving them through one archetype
+    // per added component, all components are default constructed.
+    template <typename... ComponentTypes>
+    void addEntities(const EntityId* entityIds, size_t count) {
+        static_assert((std::is_trivially_copyable_v<ComponentTypes> && ...),
+                      "archetype components have to be trivially copyable");
+
+        ((componentInfos[getComponentTypeId<ComponentTypes>()] = {sizeof(ComponentTypes),
+                                                                  alignof(ComponentTypes)}),
+         ...);
+
+        std::vector<EntityLocation> newLocations;
+        addEntityRows(entityIds, count, getComponentMask<ComponentTypes...>(), newLocations);
+
+        for(EntityLocation location : newLocations) {
+            Archetype&      archetype = *archetypes[location.archetypeIndex];
+            ArchetypeChunk& chunk     = archetype.chunks[location.chunkIndex];
+
+            (new(archetype.getColumn<ComponentTypes>(chunk) + location.row) ComponentTypes(), ...);
+        }
+    }
+
+    // returns nullptr if the entity does not have a component of type T
+    template <typename T>
+    T* getComponent(EntityId entityId) {
+        return reinterpret_cast<T*>(getComponentData(entityId, getComponentTypeId<T>()));
+    }
+
+    // moves the entity to the archetype without the component type, which
+    // invalidates all pointers to its other components
+    void removeComponent(EntityId entityId, ComponentTypeId componentTypeId);
+
+    void removeEntity(EntityId entityId);
+
+    // removes all entities first and then compacts every archetype that lost
+    // one of them once, instead of moving a row for every removed entity
+    void removeEntities(const std::vector<EntityId>& entityIds);
+
+    // calls fn(Archetype&, ArchetypeChunk&) for every non empty chunk of all
+    // archetypes that contain at least the components in "mask"
+    template <typename Fn>
+    void forEachChunk(ComponentMask mask, Fn&& fn) {
+        for(auto& archetype : archetypes) {
+            if((archetype->componentMask & mask) != mask) {
+                continue;
+            }
+            for(ArchetypeChunk& chunk : archetype->chunks) {
+                if(chunk.count > 0) {
+                    fn(*archetype, chunk);
+                }
+            }
+        }
+    }
+
+  private:
+    char* addComponentData(EntityId entityId, ComponentTypeId componentTypeId);
+
+    char* getComponentData(EntityId entityId, ComponentTypeId componentTypeId);
+
+    void addEntityRows(const EntityId* entityIds, size_t count, ComponentMask componentMask,
+                       std::vector<EntityLocation>& newLocations);
+
+    int getOrCreateArchetype(ComponentMask componentMask);
+
+    EntityLocation allocateRow(int archetypeIndex, EntityId entityId);
+
+    // copies all components that both archetypes contain to the new row
+    void copyRow(EntityLocation from, EntityLocation to);
+
+    void freeRow(EntityLocation location);
+};
+
+#endif  // GRAPHICSPRAKTIKUM_ARCHETYPE_H
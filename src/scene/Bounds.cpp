@@ -0,0 +1,75 @@
+#include "Bounds.h"
+#include <algorithm>
+#include <cmath>
+#include "glm/common.hpp"
+#include "glm/geometric.hpp"
+
+static const glm::vec3& getPosition(const glm::vec3* positions, size_t index, size_t stride) {
+    auto* bytes = reinterpret_cast<const unsigned char*>(positions);
+    return *reinterpret_cast<const glm::vec3*>(bytes + index * stride);
+}
+
+Bounds calculateBounds(const glm::vec3* positions, size_t count, size_t stride) {
+    Bounds bounds;
+    if(count == 0) {
+        return bounds;
+    }
+
+    bounds.min = getPosition(positions, 0, stride);
+    bounds.max = bounds.min;
+    for(size_t i = 1; i < count; i++) {
+        const glm::vec3& position = getPosition(positions, i, stride);
+
+        bounds.min = glm::min(bounds.min, position);
+        bounds.max = glm::max(bounds.max, position);
+    }
+
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+
+    // the distance to the farthest position is at most the half diagonal of
+    // the box, but usually quite a bit smaller
+    float radiusSquared = 0;
+    for(size_t i = 0; i < count; i++) {
+        glm::vec3 offset = getPosition(positions, i, stride) - bounds.center;
+        radiusSquared    = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    bounds.radius = std::sqrt(radiusSquared);
+
+    return bounds;
+}
+
+Bounds mergeBounds(const Bounds& a, const Bounds& b) {
+    Bounds merged;
+    merged.min    = glm::min(a.min, b.min);
+    merged.max    = glm::max(a.max, b.max);
+    merged.center = (merged.min + merged.max) * 0.5f;
+    merged.radius = std::max(glm::length(a.center - merged.center) + a.radius,
+                             glm::length(b.center - merged.center) + b.radius);
+    return merged;
+}
+
+Bounds transformBounds(const Bounds& bounds, const glm::mat4& transformation) {
+    Bounds transformed;
+
+    // the extent along a world axis is the sum of the projected extents of
+    // all three local axes (Arvo, "Transforming Axis-Aligned Bounding Boxes")
+    glm::vec3 boxCenter  = (bounds.min + bounds.max) * 0.5f;
+    glm::vec3 boxExtents = (bounds.max - bounds.min) * 0.5f;
+
+    glm::vec3 center  = glm::vec3(transformation * glm::vec4(boxCenter, 1));
+    glm::vec3 extents = glm::abs(glm::vec3(transformation[0])) * boxExtents.x
+                        + glm::abs(glm::vec3(transformation[1])) * boxExtents.y
+                        + glm::abs(glm::vec3(transformation[2])) * boxExtents.z;
+
+    transformed.min = center - extents;
+    transformed.max = center + extents;
+
+    float maxScaling = std::max({glm::length(glm::vec3(transformation[0])),
+                                 glm::length(glm::vec3(transformation[1])),
+                                 glm::length(glm::vec3(transformation[2]))});
+
+    transformed.center = glm::vec3(transformation * glm::vec4(bounds.center, 1));
+    transformed.radius = bounds.radius * maxScaling;
+
+    return transformed;
+}
@@ -0,0 +1,41 @@
+#ifndef GRAPHICSPRAKTIKUM_BOUNDS_H
+#define GRAPHICSPRAKTIKUM_BOUNDS_H
+
+#include <cstddef>
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+
+// Axis aligned bounding box and bounding sphere of some geometry. Both are
+// kept, because the box fits walls and floors of the level much better, while
+// the sphere stays tight for rotated objects.
+struct Bounds
+{
+    glm::vec3 min{0};
+    glm::vec3 max{0};
+
+    glm::vec3 center{0};
+    float     radius = 0;
+};
+
+// bounds of the model of an entity and the same bounds in world space, the
+// world bounds are updated by EntityRegistry::updateTransformations()
+struct BoundsComponent
+{
+    Bounds local;
+    Bounds world;
+};
+
+// Box around all positions, the sphere is centered in the box and as small as
+// possible for that center. The positions are read "stride" bytes apart, so
+// they can be taken directly out of an array of vertices.
+Bounds calculateBounds(const glm::vec3* positions, size_t count, size_t stride = sizeof(glm::vec3));
+
+// smallest box around both boxes and a sphere around both spheres
+Bounds mergeBounds(const Bounds& a, const Bounds& b);
+
+// Box around the transformed box (not around the transformed geometry, so it
+// gets larger for rotated objects) and the transformed sphere, which is scaled
+// by the largest scaling of the transformation.
+Bounds transformBounds(const Bounds& bounds, const glm::mat4& transformation);
+
+#endif  // GRAPHICSPRAKTIKUM_BOUNDS_H
@@ -1,3 +0,0 @@
-#include "Component.h"
-
-int s_componentCounter = 0;
\ No newline at end of file
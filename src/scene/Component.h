@@ -2,146 +2,151 @@
 #define GRAPHICSPRAKTIKUM_COMPONENT_H
 
 #include <vector>
+#include <algorithm>
 #include <cstdint>
-#include <set>
-#include <cstring>
-#include <stdexcept>
+#include <utility>
 #include "Entity.h"
-#include "vulkan/ApplicationContext.h"
+#include "ComponentRegistry.h"
 
 
-typedef int ComponentTypeId;
-typedef int ComponentId;
-
-extern int s_componentCounter;
+// Reserves space for "count" more elements. Reserving exactly size + count
+// would reallocate on every bulk insert, so this grows geometrically like
+// push_back does.
+template <typename T>
+void reserveAdditional(std::vector<T>& vector, size_t count) {
+    size_t size = vector.size() + count;
+    if(size > vector.capacity()) {
+        vector.reserve(std::max(size, 2 * vector.capacity()));
+    }
+}
 
-template <class T>
-int getComponentTypeId()
+// type erased interface, so the Scene can remove all components of an entity
+// without knowing their types
+struct ComponentPoolBase
 {
-    // can only have MAX_COMPONENT_TYPES different types of components
-    // can change that constant in Entity.h if needed
-    assert(s_componentCounter < MAX_COMPONENT_TYPES - 1);
-    static int s_componentId = s_componentCounter++;
-    return s_componentId;
-}
+    virtual ~ComponentPoolBase() = default;
 
-struct ComponentPool {
-    std::vector<ComponentId> entityMapping;
+    virtual bool hasComponent(EntityId entityId) const = 0;
 
-    char *data;
-    std::set<ComponentId> freeComponents;
+    virtual void removeComponent(EntityId entityId) = 0;
 
-    uint32_t componentSize;
-    size_t currentSize;
+    // removes the components of all entities that have one and compacts the
+    // pool once instead of once per entity
+    virtual void removeComponents(const std::vector<EntityId>& entityIds) = 0;
+};
 
-    ComponentPool() {
-        componentSize = 1;
-        currentSize = 0;
-        data = nullptr;
-    };
+// Sparse set of components of type T. The components and their owning
+// entities are stored densely packed, "sparse" maps the index of an EntityId
+// to the index of its component in the dense arrays (-1 if the entity has none).
+template <typename T>
+struct ComponentPool : ComponentPoolBase
+{
+    std::vector<T>        components;
+    std::vector<EntityId> entities;
+    std::vector<int>      sparse;
 
-    explicit ComponentPool(uint32_t componentSize, size_t initialSize = 16)
-        : componentSize(componentSize)
-    {
-        data = new char[initialSize * componentSize];
-        currentSize = initialSize;
-        for (int i = 0; i < initialSize; i++) {
-            freeComponents.insert(i);
-        }
+    explicit ComponentPool(size_t initialSize = 16) {
+        components.reserve(initialSize);
+        entities.reserve(initialSize);
     }
 
-    /*
-    ComponentPool(ComponentPool &&other) noexcept {
-        componentSize = other.componentSize;
-        currentSize = other.currentSize;
-
-        data = other.data;
-        other.data = nullptr;
-
-        freeComponents = std::move(other.freeComponents);
-        entityMapping = std::move(other.entityMapping);
+    // reserves space for "count" more components, used when many entities
+    // get created at once
+    void reserve(size_t count) {
+        reserveAdditional(components, count);
+        reserveAdditional(entities, count);
     }
 
-    ComponentPool &operator= (ComponentPool &&other) noexcept {
-        if (this == &other) return *this;
-
-        delete []data;
+    // the returned pointer is only valid until the next component of this type
+    // gets added or removed
+    T* addComponent(EntityId entityId) {
+        uint32_t entityIndex = getEntityIndex(entityId);
 
-        componentSize = other.componentSize;
-        currentSize = other.currentSize;
-
-        data = other.data;
-        other.data = nullptr;
+        if(hasComponent(entityId)) {
+            T* component = &components[sparse[entityIndex]];
+            *component   = T();
+            return component;
+        }
 
-        freeComponents = std::move(other.freeComponents);
-        entityMapping = std::move(other.entityMapping);
+        if(sparse.size() <= entityIndex) {
+            sparse.resize(entityIndex + 1, -1);
+        }
+        sparse[entityIndex] = static_cast<int>(components.size());
 
-        return *this;
-    }
-    */
+        components.emplace_back();
+        entities.push_back(entityId);
 
-    void clean() {
-        delete []data;
+        return &components.back();
     }
 
-    ComponentId getNewComponentId() {
-        if (freeComponents.empty()) {
-            char *newData = new char[componentSize * currentSize * 2];
-            memcpy(newData, data, currentSize * componentSize);
-
-            delete []data;
-            data = newData;
-            for (int i = static_cast<ComponentId>(currentSize); i < currentSize * 2; i++) {
-                freeComponents.insert(static_cast<ComponentId>(i));
-            }
-            currentSize *= 2;
+    // swap-and-pop, moves the last component into the freed slot
+    void removeComponent(EntityId entityId) override {
+        if(!hasComponent(entityId)) {
+            return;
         }
 
-        auto freeComponent = freeComponents.begin();
-        ComponentId id = *freeComponent;
+        uint32_t entityIndex = getEntityIndex(entityId);
+        int      index       = sparse[entityIndex];
+        EntityId lastEntity  = entities.back();
 
-        freeComponents.erase(freeComponent);
-        return id;
-    }
-
-    bool freeComponent(ComponentId id) {
-        if (currentSize <= id) return false;
-
-        memset(data + id * componentSize, 0, componentSize);
-        // clean component here ?
+        if(getEntityIndex(lastEntity) != entityIndex) {
+            components[index]                  = std::move(components.back());
+            entities[index]                    = lastEntity;
+            sparse[getEntityIndex(lastEntity)] = index;
+        }
 
-        freeComponents.insert(id);
+        components.pop_back();
+        entities.pop_back();
+        sparse[entityIndex] = -1;
     }
 
-    bool mapComponent(EntityId entityId, ComponentId componentId) {
-        if (currentSize <= componentId) return false;
+    // marks the removed components first and then moves the remaining ones
+    // to the front in one pass, which keeps their order
+    void removeComponents(const std::vector<EntityId>& entityIds) override {
+        size_t removedCount = 0;
+        for(EntityId entityId : entityIds) {
+            if(hasComponent(entityId)) {
+                sparse[getEntityIndex(entityId)] = -1;
+                removedCount++;
+            }
+        }
+        if(removedCount == 0) {
+            return;
+        }
 
-        if (entityMapping.size() <= entityId) entityMapping.resize(entityId + 1, -1);
-        entityMapping[entityId] = componentId;
+        size_t keptCount = 0;
+        for(size_t index = 0; index < entities.size(); index++) {
+            uint32_t entityIndex = getEntityIndex(entities[index]);
+            if(sparse[entityIndex] == -1) {
+                continue;
+            }
+            if(keptCount != index) {
+                components[keptCount] = std::move(components[index]);
+                entities[keptCount]   = entities[index];
+                sparse[entityIndex]   = static_cast<int>(keptCount);
+            }
+            keptCount++;
+        }
 
-        return true;
+        components.erase(components.begin() + keptCount, components.end());
+        entities.erase(entities.begin() + keptCount, entities.end());
     }
 
-    bool removeMapping(EntityId entityId) {
-        if (entityMapping.size() <= entityId) return false;
-
-        entityMapping[entityId] = -1;
+    // only looks at the index of the handle, the Scene validates generations
+    bool hasComponent(EntityId entityId) const override {
+        uint32_t entityIndex = getEntityIndex(entityId);
+        return entityIndex < sparse.size() && sparse[entityIndex] != -1;
     }
 
-    bool hasComponent(EntityId entityId) {
-        return entityMapping.size() > entityId && entityMapping[entityId] != -1;
+    // returns nullptr if the entity does not have a component of this type
+    T* getComponent(EntityId entityId) {
+        if(!hasComponent(entityId)) {
+            return nullptr;
+        }
+        return &components[sparse[getEntityIndex(entityId)]];
     }
 
-    char *getComponent(EntityId entityId) {
-        if (entityMapping.size() <= entityId) throw std::runtime_error("Entity Id not found");
-
-        int index = entityMapping[entityId];
-        if (index == -1) throw std::runtime_error("Entity does not have a component of this type");
-
-        if (currentSize <= index) throw std::runtime_error("invalid mapping encountered");
-
-        return data + index * componentSize;
-    }
+    size_t size() const { return components.size(); }
 };
 
-#endif //GRAPHICSPRAKTIKUM_COMPONENT_H
\ No newline at end of file
+#endif //GRAPHICSPRAKTIKUM_COMPONENT_H
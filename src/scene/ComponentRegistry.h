@@ -0,0 +1,66 @@
+#ifndef GRAPHICSPRAKTIKUM_COMPONENTREGISTRY_H
+#define GRAPHICSPRAKTIKUM_COMPONENTREGISTRY_H
+
+#include <type_traits>
+#include "Entity.h"
+
+typedef int ComponentTypeId;
+
+// forward declarations of all component types, so this list does not pull in
+// their (Vulkan, box2d, ...) dependencies
+struct ModelComponent;
+struct transformation_s;
+typedef struct transformation_s Transformation;
+struct PhysicsComponent;
+struct PlayerComponent;
+struct BoundsComponent;
+
+template <typename... ComponentTypes>
+struct ComponentList
+{
+    static constexpr size_t size = sizeof...(ComponentTypes);
+};
+
+// The position of a type in this list is its ComponentTypeId, so the ids are
+// known at compile time and the same in every run. New component types have
+// to be appended at the end to keep existing ids stable.
+using SceneComponents =
+    ComponentList<ModelComponent, Transformation, PhysicsComponent, PlayerComponent, BoundsComponent>;
+
+static_assert(SceneComponents::size <= MAX_COMPONENT_TYPES,
+              "increase MAX_COMPONENT_TYPES in Entity.h");
+
+template <typename T, typename List>
+struct ComponentIndex;
+
+template <typename T>
+struct ComponentIndex<T, ComponentList<>>
+{
+    static_assert(!std::is_same_v<T, T>, "component type is not registered in SceneComponents");
+    static constexpr ComponentTypeId value = -1;
+};
+
+template <typename T, typename... Rest>
+struct ComponentIndex<T, ComponentList<T, Rest...>>
+{
+    static constexpr ComponentTypeId value = 0;
+};
+
+template <typename T, typename First, typename... Rest>
+struct ComponentIndex<T, ComponentList<First, Rest...>>
+{
+    static constexpr ComponentTypeId value =
+        1 + ComponentIndex<T, ComponentList<Rest...>>::value;
+};
+
+template <class T>
+constexpr ComponentTypeId getComponentTypeId() {
+    return ComponentIndex<T, SceneComponents>::value;
+}
+
+template <typename... ComponentTypes>
+constexpr ComponentMask getComponentMask() {
+    return ComponentMask(((1ull << getComponentTypeId<ComponentTypes>()) | ... | 0ull));
+}
+
+#endif  // GRAPHICSPRAKTIKUM_COMPONENTREGISTRY_H
@@ -6,7 +6,26 @@
 
 
 inline const int MAX_COMPONENT_TYPES = 32;
-typedef int EntityId;
+
+// Generational entity handle. The lower 32 bits are the index of the entity
+// slot, which the component storages use, the upper 32 bits are the generation
+// of the slot. Removing an entity increments the generation of its slot, so an
+// old handle never refers to an entity that reuses the slot.
+typedef uint64_t EntityId;
+
+inline const EntityId INVALID_ENTITY_ID = UINT64_MAX;
+
+constexpr EntityId makeEntityId(uint32_t index, uint32_t generation) {
+    return static_cast<EntityId>(generation) << 32 | index;
+}
+
+constexpr uint32_t getEntityIndex(EntityId id) {
+    return static_cast<uint32_t>(id);
+}
+
+constexpr uint32_t getEntityGeneration(EntityId id) {
+    return static_cast<uint32_t>(id >> 32);
+}
 
 typedef std::bitset<MAX_COMPONENT_TYPES> ComponentMask;
 
@@ -15,10 +34,18 @@ typedef std::bitset<MAX_COMPONENT_TYPES> ComponentMask;
 struct Entity {
     bool active {true};
     ComponentMask componentMask {ComponentMask ()};
+    // generation of the handle of the entity currently using this slot
+    uint32_t generation {0};
 };
 
-inline bool entityValid(Entity &entity, bool allComponents, ComponentMask mask) {
-    return entity.active && (allComponents | mask == (mask & entity.componentMask));
-}
+// With ECS_VALIDATION (always on in debug builds, see CMakeLists.txt) the
+// Scene checks every handle it gets and throws for handles of removed
+// entities. Otherwise the checks are compiled out and a stale handle accesses
+// whatever entity uses its slot now.
+#ifdef ECS_VALIDATION
+#define ECS_VALIDATE_ENTITY(scene, id) (scene).validateEntity(id)
+#else
+#define ECS_VALIDATE_ENTITY(scene, id) ((void)0)
+#endif
 
 #endif //GRAPHICSPRAKTIKUM_ENTITY_H
@@ -0,0 +1,64 @@
+#include "EntityCommandBuffer.h"
+#include "EntityRegistry.h"
+
+EntityId EntityCommandBuffer::createEntity() {
+    std::lock_guard<std::mutex> lock(commandsMutex);
+
+    EntityId pendingId = makeEntityId(pendingEntityCount++, PENDING_GENERATION);
+    commands.push_back({CommandType::CreateEntity, pendingId, nullptr});
+
+    return pendingId;
+}
+
+void EntityCommandBuffer::destroyEntity(EntityId entityId) {
+    record({CommandType::DestroyEntity, entityId, nullptr});
+}
+
+bool EntityCommandBuffer::empty() {
+    std::lock_guard<std::mutex> lock(commandsMutex);
+    return commands.empty();
+}
+
+void EntityCommandBuffer::playback(EntityRegistry& registry) {
+    std::vector<Command> recordedCommands;
+    uint32_t             recordedEntityCount;
+    {
+        std::lock_guard<std::mutex> lock(commandsMutex);
+        std::swap(recordedCommands, commands);
+        recordedEntityCount = pendingEntityCount;
+        pendingEntityCount  = 0;
+    }
+
+    // real ids of the entities created by this playback, by pending index
+    std::vector<EntityId> createdEntities(recordedEntityCount, INVALID_ENTITY_ID);
+
+    for(Command& command : recordedCommands) {
+        bool pending = getEntityGeneration(command.entityId) == PENDING_GENERATION;
+
+        if(command.type == CommandType::CreateEntity) {
+            createdEntities[getEntityIndex(command.entityId)] = registry.addEntity();
+            continue;
+        }
+
+        EntityId entityId = command.entityId;
+        if(pending) {
+            entityId = createdEntities[getEntityIndex(entityId)];
+        }
+
+        // skips commands for entities that were removed in the meantime
+        if(!registry.isEntityValid(entityId)) {
+            continue;
+        }
+
+        if(command.type == CommandType::DestroyEntity) {
+            registry.removeEntity(entityId);
+        } else {
+            command.apply(registry, entityId);
+        }
+    }
+}
+
+void EntityCommandBuffer::record(Command command) {
+    std::lock_guard<std::mutex> lock(commandsMutex);
+    commands.push_back(std::move(command));
+}
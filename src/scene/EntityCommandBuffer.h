@@ -0,0 +1,85 @@
+#ifndef GRAPHICSPRAKTIKUM_ENTITYCOMMANDBUFFER_H
+#define GRAPHICSPRAKTIKUM_ENTITYCOMMANDBUFFER_H
+
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Entity.h"
+#include "ComponentRegistry.h"
+
+class EntityRegistry;
+
+// Records structural changes (creating and destroying entities, adding and
+// removing components) while systems run, so that component pointers and
+// query lists stay valid until the changes are played back at a sync point.
+// Recording is thread safe, playback is not.
+class EntityCommandBuffer
+{
+  private:
+    enum class CommandType
+    {
+        CreateEntity,
+        DestroyEntity,
+        AddComponent,
+        RemoveComponent
+    };
+
+    struct Command
+    {
+        CommandType type;
+        // ids with PENDING_GENERATION refer to entities created by this
+        // command buffer, their index counts the created entities
+        EntityId entityId;
+        // adds or removes the component for AddComponent and RemoveComponent
+        std::function<void(EntityRegistry&, EntityId)> apply;
+    };
+
+    static const uint32_t PENDING_GENERATION = UINT32_MAX;
+
+    std::vector<Command> commands;
+    uint32_t             pendingEntityCount = 0;
+    std::mutex           commandsMutex;
+
+  public:
+    // Returns a placeholder id that can only be passed to other commands of
+    // this command buffer, the real entity is created during playback.
+    EntityId createEntity();
+
+    void destroyEntity(EntityId entityId);
+
+    template <typename T>
+    void addComponent(EntityId entityId, T component = T()) {
+        // generic lambda, so EntityRegistry only has to be complete where this is used
+        auto apply = [component = std::move(component)](auto& registry, EntityId id) mutable {
+            auto* added = registry.template assign<T>(id);
+            *added      = std::move(component);
+
+            // new matrices are calculated by the next updateTransformations()
+            if constexpr(std::is_same_v<T, Transformation>) {
+                added->hasChanged = false;
+                registry.markTransformationChanged(id, *added);
+            }
+        };
+        record({CommandType::AddComponent, entityId, std::move(apply)});
+    }
+
+    template <typename T>
+    void removeComponent(EntityId entityId) {
+        auto apply = [](auto& registry, EntityId id) { registry.template removeComponent<T>(id); };
+        record({CommandType::RemoveComponent, entityId, std::move(apply)});
+    }
+
+    bool empty();
+
+    // Applies all recorded commands in the order they were recorded and clears
+    // the command buffer. Commands for entities that were destroyed in the
+    // meantime are skipped. Must not run at the same time as any system.
+    void playback(EntityRegistry& registry);
+
+  private:
+    void record(Command command);
+};
+
+#endif  // GRAPHICSPRAKTIKUM_ENTITYCOMMANDBUFFER_H
@@ -0,0 +1,134 @@
+#ifndef GRAPHICSPRAKTIKUM_ENTITYQUERY_H
+#define GRAPHICSPRAKTIKUM_ENTITYQUERY_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include "Entity.h"
+
+// Dense list of all active entities whose component mask contains
+// "componentMask". An empty mask matches every active entity.
+struct EntityQuery
+{
+    ComponentMask         componentMask;
+    std::vector<EntityId> entities;
+
+    // position of an entity inside "entities" by the index of its handle, -1
+    // if it does not match
+    std::vector<int> indices;
+
+    bool matches(const Entity& entity) const {
+        return entity.active
+               && (entity.componentMask & componentMask) == componentMask;
+    }
+
+    bool contains(EntityId id) const {
+        uint32_t entityIndex = getEntityIndex(id);
+        return entityIndex < indices.size() && indices[entityIndex] != -1;
+    }
+
+    void insert(EntityId id) {
+        uint32_t entityIndex = getEntityIndex(id);
+        if(indices.size() <= entityIndex) {
+            indices.resize(entityIndex + 1, -1);
+        }
+        indices[entityIndex] = static_cast<int>(entities.size());
+        entities.push_back(id);
+    }
+
+    // swap-and-pop, this does not keep the order of the remaining entities
+    void erase(EntityId id) {
+        int      index = indices[getEntityIndex(id)];
+        EntityId last  = entities.back();
+
+        entities[index]               = last;
+        indices[getEntityIndex(last)] = index;
+
+        entities.pop_back();
+        indices[getEntityIndex(id)] = -1;
+    }
+
+    // erases all of the entities that are contained in one pass over the
+    // list, the remaining entities keep their order
+    void erase(const std::vector<EntityId>& ids) {
+        size_t erasedCount = 0;
+        for(EntityId id : ids) {
+            if(contains(id)) {
+                indices[getEntityIndex(id)] = -1;
+                erasedCount++;
+            }
+        }
+        if(erasedCount == 0) {
+            return;
+        }
+
+        size_t keptCount = 0;
+        for(size_t index = 0; index < entities.size(); index++) {
+            uint32_t entityIndex = getEntityIndex(entities[index]);
+            if(indices[entityIndex] == -1) {
+                continue;
+            }
+            entities[keptCount]  = entities[index];
+            indices[entityIndex] = static_cast<int>(keptCount);
+            keptCount++;
+        }
+        entities.resize(keptCount);
+    }
+};
+
+// Keeps one EntityQuery per requested ComponentMask and updates all of them
+// incrementally whenever an entity gets created, removed or changes its
+// components, so views never have to scan the whole entity list.
+class QueryCache
+{
+  private:
+    // deque so references to queries stay valid when new ones are added
+    std::deque<EntityQuery> queries;
+
+    // systems running in parallel can create views at the same time
+    std::mutex queriesMutex;
+
+  public:
+    // the query gets built from "entities" the first time a mask is requested
+    const EntityQuery& getQuery(ComponentMask mask, const std::vector<Entity>& entities) {
+        std::lock_guard<std::mutex> lock(queriesMutex);
+
+        for(EntityQuery& query : queries) {
+            if(query.componentMask == mask) {
+                return query;
+            }
+        }
+
+        EntityQuery& query = queries.emplace_back();
+        query.componentMask = mask;
+        for(uint32_t index = 0; index < entities.size(); index++) {
+            if(query.matches(entities[index])) {
+                query.insert(makeEntityId(index, entities[index].generation));
+            }
+        }
+        return query;
+    }
+
+    // has to be called after the mask or active state of an entity changed
+    void entityChanged(EntityId id, const Entity& entity) {
+        for(EntityQuery& query : queries) {
+            bool matches  = query.matches(entity);
+            bool contains = query.contains(id);
+
+            if(matches && !contains) {
+                query.insert(id);
+            } else if(!matches && contains) {
+                query.erase(id);
+            }
+        }
+    }
+
+    // has to be called after all of the entities were deactivated
+    void entitiesRemoved(const std::vector<EntityId>& ids) {
+        for(EntityQuery& query : queries) {
+            query.erase(ids);
+        }
+    }
+};
+
+#endif  // GRAPHICSPRAKTIKUM_ENTITYQUERY_H
@@ -0,0 +1,196 @@
+#include "EntityRegistry.h"
+#include "Bounds.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+EntityRegistry::EntityRegistry(StorageMode storageMode)
+    : storageMode(storageMode) {}
+
+void EntityRegistry::cleanupComponents() {
+    for(auto& pool : componentPools) {
+        pool.reset();
+    }
+}
+
+EntityId EntityRegistry::addEntity() {
+    if(freeEntities.empty()) {
+        entities.emplace_back();
+        auto id = makeEntityId(static_cast<uint32_t>(entities.size() - 1), 0);
+        queryCache.entityChanged(id, entities.back());
+        return id;
+    }
+    uint32_t index = freeEntities.back();
+    freeEntities.pop_back();
+
+    Entity& entity       = entities[index];
+    entity.active        = true;
+    entity.componentMask = ComponentMask();
+
+    EntityId id = makeEntityId(index, entity.generation);
+    queryCache.entityChanged(id, entity);
+    return id;
+}
+
+bool EntityRegistry::removeEntity(EntityId id) {
+    if(!isEntityValid(id)) {
+        return false;
+    }
+
+    Entity& entity = entities[getEntityIndex(id)];
+
+    for(ComponentTypeId componentTypeId = 0; componentTypeId < MAX_COMPONENT_TYPES;
+        componentTypeId++) {
+        if(componentPools[componentTypeId] && entity.componentMask.test(componentTypeId)) {
+            componentPools[componentTypeId]->removeComponent(id);
+        }
+    }
+    archetypeStorage.removeEntity(id);
+
+    entity.active        = false;
+    entity.componentMask = ComponentMask();
+    queryCache.entityChanged(id, entity);
+
+    // invalidates all handles to the removed entity
+    entity.generation++;
+    freeEntities.push_back(getEntityIndex(id));
+
+    return true;
+}
+
+void EntityRegistry::destroyEntities(const std::vector<EntityId>& ids) {
+    // all handles are checked before anything is removed, so an invalid one
+    // does not leave the batch half destroyed
+    for(EntityId id : ids) {
+        ECS_VALIDATE_ENTITY(*this, id);
+    }
+
+    // deactivating the entities first skips duplicates (and stale handles
+    // without validation)
+    std::vector<EntityId> removedIds;
+    removedIds.reserve(ids.size());
+    for(EntityId id : ids) {
+        if(isEntityValid(id)) {
+            entities[getEntityIndex(id)].active = false;
+            removedIds.push_back(id);
+        }
+    }
+
+    // every pool, archetype and query is compacted once for the whole batch
+    for(auto& pool : componentPools) {
+        if(pool) {
+            pool->removeComponents(removedIds);
+        }
+    }
+    archetypeStorage.removeEntities(removedIds);
+    queryCache.entitiesRemoved(removedIds);
+
+    for(EntityId id : removedIds) {
+        Entity& entity       = entities[getEntityIndex(id)];
+        entity.componentMask = ComponentMask();
+
+        // invalidates all handles to the removed entity
+        entity.generation++;
+        freeEntities.push_back(getEntityIndex(id));
+    }
+}
+
+std::vector<EntityId> EntityRegistry::reserveEntities(size_t count) {
+    std::vector<EntityId> ids;
+    ids.reserve(count);
+
+    while(ids.size() < count && !freeEntities.empty()) {
+        uint32_t index = freeEntities.back();
+        freeEntities.pop_back();
+
+        Entity& entity       = entities[index];
+        entity.active        = true;
+        entity.componentMask = ComponentMask();
+        ids.push_back(makeEntityId(index, entity.generation));
+    }
+
+    size_t newEntities = count - ids.size();
+    reserveAdditional(entities, newEntities);
+    for(size_t i = 0; i < newEntities; i++) {
+        entities.emplace_back();
+        ids.push_back(makeEntityId(static_cast<uint32_t>(entities.size() - 1), 0));
+    }
+
+    return ids;
+}
+
+bool EntityRegistry::isEntityValid(EntityId id) const {
+    uint32_t index = getEntityIndex(id);
+    return index < entities.size() && entities[index].active
+           && entities[index].generation == getEntityGeneration(id);
+}
+
+void EntityRegistry::validateEntity(EntityId id) const {
+    if(!isEntityValid(id)) {
+        throw std::runtime_error("invalid entity handle (index " + std::to_string(getEntityIndex(id))
+                                 + ", generation " + std::to_string(getEntityGeneration(id)) + ")");
+    }
+}
+
+void EntityRegistry::playbackCommands() {
+    commandBuffer.playback(*this);
+}
+
+void EntityRegistry::markTransformationChanged(EntityId id, Transformation& transformation) {
+    // the flag makes sure every entity is only added once, only the system
+    // owning the Transformation writes it, so it does not need the lock
+    if(transformation.hasChanged) {
+        return;
+    }
+    transformation.hasChanged = true;
+
+    std::lock_guard<std::mutex> lock(changedTransformationsMutex);
+    changedTransformations.push_back(id);
+}
+
+void EntityRegistry::updateTransformations() {
+    updatedTransformations.clear();
+    std::swap(updatedTransformations, changedTransformations);
+
+    // the entity might have been removed in the meantime
+    updatedTransformations.erase(
+        std::remove_if(updatedTransformations.begin(), updatedTransformations.end(),
+                       [this](EntityId id) {
+                           return !isEntityValid(id) || getComponent<Transformation>(id) == nullptr;
+                       }),
+        updatedTransformations.end());
+
+    transformBatch.resize(updatedTransformations.size());
+    for(size_t i = 0; i < updatedTransformations.size(); i++) {
+        auto* transformation = getComponent<Transformation>(updatedTransformations[i]);
+        transformBatch.set(i, transformation->translation, transformation->rotation,
+                           transformation->scaling);
+    }
+
+    composeTransformations(transformBatch);
+
+    for(size_t i = 0; i < updatedTransformations.size(); i++) {
+        auto* transformation = getComponent<Transformation>(updatedTransformations[i]);
+        transformation->transformation        = transformBatch.transformations[i];
+        transformation->normalsTransformation = transformBatch.normalsTransformations[i];
+        transformation->hasChanged            = false;
+
+        // world bounds only change with the transformation, so culling can
+        // use them without transforming the bounds of every entity each frame
+        if(auto* bounds = getComponent<BoundsComponent>(updatedTransformations[i])) {
+            bounds->world = transformBounds(bounds->local, transformation->transformation);
+        }
+    }
+}
+
+const std::vector<EntityId>& EntityRegistry::getUpdatedTransformations() {
+    return updatedTransformations;
+}
+
+std::vector<Entity>& EntityRegistry::getEntities() {
+    return entities;
+}
+
+const EntityQuery& EntityRegistry::getQuery(ComponentMask mask) {
+    return queryCache.getQuery(mask, entities);
+}
@@ -0,0 +1,326 @@
+#ifndef GRAPHICSPRAKTIKUM_ENTITYREGISTRY_H
+#define GRAPHICSPRAKTIKUM_ENTITYREGISTRY_H
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Entity.h"
+#include "Component.h"
+#include "EntityQuery.h"
+#include "EntityCommandBuffer.h"
+#include "Archetype.h"
+#include "Transformation.h"
+#include "TransformBatch.h"
+#include "utils/ThreadPool.h"
+
+// SparseSet stores every component type in its own pool, Archetype stores
+// entities with the same set of components together in chunks. Archetypes are
+// faster to iterate, but adding components is more expensive.
+enum class StorageMode
+{
+    SparseSet,
+    Archetype
+};
+
+// Entities, their components and the queries over them. This is the part of
+// the Scene that does not depend on Vulkan, so it can be used on its own, e.g.
+// by the benchmarks.
+class EntityRegistry
+{
+  private:
+    // indexed by getEntityIndex()
+    std::vector<Entity>   entities;
+    std::vector<uint32_t> freeEntities;
+
+    StorageMode storageMode;
+
+    // indexed by ComponentTypeId, pools are created on the first assign
+    std::array<std::unique_ptr<ComponentPoolBase>, MAX_COMPONENT_TYPES> componentPools;
+    ArchetypeStorage archetypeStorage;
+
+    QueryCache queryCache;
+
+    // structural changes recorded by systems, applied by playbackCommands()
+    EntityCommandBuffer commandBuffer;
+
+    // entities whose Transformation changed since the last updateTransformations()
+    std::vector<EntityId> changedTransformations;
+    std::mutex            changedTransformationsMutex;
+    // entities whose matrices got recalculated by the last updateTransformations()
+    std::vector<EntityId> updatedTransformations;
+    // scratch storage for composing the matrices of all changed transformations
+    TransformBatch transformBatch;
+
+  public:
+    explicit EntityRegistry(StorageMode storageMode = StorageMode::SparseSet);
+
+    EntityId addEntity();
+
+    // returns false if the entity was already removed
+    bool removeEntity(EntityId id);
+
+    // Creates "count" entities that all have default constructed components of
+    // ComponentTypes. Storage for entities and components is reserved once and
+    // with archetype storage the entities go directly into their archetype.
+    template <typename... ComponentTypes>
+    std::vector<EntityId> createEntities(size_t count) {
+        std::vector<EntityId> ids = reserveEntities(count);
+
+        constexpr ComponentMask componentMask = getComponentMask<ComponentTypes...>();
+
+        if constexpr(sizeof...(ComponentTypes) > 0) {
+            if(storageMode == StorageMode::Archetype) {
+                archetypeStorage.addEntities<ComponentTypes...>(ids.data(), ids.size());
+            } else {
+                (reserveComponents<ComponentTypes>(count), ...);
+                for(EntityId id : ids) {
+                    (getPool<ComponentTypes>()->addComponent(id), ...);
+                }
+            }
+        }
+
+        for(EntityId id : ids) {
+            Entity& entity       = entities[getEntityIndex(id)];
+            entity.componentMask = componentMask;
+            queryCache.entityChanged(id, entity);
+        }
+
+        return ids;
+    }
+
+    // Removes all entities at once, every component pool (or archetype) and
+    // query is compacted once for the whole batch. With validation all handles
+    // are checked before the first entity is removed.
+    void destroyEntities(const std::vector<EntityId>& ids);
+
+    // false for handles of removed entities
+    bool isEntityValid(EntityId id) const;
+
+    // throws if the handle is not valid, use ECS_VALIDATE_ENTITY() so the check
+    // only exists in validation builds
+    void validateEntity(EntityId id) const;
+
+    std::vector<Entity>& getEntities();
+
+    // dense list of all entities that have at least the components in "mask"
+    const EntityQuery& getQuery(ComponentMask mask);
+
+    template <typename T>
+    T* assign(EntityId entityId) {
+        ECS_VALIDATE_ENTITY(*this, entityId);
+
+        constexpr ComponentTypeId componentTypeId = getComponentTypeId<T>();
+
+        T* component;
+        if(storageMode == StorageMode::Archetype) {
+            // moves the entity to another archetype, invalidates all pointers
+            // to its other components
+            component = archetypeStorage.addComponent<T>(entityId);
+        } else {
+            auto& pool = componentPools[componentTypeId];
+            if(!pool) {
+                pool = std::make_unique<ComponentPool<T>>();
+            }
+            component = static_cast<ComponentPool<T>*>(pool.get())->addComponent(entityId);
+        }
+
+        Entity& entity = entities[getEntityIndex(entityId)];
+        entity.componentMask.set(componentTypeId);
+        queryCache.entityChanged(entityId, entity);
+
+        return component;
+    }
+
+    template <typename T>
+    void removeComponent(EntityId entityId) {
+        ECS_VALIDATE_ENTITY(*this, entityId);
+
+        constexpr ComponentTypeId componentTypeId = getComponentTypeId<T>();
+
+        Entity& entity = entities[getEntityIndex(entityId)];
+        if(!entity.componentMask.test(componentTypeId)) {
+            return;
+        }
+
+        if(storageMode == StorageMode::Archetype) {
+            archetypeStorage.removeComponent(entityId, componentTypeId);
+        } else {
+            componentPools[componentTypeId]->removeComponent(entityId);
+        }
+
+        entity.componentMask.reset(componentTypeId);
+        queryCache.entityChanged(entityId, entity);
+    }
+
+    // returns nullptr if the entity does not have a component of type T
+    template <typename T>
+    T* getComponent(EntityId entityId) {
+        ECS_VALIDATE_ENTITY(*this, entityId);
+
+        if(storageMode == StorageMode::Archetype) {
+            return archetypeStorage.getComponent<T>(entityId);
+        }
+
+        ComponentPool<T>* pool = getPool<T>();
+        if(pool == nullptr) {
+            return nullptr;
+        }
+        return pool->getComponent(entityId);
+    }
+
+    // gives access to the densely packed components of type T, nullptr if no
+    // entity had a component of this type yet or archetypes are used
+    template <typename T>
+    ComponentPool<T>* getPool() {
+        return static_cast<ComponentPool<T>*>(componentPools[getComponentTypeId<T>()].get());
+    }
+
+    // addEntity(), removeEntity(), assign() and removeComponent() must not be
+    // called while systems are running, systems record them here instead
+    EntityCommandBuffer& getCommandBuffer() { return commandBuffer; }
+
+    // applies the recorded structural changes, has to be called after the
+    // systems finished (after SystemScheduler::run())
+    void playbackCommands();
+
+    StorageMode       getStorageMode() const { return storageMode; }
+    ArchetypeStorage& getArchetypeStorage() { return archetypeStorage; }
+
+    // has to be called after translation, rotation or scaling of an entity
+    // were written, can be called from multiple systems at the same time
+    void markTransformationChanged(EntityId id, Transformation& transformation);
+
+    // recalculates the matrices of all changed Transformations and the world
+    // bounds of their BoundsComponents, has to run once per frame before the
+    // render passes are recorded
+    void updateTransformations();
+
+    const std::vector<EntityId>& getUpdatedTransformations();
+
+    // destroys all component pools
+    void cleanupComponents();
+
+  private:
+    // activates free entity slots or appends new ones, the entities do not
+    // have components and are not added to the queries yet
+    std::vector<EntityId> reserveEntities(size_t count);
+
+    template <typename T>
+    void reserveComponents(size_t count) {
+        auto& pool = componentPools[getComponentTypeId<T>()];
+        if(!pool) {
+            pool = std::make_unique<ComponentPool<T>>(count);
+        } else {
+            static_cast<ComponentPool<T>*>(pool.get())->reserve(count);
+        }
+    }
+};
+
+template <typename... ComponentTypes>
+struct SceneView
+{
+    EntityRegistry*    registry{nullptr};
+    ComponentMask      componentMask;
+    const EntityQuery* query{nullptr};
+
+    SceneView(EntityRegistry& registry)
+        : registry(&registry)
+        , componentMask(getComponentMask<ComponentTypes...>()) {
+        query = &registry.getQuery(componentMask);
+    }
+
+    // walks the dense entity list of the query by index, so entities that get
+    // added while iterating do not invalidate the iterator
+    struct Iterator
+    {
+        const std::vector<EntityId>* entities;
+        size_t                       index;
+
+        Iterator(const std::vector<EntityId>* entities, size_t index)
+            : entities(entities)
+            , index(index) {}
+
+        EntityId operator*() const { return (*entities)[index]; }
+
+        bool operator==(const Iterator& other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return index != other.index;
+        }
+
+        Iterator& operator++() {
+            index++;
+            return *this;
+        }
+    };
+
+    Iterator begin() const { return Iterator(&query->entities, 0); }
+
+    Iterator end() const {
+        return Iterator(&query->entities, query->entities.size());
+    }
+
+    // Calls fn(EntityId, ComponentTypes&...) for every entity of the view.
+    // With archetype storage this walks the component arrays of each chunk
+    // directly instead of looking up every component by its entity.
+    // fn must not add or remove entities or components.
+    template <typename Fn>
+    void each(Fn&& fn) const {
+        if(registry->getStorageMode() == StorageMode::Archetype) {
+            registry->getArchetypeStorage().forEachChunk(
+                componentMask, [&fn](Archetype& archetype, ArchetypeChunk& chunk) {
+                    eachInChunk(archetype, chunk, fn);
+                });
+        } else {
+            for(EntityId id : *this) {
+                fn(id, *registry->getComponent<ComponentTypes>(id)...);
+            }
+        }
+    }
+
+    // same as each(), but batches of entities (or whole chunks) are processed
+    // in parallel on the thread pool, so fn has to be thread safe
+    template <typename Fn>
+    void eachParallel(ThreadPool& threadPool, size_t batchSize, Fn&& fn) const {
+        if(registry->getStorageMode() == StorageMode::Archetype) {
+            std::vector<std::pair<Archetype*, ArchetypeChunk*>> chunks;
+            registry->getArchetypeStorage().forEachChunk(
+                componentMask, [&chunks](Archetype& archetype, ArchetypeChunk& chunk) {
+                    chunks.emplace_back(&archetype, &chunk);
+                });
+
+            threadPool.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++) {
+                    eachInChunk(*chunks[i].first, *chunks[i].second, fn);
+                }
+            });
+        } else {
+            const std::vector<EntityId>& entities = query->entities;
+
+            threadPool.parallelFor(entities.size(), batchSize, [&](size_t begin, size_t end) {
+                for(size_t i = begin; i < end; i++) {
+                    EntityId id = entities[i];
+                    fn(id, *registry->getComponent<ComponentTypes>(id)...);
+                }
+            });
+        }
+    }
+
+  private:
+    template <typename Fn>
+    static void eachInChunk(Archetype& archetype, ArchetypeChunk& chunk, Fn& fn) {
+        EntityId* entities = archetype.getEntities(chunk);
+        auto      columns  = std::make_tuple(archetype.getColumn<ComponentTypes>(chunk)...);
+
+        for(uint32_t row = 0; row < chunk.count; row++) {
+            fn(entities[row], std::get<ComponentTypes*>(columns)[row]...);
+        }
+    }
+};
+
+#endif  // GRAPHICSPRAKTIKUM_ENTITYREGISTRY_H
@@ -0,0 +1,195 @@
+#include "FrustumCulling.h"
+#include <cmath>
+#include "glm/geometric.hpp"
+
+#if defined(TRANSFORM_SIMD_AVX2) || defined(TRANSFORM_SIMD_SSE4)
+#include <immintrin.h>
+#endif
+
+Frustum extractFrustum(const glm::mat4& projectionView) {
+    // rows of the matrix, glm stores columns
+    glm::vec4 rows[4];
+    for(int row = 0; row < 4; row++) {
+        rows[row] = glm::vec4(projectionView[0][row], projectionView[1][row],
+                              projectionView[2][row], projectionView[3][row]);
+    }
+
+    // -w <= x, y, z <= w in clip space, which is the OpenGL depth range glm
+    // uses by default. For a 0 <= z <= w depth range the near plane is a bit
+    // too far behind the camera, which only makes the culling less strict.
+    Frustum frustum;
+    frustum.planes[0] = rows[3] + rows[0];  // left
+    frustum.planes[1] = rows[3] - rows[0];  // right
+    frustum.planes[2] = rows[3] + rows[1];  // bottom
+    frustum.planes[3] = rows[3] - rows[1];  // top
+    frustum.planes[4] = rows[3] + rows[2];  // near
+    frustum.planes[5] = rows[3] - rows[2];  // far
+
+    for(glm::vec4& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
+
+Frustum extractShadowCasterFrustum(const glm::mat4& lightProjectionView) {
+    Frustum frustum = extractFrustum(lightProjectionView);
+
+    // no normal and a positive distance, so every object is inside
+    frustum.planes[4] = glm::vec4(0, 0, 0, 1);
+    return frustum;
+}
+
+void CullingBatch::clear() {
+    for(auto* values : {&boxCenterX, &boxCenterY, &boxCenterZ, &boxExtentX, &boxExtentY,
+                        &boxExtentZ, &sphereCenterX, &sphereCenterY, &sphereCenterZ, &sphereRadius}) {
+        values->clear();
+    }
+}
+
+void CullingBatch::add(const Bounds& bounds) {
+    glm::vec3 boxCenter = (bounds.min + bounds.max) * 0.5f;
+    glm::vec3 boxExtent = (bounds.max - bounds.min) * 0.5f;
+
+    boxCenterX.push_back(boxCenter.x);
+    boxCenterY.push_back(boxCenter.y);
+    boxCenterZ.push_back(boxCenter.z);
+    boxExtentX.push_back(boxExtent.x);
+    boxExtentY.push_back(boxExtent.y);
+    boxExtentZ.push_back(boxExtent.z);
+    sphereCenterX.push_back(bounds.center.x);
+    sphereCenterY.push_back(bounds.center.y);
+    sphereCenterZ.push_back(bounds.center.z);
+    sphereRadius.push_back(bounds.radius);
+}
+
+static size_t cullBatchScalar(const Frustum& frustum, const CullingBatch& batch,
+                              std::vector<uint8_t>& visibleObjects, size_t begin, size_t end) {
+    size_t visibleCount = 0;
+    for(size_t i = begin; i < end; i++) {
+        bool visible = true;
+        for(const glm::vec4& plane : frustum.planes) {
+            // distance of the box center and the extent of the box along the normal
+            float boxDistance = plane.x * batch.boxCenterX[i] + plane.y * batch.boxCenterY[i]
+                                + plane.z * batch.boxCenterZ[i] + plane.w;
+            float boxRadius = std::abs(plane.x) * batch.boxExtentX[i]
+                              + std::abs(plane.y) * batch.boxExtentY[i]
+                              + std::abs(plane.z) * batch.boxExtentZ[i];
+            float sphereDistance = plane.x * batch.sphereCenterX[i] + plane.y * batch.sphereCenterY[i]
+                                   + plane.z * batch.sphereCenterZ[i] + plane.w;
+
+            if(boxDistance < -boxRadius || sphereDistance < -batch.sphereRadius[i]) {
+                visible = false;
+                break;
+            }
+        }
+        visibleObjects[i] = visible;
+        visibleCount += visible;
+    }
+    return visibleCount;
+}
+
+#if defined(TRANSFORM_SIMD_AVX2) || defined(TRANSFORM_SIMD_SSE4)
+
+#if defined(TRANSFORM_SIMD_AVX2)
+struct CullingOps
+{
+    using Float = __m256;
+
+    static constexpr size_t width = 8;
+
+    static Float load(const float* values) { return _mm256_loadu_ps(values); }
+    static Float set(float value) { return _mm256_set1_ps(value); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Float neg(Float a) { return _mm256_xor_ps(a, set(-0.0f)); }
+    static Float bitOr(Float a, Float b) { return _mm256_or_ps(a, b); }
+    static Float less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    // one bit per lane
+    static int   mask(Float a) { return _mm256_movemask_ps(a); }
+};
+#else
+struct CullingOps
+{
+    using Float = __m128;
+
+    static constexpr size_t width = 4;
+
+    static Float load(const float* values) { return _mm_loadu_ps(values); }
+    static Float set(float value) { return _mm_set1_ps(value); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    static Float neg(Float a) { return _mm_xor_ps(a, set(-0.0f)); }
+    static Float bitOr(Float a, Float b) { return _mm_or_ps(a, b); }
+    static Float less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+    // one bit per lane
+    static int   mask(Float a) { return _mm_movemask_ps(a); }
+};
+#endif
+
+static size_t cullBatchSimd(const Frustum& frustum, const CullingBatch& batch,
+                            std::vector<uint8_t>& visibleObjects, size_t begin) {
+    using Ops   = CullingOps;
+    using Float = Ops::Float;
+
+    Float boxCenterX = Ops::load(&batch.boxCenterX[begin]);
+    Float boxCenterY = Ops::load(&batch.boxCenterY[begin]);
+    Float boxCenterZ = Ops::load(&batch.boxCenterZ[begin]);
+    Float boxExtentX = Ops::load(&batch.boxExtentX[begin]);
+    Float boxExtentY = Ops::load(&batch.boxExtentY[begin]);
+    Float boxExtentZ = Ops::load(&batch.boxExtentZ[begin]);
+    Float sphereCenterX = Ops::load(&batch.sphereCenterX[begin]);
+    Float sphereCenterY = Ops::load(&batch.sphereCenterY[begin]);
+    Float sphereCenterZ = Ops::load(&batch.sphereCenterZ[begin]);
+    Float negativeRadius = Ops::neg(Ops::load(&batch.sphereRadius[begin]));
+
+    Float outside = Ops::set(0);
+    for(const glm::vec4& plane : frustum.planes) {
+        Float x = Ops::set(plane.x);
+        Float y = Ops::set(plane.y);
+        Float z = Ops::set(plane.z);
+        Float w = Ops::set(plane.w);
+
+        Float boxDistance = Ops::add(Ops::add(Ops::mul(x, boxCenterX), Ops::mul(y, boxCenterY)),
+                                     Ops::add(Ops::mul(z, boxCenterZ), w));
+        Float negativeBoxRadius = Ops::set(0);
+        negativeBoxRadius = Ops::add(negativeBoxRadius, Ops::mul(Ops::set(-std::abs(plane.x)), boxExtentX));
+        negativeBoxRadius = Ops::add(negativeBoxRadius, Ops::mul(Ops::set(-std::abs(plane.y)), boxExtentY));
+        negativeBoxRadius = Ops::add(negativeBoxRadius, Ops::mul(Ops::set(-std::abs(plane.z)), boxExtentZ));
+        Float sphereDistance =
+            Ops::add(Ops::add(Ops::mul(x, sphereCenterX), Ops::mul(y, sphereCenterY)),
+                     Ops::add(Ops::mul(z, sphereCenterZ), w));
+
+        outside = Ops::bitOr(outside, Ops::less(boxDistance, negativeBoxRadius));
+        outside = Ops::bitOr(outside, Ops::less(sphereDistance, negativeRadius));
+    }
+
+    int    outsideMask  = Ops::mask(outside);
+    size_t visibleCount = 0;
+    for(size_t lane = 0; lane < Ops::width; lane++) {
+        bool visible = (outsideMask & (1 << lane)) == 0;
+        visibleObjects[begin + lane] = visible;
+        visibleCount += visible;
+    }
+    return visibleCount;
+}
+
+size_t cullBatch(const Frustum& frustum, const CullingBatch& batch, std::vector<uint8_t>& visible) {
+    size_t count = batch.size();
+    visible.resize(count);
+
+    size_t visibleCount = 0;
+    size_t begin        = 0;
+    for(; begin + CullingOps::width <= count; begin += CullingOps::width) {
+        visibleCount += cullBatchSimd(frustum, batch, visible, begin);
+    }
+    return visibleCount + cullBatchScalar(frustum, batch, visible, begin, count);
+}
+
+#else
+
+size_t cullBatch(const Frustum& frustum, const CullingBatch& batch, std::vector<uint8_t>& visible) {
+    visible.resize(batch.size());
+    return cullBatchScalar(frustum, batch, visible, 0, batch.size());
+}
+
+#endif
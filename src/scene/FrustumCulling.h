@@ -0,0 +1,49 @@
+#ifndef GRAPHICSPRAKTIKUM_FRUSTUMCULLING_H
+#define GRAPHICSPRAKTIKUM_FRUSTUMCULLING_H
+
+#include <cstdint>
+#include <vector>
+#include "glm/vec4.hpp"
+#include "glm/mat4x4.hpp"
+#include "Bounds.h"
+
+// Planes of a view volume, a point p is inside of a plane if
+// dot(vec3(plane), p) + plane.w >= 0. The normals have unit length.
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+// extracts the planes out of a projection * view matrix (Gribb and Hartmann)
+Frustum extractFrustum(const glm::mat4& projectionView);
+
+// Volume of the objects that can cast shadows into the view volume of a
+// directional light given by its orthographic projection * view matrix. The
+// near plane is dropped, so the volume reaches from the far plane all the way
+// back to the light and objects in front of the shadow map are kept as well.
+Frustum extractShadowCasterFrustum(const glm::mat4& lightProjectionView);
+
+// World bounds of many objects stored as structure of arrays, so they can be
+// tested against the frustum planes several at a time.
+struct CullingBatch
+{
+    std::vector<float> boxCenterX, boxCenterY, boxCenterZ;
+    std::vector<float> boxExtentX, boxExtentY, boxExtentZ;
+    std::vector<float> sphereCenterX, sphereCenterY, sphereCenterZ;
+    std::vector<float> sphereRadius;
+
+    void clear();
+
+    size_t size() const { return boxCenterX.size(); }
+
+    void add(const Bounds& bounds);
+};
+
+// Writes 1 into "visible" for every object of the batch inside of the
+// frustum and 0 for the others. An object is culled if its box or its sphere
+// is completely outside of one of the planes, so objects near a corner of the
+// frustum can be kept even though they are outside. Uses AVX2 or SSE4.1 like
+// composeTransformations(). Returns the number of visible objects.
+size_t cullBatch(const Frustum& frustum, const CullingBatch& batch, std::vector<uint8_t>& visible);
+
+#endif  // GRAPHICSPRAKTIKUM_FRUSTUMCULLING_H
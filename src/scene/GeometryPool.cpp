@@ -0,0 +1,101 @@
+#include "GeometryPool.h"
+#include <algorithm>
+#include <cstring>
+
+void GeometryPool::cleanup(VulkanBaseContext& baseContext) {
+    for(GeometryBlock& block : blocks) {
+        vkDestroyBuffer(baseContext.device, block.indexBuffer, nullptr);
+        vkFreeMemory(baseContext.device, block.indexBufferMemory, nullptr);
+
+        vkDestroyBuffer(baseContext.device, block.vertexBuffer, nullptr);
+        vkFreeMemory(baseContext.device, block.vertexBufferMemory, nullptr);
+    }
+    blocks.clear();
+}
+
+static void createGeometryBlock(const VulkanBaseContext& context,
+                                uint32_t                 vertexCapacity,
+                                uint32_t                 indexCapacity,
+                                GeometryBlock&           block) {
+    block.vertexCapacity = vertexCapacity;
+    block.indexCapacity  = indexCapacity;
+
+    createBuffer(context, vertexCapacity * sizeof(Vertex),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, block.vertexBuffer,
+                 block.vertexBufferMemory);
+
+    createBuffer(context, indexCapacity * sizeof(uint32_t),
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, block.indexBuffer,
+                 block.indexBufferMemory);
+}
+
+void uploadGeometry(const VulkanBaseContext& context,
+                    const CommandContext&    commandContext,
+                    GeometryPool&            pool,
+                    const GeometryData&      geometry,
+                    std::vector<Mesh>&       meshes) {
+    uint32_t vertexCount = static_cast<uint32_t>(geometry.vertices.size());
+    uint32_t indexCount  = static_cast<uint32_t>(geometry.indices.size());
+    if(vertexCount == 0 || indexCount == 0) {
+        return;
+    }
+
+    bool fits = !pool.blocks.empty()
+                && pool.blocks.back().vertexCount + vertexCount <= pool.blocks.back().vertexCapacity
+                && pool.blocks.back().indexCount + indexCount <= pool.blocks.back().indexCapacity;
+    if(!fits) {
+        pool.blocks.emplace_back();
+        createGeometryBlock(context, std::max(vertexCount, GEOMETRY_BLOCK_VERTICES),
+                            std::max(indexCount, GEOMETRY_BLOCK_INDICES), pool.blocks.back());
+    }
+
+    uint32_t       blockIndex = static_cast<uint32_t>(pool.blocks.size() - 1);
+    GeometryBlock& block      = pool.blocks[blockIndex];
+
+    // vertices and indices share one staging buffer, the indices follow the
+    // vertices
+    VkDeviceSize verticesSize = vertexCount * sizeof(Vertex);
+    VkDeviceSize indicesSize  = indexCount * sizeof(uint32_t);
+
+    VkBuffer       stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+
+    createBuffer(context, verticesSize + indicesSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 stagingBuffer, stagingBufferMemory);
+
+    void* data;
+    vkMapMemory(context.device, stagingBufferMemory, 0, verticesSize + indicesSize, 0, &data);
+    memcpy(data, geometry.vertices.data(), (size_t)verticesSize);
+    memcpy(static_cast<char*>(data) + verticesSize, geometry.indices.data(), (size_t)indicesSize);
+    vkUnmapMemory(context.device, stagingBufferMemory);
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(context, commandContext);
+
+    VkBufferCopy vertexRegion{};
+    vertexRegion.srcOffset = 0;
+    vertexRegion.dstOffset = block.vertexCount * sizeof(Vertex);
+    vertexRegion.size      = verticesSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, block.vertexBuffer, 1, &vertexRegion);
+
+    VkBufferCopy indexRegion{};
+    indexRegion.srcOffset = verticesSize;
+    indexRegion.dstOffset = block.indexCount * sizeof(uint32_t);
+    indexRegion.size      = indicesSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, block.indexBuffer, 1, &indexRegion);
+
+    endSingleTimeCommands(context, commandContext, commandBuffer);
+
+    vkDestroyBuffer(context.device, stagingBuffer, nullptr);
+    vkFreeMemory(context.device, stagingBufferMemory, nullptr);
+
+    for(Mesh& mesh : meshes) {
+        mesh.geometryBlock = blockIndex;
+        mesh.firstIndex += block.indexCount;
+        mesh.vertexOffset += static_cast<int32_t>(block.vertexCount);
+    }
+    block.vertexCount += vertexCount;
+    block.indexCount += indexCount;
+}
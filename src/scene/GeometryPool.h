@@ -0,0 +1,62 @@
+#ifndef GRAPHICSPRAKTIKUM_GEOMETRYPOOL_H
+#define GRAPHICSPRAKTIKUM_GEOMETRYPOOL_H
+
+#include <cstdint>
+#include <vector>
+#include "vulkan/VulkanUtils.h"
+#include "Model.h"
+
+// size of a new block, geometry that does not fit gets a larger block of its own
+const uint32_t GEOMETRY_BLOCK_VERTICES = 1 << 18;
+const uint32_t GEOMETRY_BLOCK_INDICES  = 1 << 20;
+
+// a device local vertex and index buffer the geometry of many meshes is
+// placed into one after the other
+struct GeometryBlock
+{
+    VkBuffer       vertexBuffer       = VK_NULL_HANDLE;
+    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+
+    VkBuffer       indexBuffer       = VK_NULL_HANDLE;
+    VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+
+    uint32_t vertexCapacity = 0;
+    uint32_t indexCapacity  = 0;
+    // used part of the buffers
+    uint32_t vertexCount = 0;
+    uint32_t indexCount  = 0;
+};
+
+// Vertices and indices of all meshes, sub-allocated from a few large blocks
+// (usually a single one), so the passes only have to bind the buffers again
+// when the block of the next draw is a different one.
+struct GeometryPool
+{
+    std::vector<GeometryBlock> blocks;
+
+    void cleanup(VulkanBaseContext& baseContext);
+};
+
+// Geometry of meshes that is not uploaded yet. The indices of every mesh are
+// relative to its first vertex, which is Mesh::vertexOffset in "vertices".
+struct GeometryData
+{
+    std::vector<Vertex>   vertices;
+    std::vector<uint32_t> indices;
+
+    void clear() {
+        vertices.clear();
+        indices.clear();
+    }
+};
+
+// Uploads all of "geometry" with one staging buffer and one copy into the last
+// block of the pool, or into a new block if it does not fit. The offsets of
+// the meshes point into "geometry" and are moved to their place in the block.
+void uploadGeometry(const VulkanBaseContext& context,
+                    const CommandContext&    commandContext,
+                    GeometryPool&            pool,
+                    const GeometryData&      geometry,
+                    std::vector<Mesh>&       meshes);
+
+#endif  // GRAPHICSPRAKTIKUM_GEOMETRYPOOL_H
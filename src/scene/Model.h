@@ -4,6 +4,8 @@
 #include "tiny_gltf.h"
 #include <vector>
 #include <glm/mat4x4.hpp>
+#include "ModelComponent.h"
+#include "Bounds.h"
 
 // in "rendering/host_device.h" is a copy of this called "MaterialDescription" for use on GPU
 struct Material
@@ -81,22 +83,14 @@ struct Mesh
 {
     uint32_t verticesCount;
     uint32_t indicesCount;
-    // radius of the bounding sphere around the Mesh -> will be used for frustum culling
-    float radius;
-
-    VkBuffer       vertexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
-
-    VkBuffer       indexBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
-
-    void cleanup(VulkanBaseContext& baseContext) {
-        vkDestroyBuffer(baseContext.device, indexBuffer, nullptr);
-        vkFreeMemory(baseContext.device, indexBufferMemory, nullptr);
-
-        vkDestroyBuffer(baseContext.device, vertexBuffer, nullptr);
-        vkFreeMemory(baseContext.device, vertexBufferMemory, nullptr);
-    }
+    // bounding box and sphere around all vertices, used for frustum culling
+    Bounds bounds;
+
+    // position of the geometry in the GeometryPool of the scene, the buffers
+    // are bound once per block and the draws start at these offsets
+    uint32_t geometryBlock = 0;
+    uint32_t firstIndex    = 0;
+    int32_t  vertexOffset  = 0;
 };
 
 struct MeshPart
@@ -105,14 +99,17 @@ struct MeshPart
     int meshIndex;
     // references Material stored in the std::vector<Material> inside Scene
     int materialIndex;
+    // copy of the bounds of the Mesh
+    Bounds bounds;
 
     MeshPart()
         : meshIndex(-1)
         , materialIndex(-1) {}
 
-    MeshPart(int meshIndex,int materialIndex)
+    MeshPart(int meshIndex, int materialIndex, const Bounds& bounds)
         : meshIndex(meshIndex)
-        , materialIndex(materialIndex) {}
+        , materialIndex(materialIndex)
+        , bounds(bounds) {}
 
     bool operator==(const MeshPart& other) const {
         return meshIndex == other.meshIndex && materialIndex == other.materialIndex;
@@ -122,10 +119,8 @@ struct MeshPart
 struct Model
 {
     std::vector<int> meshPartIndices;
-};
-
-struct ModelComponent {
-    int modelIndex;
+    // bounds around all MeshParts of the Model
+    Bounds bounds;
 };
 
 class ModelInstance
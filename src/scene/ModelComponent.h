@@ -0,0 +1,9 @@
+#ifndef GRAPHICSPRAKTIKUM_MODELCOMPONENT_H
+#define GRAPHICSPRAKTIKUM_MODELCOMPONENT_H
+
+// index into SceneData::models
+struct ModelComponent {
+    int modelIndex;
+};
+
+#endif  // GRAPHICSPRAKTIKUM_MODELCOMPONENT_H
@@ -94,98 +94,15 @@ unsigned int bytesToUnsignedInt(unsigned char* address) {
     return out;
 }
 
-/*
- * Creates vertex and index buffers on the GPU and stores a reference to the
- * handle in the mesh.
- */
-void createMeshBuffers(VulkanBaseContext         context,
-                       CommandContext            commandContext,
-                       std::vector<Vertex>       vertices,
-                       std::vector<unsigned int> indices,
-                       Mesh&                     mesh) {
-    createSampleVertexBuffer(context, commandContext, vertices, mesh);
-    createSampleIndexBuffer(context, commandContext, indices, mesh);
-}
-
-/*
- * Creates a vertex buffer from the specified vertices vector and uploads it
- * to GPU. ALso stores a reference to the handle in the mesh.
- */
-void createSampleVertexBuffer(VulkanBaseContext&  context,
-                               CommandContext&     commandContext,
-                               std::vector<Vertex> vertices,
-                               Mesh&               mesh) {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-    VkBuffer       stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-
-    createBuffer(context, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 stagingBuffer, stagingBufferMemory);
-
-    //void* data = (void*)vertices.data();
-    void* data;
-    vkMapMemory(context.device, stagingBufferMemory, 0, bufferSize, 0, &data);
-
-    // We use Host Coherent Memory to make sure data is synchronized, could also manually flush Memory Ranges
-    memcpy(data, vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(context.device, stagingBufferMemory);
-
-    createBuffer(context, bufferSize,
-                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mesh.vertexBuffer,
-                 mesh.vertexBufferMemory);
-
-    copyBuffer(context, commandContext, stagingBuffer, mesh.vertexBuffer, bufferSize);
-
-    vkDestroyBuffer(context.device, stagingBuffer, nullptr);
-    vkFreeMemory(context.device, stagingBufferMemory, nullptr);
-}
-
-/*
- * Creates an index buffer from the specified indices vector and uploads it
- * to GPU. ALso stores a reference to the handle in the mesh.
- */
-void createSampleIndexBuffer(VulkanBaseContext&        baseContext,
-                              CommandContext&           commandContext,
-                              std::vector<unsigned int> indices,
-                              Mesh&                     mesh) {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    VkBuffer       stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-
-    createBuffer(baseContext, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                 stagingBuffer, stagingBufferMemory);
-
-    //void* data = (void*)indices.data();
-    void* data;
-    vkMapMemory(baseContext.device, stagingBufferMemory, 0, bufferSize, 0, &data);
-
-    // We use Host Coherent Memory to make sure data is synchronized, could also manually flush Memory Ranges
-    memcpy(data, indices.data(), (size_t)bufferSize);
-    vkUnmapMemory(baseContext.device, stagingBufferMemory);
-
-    createBuffer(baseContext, bufferSize,
-                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mesh.indexBuffer,
-                 mesh.indexBufferMemory);
-
-    copyBuffer(baseContext, commandContext, stagingBuffer, mesh.indexBuffer, bufferSize);
-
-    vkDestroyBuffer(baseContext.device, stagingBuffer, nullptr);
-    vkFreeMemory(baseContext.device, stagingBufferMemory, nullptr);
-}
-
 /*
  * Loads model from glTF2.0 file and converts everything to the internally used
- * format. Buffers get created for vertices, indices, materials and textures and
- * are uploaded to the GPU.
+ * format. Buffers get created for materials and textures and are uploaded to
+ * the GPU, the vertices and indices of all meshes are placed into the
+ * geometry pool.
  */
 bool ModelLoader::loadModel(const std::string&  filename,
                             ModelLoadingOffsets offsets,
+                            GeometryPool&       geometryPool,
                             VulkanBaseContext   context,
                             CommandContext      commandContext) {
     tinygltf::Model    gltfModel;
@@ -219,6 +136,8 @@ bool ModelLoader::loadModel(const std::string&  filename,
         Model model = createModelFromMesh(gltfModel, gltfMesh, context, commandContext);
         models.push_back(model);
     }
+    uploadGeometry(context, commandContext, geometryPool, geometry, meshes);
+    geometry.clear();
 
     // 2. create Materials
     for(auto& gltfMaterial : gltfModel.materials) {
@@ -249,8 +168,8 @@ bool ModelLoader::loadModel(const std::string&  filename,
  * Takes a mesh out of the glTF Mesh and transforms it into the internally used
  * Model. This function checks if the data used by this glTF Mesh is already
  * converted into the internal format and only sets the reference in this case.
- * If the data is not yet created, it will create Vertex and Index Buffers so
- * the Model can be used for GPU rendering later.
+ * If the data is not yet created, its vertices and indices are added to the
+ * geometry that loadModel() uploads into the geometry pool.
  */
 Model ModelLoader::createModelFromMesh(tinygltf::Model&  gltfModel,
                                        tinygltf::Mesh&   gltfMesh,
@@ -266,7 +185,8 @@ Model ModelLoader::createModelFromMesh(tinygltf::Model&  gltfModel,
                                    gltfModel.buffers, context, commandContext);
             meshes.push_back(mesh);
             meshParts.push_back(MeshPart(meshes.size() - 1 + offsets.meshesOffset,
-                                         primitive.material + offsets.materialsOffset));
+                                         primitive.material + offsets.materialsOffset,
+                                         mesh.bounds));
             model.meshPartIndices.push_back((int)meshParts.size() - 1 + offsets.meshPartsOffset);
             meshLookups.push_back(MeshLookup(primitive, meshes.size() - 1));
         } else {
@@ -286,11 +206,19 @@ Model ModelLoader::createModelFromMesh(tinygltf::Model&  gltfModel,
                 // create the MeshPart that points to the found Mesh and
                 // the material of the primitive
                 meshParts.push_back(MeshPart(meshIndex + offsets.meshesOffset,
-                                             primitive.material + offsets.materialsOffset));
+                                             primitive.material + offsets.materialsOffset,
+                                             meshes[meshIndex].bounds));
                 model.meshPartIndices.push_back(meshParts.size() - 1 + offsets.meshPartsOffset);
             }
         }
     }
+
+    // the Model is bounded by the bounds of all its MeshParts
+    for(size_t i = 0; i < model.meshPartIndices.size(); i++) {
+        const Bounds& bounds =
+            meshParts[model.meshPartIndices[i] - offsets.meshPartsOffset].bounds;
+        model.bounds = i == 0 ? bounds : mergeBounds(model.bounds, bounds);
+    }
     return model;
 }
 
@@ -580,8 +508,15 @@ Mesh ModelLoader::createMesh(tinygltf::Primitive&              primitive,
 
     mesh.verticesCount = vertices.size();
     mesh.indicesCount  = indices.size();
-    createMeshBuffers(context, commandContext, vertices, indices, mesh);
-    // TODO: calculate Mesh.radius for later frustum culling
+    if(!vertices.empty()) {
+        mesh.bounds = calculateBounds(&vertices[0].pos, vertices.size(), sizeof(Vertex));
+    }
+
+    // the indices stay relative to the first vertex of the mesh
+    mesh.firstIndex   = static_cast<uint32_t>(geometry.indices.size());
+    mesh.vertexOffset = static_cast<int32_t>(geometry.vertices.size());
+    geometry.vertices.insert(geometry.vertices.end(), vertices.begin(), vertices.end());
+    geometry.indices.insert(geometry.indices.end(), indices.begin(), indices.end());
     return mesh;
 }
 
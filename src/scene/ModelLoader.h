@@ -5,6 +5,7 @@
 #include "glm/vec4.hpp"
 #include "vulkan/VulkanUtils.h"
 #include "rendering/host_device.h"
+#include "GeometryPool.h"
 
 struct VertexObj
 {
@@ -15,21 +16,6 @@ struct VertexObj
     glm::vec2 texCoord;
 };
 
-void createMeshBuffers(VulkanBaseContext         context,
-                       CommandContext            commandContext,
-                       std::vector<Vertex>       vertices,
-                       std::vector<unsigned int> indices,
-                       Mesh&                     mesh);
-void createSampleVertexBuffer(VulkanBaseContext&  context,
-                               CommandContext&     commandContext,
-                               std::vector<Vertex> vertices,
-                               Mesh&               mesh);
-void createSampleIndexBuffer(VulkanBaseContext&        baseContext,
-                              CommandContext&           commandContext,
-                              std::vector<unsigned int> indices,
-                              Mesh&                     mesh);
-
-
 struct ModelLoadingOffsets
 {
     int meshesOffset    = 0;
@@ -58,6 +44,7 @@ class ModelLoader
   public:
     bool loadModel(const std::string&  filename,
                    ModelLoadingOffsets offsets,
+                   GeometryPool&       geometryPool,
                    VulkanBaseContext   context,
                    CommandContext      commandContext);
 
@@ -104,4 +91,6 @@ class ModelLoader
     int       findGeometryData(tinygltf::Primitive& primitive);
 
     std::vector<MeshLookup> meshLookups;
+    // geometry of all meshes, uploaded into the GeometryPool in one go
+    GeometryData geometry;
 };
\ No newline at end of file
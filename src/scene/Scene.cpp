@@ -1,33 +1,27 @@
 #include "Scene.h"
 #include "rendering/RenderContext.h"
 #include "physics/PhysicsComponent.h"
+#include "physics/PhysicsSync.h"
 #include "game/PlayerComponent.h"
 #include "rendering/host_device.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <algorithm>
 
-Scene::Scene(ApplicationVulkanContext& vulkanContext, Camera camera)
-    : m_Camera(camera)
+Scene::Scene(ApplicationVulkanContext& vulkanContext, Camera camera, StorageMode storageMode)
+    : EntityRegistry(storageMode)
+    , m_Camera(camera)
     , m_World(b2World(b2Vec2(0, -30.0)))
     , m_Context(vulkanContext) {}
 
 void Scene::cleanup() {
-    for(auto pair : componentPools) {
-        pair.second.clean();
-    }
+    cleanupComponents();
 
-    for(auto& mesh : sceneData.meshes) {
-        mesh.cleanup(m_Context.baseContext);
-    }
+    sceneData.geometryPool.cleanup(m_Context.baseContext);
 
     for(auto& texture : sceneData.textures) {
         texture.cleanup(m_Context.baseContext);
     }
 
-    if(sceneData.pointLightMesh.vertexBuffer != VK_NULL_HANDLE) {
-        sceneData.pointLightMesh.cleanup(m_Context.baseContext);
-    }
-
     sceneData.skybox.cleanup(m_Context.baseContext);
     sceneData.irradianceMap.cleanup(m_Context.baseContext);
     sceneData.radianceMap.cleanup(m_Context.baseContext);
@@ -86,6 +80,12 @@ void Scene::registerSceneImgui(RenderContext& renderContext) {
         ImGui::SliderFloat("Near plane", &perspectiveSettings.nearPlane, 0.1, 500);
         ImGui::SliderFloat("Far plane", &perspectiveSettings.farPlane, 0.1, 500);
         ImGui::SliderFloat("FOV", &perspectiveSettings.fov, 0, glm::pi<float>());
+
+        ImGui::Checkbox("Frustum Culling", &renderContext.imguiData.frustumCulling);
+        // indirect draws with a count buffer need Vulkan 1.2
+        if(m_Context.baseContext.supportsIndirectCount) {
+            ImGui::Checkbox("GPU Culling", &renderContext.imguiData.gpuCulling);
+        }
     }
     if(ImGui::CollapsingHeader("Shadow Controls")) {
 
@@ -118,6 +118,17 @@ void Scene::registerSceneImgui(RenderContext& renderContext) {
 
             ImGui::SliderInt("Vis Cascade Index", &shadowSettings.cascadeVisIndex,
                              0, shadowSettings.numberCascades - 1);
+
+            ImGui::Checkbox("Stabilize Cascades", &shadowSettings.stabilizeCascades);
+
+            ImGui::Checkbox("Cache Static Shadows", &shadowSettings.cacheStaticShadows);
+
+            ImGui::SliderFloat("Cache Margin", &shadowSettings.cacheMargin, 0.0f, 1.0f);
+
+            ImGui::SliderInt("First Far Cascade", &shadowSettings.firstFarCascade, 0,
+                             MAX_CASCADES);
+
+            ImGui::SliderInt("Far Cascade Interval", &shadowSettings.farCascadeInterval, 1, 16);
         }
         ImGui::Unindent();
     }
@@ -132,6 +143,11 @@ void Scene::registerSceneImgui(RenderContext& renderContext) {
 
     if(ImGui::CollapsingHeader("Lighting Controls")) {
         ImGui::Checkbox("Point Lights", &renderContext.imguiData.pointLights);
+        ImGui::Checkbox("Tiled Point Lights", &renderContext.imguiData.tiledLighting);
+        ImGui::Checkbox("Light Budget", &renderContext.imguiData.lightBudget);
+        if(renderContext.imguiData.lightBudget) {
+            ImGui::SliderInt("Max Lights", &renderContext.imguiData.maxLights, 1, 1024);
+        }
         ImGui::Checkbox("Shadows", &renderContext.imguiData.shadows);
         ImGui::Checkbox("Automatic IBL Factor", &renderContext.imguiData.autoIbl);
         ImGui::SliderFloat("IBL factor", &renderContext.imguiData.iblFactor,
@@ -176,54 +192,13 @@ void Scene::registerWinDialog() {
     ImGui::End();
 }
 
-EntityId Scene::addEntity() {
-    if(freeEntities.empty()) {
-        entities.emplace_back();
-        return static_cast<EntityId>(entities.size() - 1);
-    }
-    EntityId id = freeEntities.back();
-    freeEntities.pop_back();
-    entities[id] = {true, ComponentMask()};
-    return id;
-}
-
-bool Scene::removeEntity(EntityId id) {
-    if(entities.size() <= id || !entities[id].active) {
-        return false;
-    }
-
-    entities[id] = {false, ComponentMask()};
-    freeEntities.push_back(id);
-
-    return true;
-}
-
-std::vector<Entity>& Scene::getEntities() {
-    return entities;
-}
-
 void Scene::doPhysicsUpdate(uint64_t deltaMillis) {
     float timeStep           = static_cast<float>(deltaMillis) / 1000.0f;
     int32 velocityIterations = 6;
     int32 positionIterations = 2;
     m_World.Step(timeStep, velocityIterations, positionIterations);
-    for(EntityId id : SceneView<Transformation, PhysicsComponent>(*this)) {
-        auto* physicsComponent = getComponent<PhysicsComponent>(id);
-        if(physicsComponent->dynamic) {
-            auto* transform = getComponent<Transformation>(id);
-
-            b2Vec2 newPos = physicsComponent->body->GetPosition();
-
-            if(newPos.x != transform->translation.x
-               || newPos.y != transform->translation.y
-               || physicsComponent->body->GetAngle() != transform->rotation.z) {
-                transform->translation =
-                    glm::vec3(newPos.x, newPos.y, transform->translation.z);
-                transform->rotation.z = physicsComponent->body->GetAngle();
-                transform->hasChanged = true;
-            }
-        }
-    }
+
+    syncPhysicsTransformations(*this, m_ThreadPool);
 }
 
 void Scene::handleUserInput() {
@@ -236,47 +211,53 @@ void Scene::handleUserInput() {
 
     float speed = 10;
 
-    for(auto id : SceneView<PlayerComponent, PhysicsComponent>(*this)) {
-        auto* physicsComponent = getComponent<PhysicsComponent>(id);
-        auto* playerComponent  = getComponent<PlayerComponent>(id);
-
-        float notMovingEps = 1e-4;
+    SceneView<PlayerComponent, PhysicsComponent>(*this).each(
+        [&](EntityId id, PlayerComponent& playerComponent, PhysicsComponent& physicsComponent) {
+            b2Vec2 linVel = physicsComponent.body->GetLinearVelocity();
+
+            bool jumps = false;
+            if(wantsToJump) {
+                if(playerComponent.grounded) {
+                    jumps = true;
+                } else if(playerComponent.canDoubleJump) {
+                    jumps                         = true;
+                    playerComponent.canDoubleJump = false;
+                }
+            }
 
-        b2Vec2 linVel = physicsComponent->body->GetLinearVelocity();
+            b2Vec2 newVel;
+            newVel.x = movingRight ? speed : movingLeft ? -speed : 0;
 
-        bool jumps = false;
-        if(wantsToJump) {
-            if(playerComponent->grounded) {
-                jumps = true;
-            } else if(playerComponent->canDoubleJump) {
-                jumps                          = true;
-                playerComponent->canDoubleJump = false;
+            newVel.y = linVel.y;
+            if(jumps) {
+                newVel.y                 = 20;
+                playerComponent.grounded = false;
             }
-        }
-
-        b2Vec2 newVel;
-        newVel.x = movingRight ? speed : movingLeft ? -speed : 0;
 
-        newVel.y = linVel.y;
-        if(jumps) {
-            newVel.y                  = 20;
-            playerComponent->grounded = false;
-        }
+            physicsComponent.body->SetLinearVelocity(newVel);
+        });
+}
+ThreadPool& Scene::getThreadPool() {
+    return m_ThreadPool;
+}
 
-        physicsComponent->body->SetLinearVelocity(newVel);
-    }
+SystemScheduler& Scene::getScheduler() {
+    return m_Scheduler;
 }
+
 void Scene::setInputController(InputController* inputController) {
     m_InputController = inputController;
 }
 
 void Scene::doCameraUpdate(RenderContext& renderContext) {
     for(auto id : SceneView<PlayerComponent, Transformation>(*this)) {
-        auto* transformation = getComponent<Transformation>(id);
+        // the matrix instead of the translation, the physics can move the
+        // player while the camera follows it
+        glm::vec3 position = getComponent<Transformation>(id)->getTransformationMatrix()[3];
 
         if(renderContext.imguiData.autoIbl) {
             // TODO: should remove, this is only for presentation purposes
-            float       posX            = transformation->translation.x;
+            float       posX            = position.x;
             const float LOWER_THRESHOLD = 90.0f;
             const float UPPER_THRESHOLD = 195.0f;
 
@@ -297,11 +278,10 @@ void Scene::doCameraUpdate(RenderContext& renderContext) {
         if(renderContext.imguiData.lockCamera) {
             auto prevPos = m_Camera.getWorldPos();
 
-            m_Camera.setPosition(glm::vec3(transformation->translation.x,
-                                           transformation->translation.y + renderContext.imguiData.yOffset,
+            m_Camera.setPosition(glm::vec3(position.x,
+                                           position.y + renderContext.imguiData.yOffset,
                                            prevPos.z));
-            m_Camera.setLookAt(glm::vec3(transformation->translation.x,
-                                         transformation->translation.y + cameraOffsetY, 0));
+            m_Camera.setLookAt(glm::vec3(position.x, position.y + cameraOffsetY, 0));
         }
     }
 }
@@ -310,45 +290,43 @@ LevelData& Scene::getLevelData() {
     return levelData;
 }
 void Scene::doGameplayUpdate() {
-    for(auto id : SceneView<PlayerComponent, Transformation, PhysicsComponent>(*this)) {
-        auto* playerComponent  = getComponent<PlayerComponent>(id);
-        auto* transformation   = getComponent<Transformation>(id);
-        auto* physicsComponent = getComponent<PhysicsComponent>(id);
-
-        bool died = false;
+    SceneView<PlayerComponent, Transformation, PhysicsComponent>(*this).each(
+        [this](EntityId id, PlayerComponent& playerComponent,
+               Transformation& transformation, PhysicsComponent& physicsComponent) {
+            bool died = false;
 
-        if(!levelData.disableDeath) {
-            if(transformation->translation.y <= levelData.deathPlaneHeight) {
-                std::cout << "Died to death plane" << std::endl;
+            if(!levelData.disableDeath) {
+                if(transformation.translation.y <= levelData.deathPlaneHeight) {
+                    std::cout << "Died to death plane" << std::endl;
 
-                died = true;
-            }
+                    died = true;
+                }
 
-            if(playerComponent->touchesHazard) {
-                std::cout << "Died to Hazard" << std::endl;
+                if(playerComponent.touchesHazard) {
+                    std::cout << "Died to Hazard" << std::endl;
 
-                playerComponent->touchesHazard = false;
-                died                           = true;
+                    playerComponent.touchesHazard = false;
+                    died                          = true;
+                }
+            } else {
+                playerComponent.touchesHazard = false;
             }
-        } else {
-            playerComponent->touchesHazard = false;
-        }
 
-        if(died) {
-            transformation->translation = levelData.playerSpawnLocation;
-            transformation->hasChanged  = true;
-            physicsComponent->body->SetTransform(
-                b2Vec2(levelData.playerSpawnLocation.x,
-                       levelData.playerSpawnLocation.y),
-                physicsComponent->body->GetAngle());
+            if(died) {
+                transformation.translation = levelData.playerSpawnLocation;
+                markTransformationChanged(id, transformation);
+                physicsComponent.body->SetTransform(
+                    b2Vec2(levelData.playerSpawnLocation.x,
+                           levelData.playerSpawnLocation.y),
+                    physicsComponent.body->GetAngle());
 
-            playerComponent->touchesWin = false;
-        }
+                playerComponent.touchesWin = false;
+            }
 
-        if(playerComponent->touchesWin) {
-            levelData.hasWon = true;
-        }
-    }
+            if(playerComponent.touchesWin) {
+                levelData.hasWon = true;
+            }
+        });
 }
 bool Scene::gameplayActive() {
     return !levelData.hasWon;
@@ -359,20 +337,18 @@ void Scene::resetLevel() {
     resetPlayer();
 }
 void Scene::resetPlayer() {
-    for(auto id : SceneView<PlayerComponent, Transformation, PhysicsComponent>(*this)) {
-        auto* playerComponent  = getComponent<PlayerComponent>(id);
-        auto* transformation   = getComponent<Transformation>(id);
-        auto* physicsComponent = getComponent<PhysicsComponent>(id);
-
-        *playerComponent = PlayerComponent();
-
-        transformation->translation = levelData.playerSpawnLocation;
-        transformation->hasChanged  = true;
-        physicsComponent->body->SetTransform(
-            b2Vec2(levelData.playerSpawnLocation.x,
-                   levelData.playerSpawnLocation.y),
-            physicsComponent->body->GetAngle());
+    SceneView<PlayerComponent, Transformation, PhysicsComponent>(*this).each(
+        [this](EntityId id, PlayerComponent& playerComponent,
+               Transformation& transformation, PhysicsComponent& physicsComponent) {
+            playerComponent = PlayerComponent();
+
+            transformation.translation = levelData.playerSpawnLocation;
+            markTransformationChanged(id, transformation);
+            physicsComponent.body->SetTransform(
+                b2Vec2(levelData.playerSpawnLocation.x,
+                       levelData.playerSpawnLocation.y),
+                physicsComponent.body->GetAngle());
 
-        playerComponent->touchesWin = false;
-    }
+            playerComponent.touchesWin = false;
+        });
 }
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "Model.h"
+#include "GeometryPool.h"
 #include "rendering/host_device.h"
 
 typedef struct {
@@ -12,6 +13,12 @@ typedef struct {
     std::vector<Material>      materials;
     std::vector<Model>         models;
     std::vector<PointLight>    lights;
+    // incremented whenever lights is changed, so the renderer only rebuilds
+    // the culling bounds of the lights if needed
+    uint32_t lightsVersion = 0;
+
+    // vertex and index buffers of all meshes (including pointLightMesh)
+    GeometryPool geometryPool;
 
     // used for Image Based Lighting
     CubeMap skybox;
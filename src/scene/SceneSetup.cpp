@@ -34,7 +34,8 @@ void createSamplePhysicsScene(const ApplicationVulkanContext& context,
         ModelLoader loader;
         std::cout << "Loading Level (this can take some time, be patient)\n";
         loader.loadModel("res/assets/models/levels/level_0.gltf",
-                         scene.getModelLoadingOffsets(), context.baseContext,
+                         scene.getModelLoadingOffsets(),
+                         scene.getSceneData().geometryPool, context.baseContext,
                          context.commandContext);
 
         addToScene(scene, loader, contactListener);
@@ -44,7 +45,8 @@ void createSamplePhysicsScene(const ApplicationVulkanContext& context,
     {
         ModelLoader loader;
         loader.loadModel("res/assets/models/pointlight_model/pointlight_model.gltf",
-                         scene.getModelLoadingOffsets(), context.baseContext,
+                         scene.getModelLoadingOffsets(),
+                         scene.getSceneData().geometryPool, context.baseContext,
                          context.commandContext);
         scene.getSceneData().pointLightMesh = loader.meshes[0];
     }
@@ -68,18 +70,28 @@ void addToScene(Scene&                          scene,
                             loader.models.end());
     sceneData.lights.insert(sceneData.lights.end(), loader.lights.begin(),
                             loader.lights.end());
+    sceneData.lightsVersion++;
 
-    for(ModelInstance& instance : loader.instances) {
-        EntityId entityId = scene.addEntity();
+    std::vector<EntityId> instanceEntities =
+        scene.createEntities<ModelComponent, Transformation, BoundsComponent>(
+            loader.instances.size());
 
-        auto* modelComponent       = scene.assign<ModelComponent>(entityId);
+    for(size_t i = 0; i < loader.instances.size(); i++) {
+        ModelInstance& instance = loader.instances[i];
+        EntityId       entityId = instanceEntities[i];
+
+        auto* modelComponent       = scene.getComponent<ModelComponent>(entityId);
         modelComponent->modelIndex = instance.modelID;
 
-        auto* transformationComponent = scene.assign<Transformation>(entityId);
+        // world bounds follow with the first updateTransformations()
+        auto* boundsComponent  = scene.getComponent<BoundsComponent>(entityId);
+        boundsComponent->local = sceneData.models[instance.modelID].bounds;
+
+        auto* transformationComponent = scene.getComponent<Transformation>(entityId);
         transformationComponent->translation = instance.translation;
         transformationComponent->rotation    = instance.rotation;
         transformationComponent->scaling     = instance.scaling;
-        transformationComponent->hasChanged  = true;
+        scene.markTransformationChanged(entityId, *transformationComponent);
 
 
         const std::string PhysicsNamePrefix = "Static";
@@ -111,8 +123,8 @@ void addToScene(Scene&                          scene,
         if(instance.name.rfind(playerNamePrefix, 0) == 0) {
             auto* fixture = addPhysicsComponent(scene, entityId, instance, true);
 
-            auto* playerComponent = scene.assign<PlayerComponent>(entityId);
-            contactListener.setPlayerComponent(playerComponent);
+            scene.assign<PlayerComponent>(entityId);
+            contactListener.setPlayerEntity(&scene, entityId);
             contactListener.setPlayerFixture(fixture);
 
             levelData.playerSpawnLocation =
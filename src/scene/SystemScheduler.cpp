@@ -0,0 +1,63 @@
+#include "SystemScheduler.h"
+#include <atomic>
+#include <memory>
+
+SystemScheduler::SystemScheduler(ThreadPool& threadPool)
+    : m_ThreadPool(threadPool) {}
+
+void SystemScheduler::addSystem(std::string name, SystemAccess access, std::function<void()> run) {
+    systems.push_back({std::move(name), access, std::move(run)});
+}
+
+void SystemScheduler::run() {
+    size_t systemCount = systems.size();
+
+    // edge i -> j if system j has to wait for system i
+    std::vector<std::vector<size_t>> successors(systemCount);
+    std::unique_ptr<std::atomic<int>[]> remainingDependencies(new std::atomic<int>[systemCount]);
+
+    for(size_t j = 0; j < systemCount; j++) {
+        remainingDependencies[j] = 0;
+        for(size_t i = 0; i < j; i++) {
+            if(systems[i].access.conflictsWith(systems[j].access)) {
+                successors[i].push_back(j);
+                remainingDependencies[j]++;
+            }
+        }
+    }
+
+    std::atomic<size_t> finishedSystems{0};
+
+    std::function<void(size_t)> launch = [&](size_t index) {
+        m_ThreadPool.submit([&, index]() {
+            systems[index].run();
+
+            for(size_t successor : successors[index]) {
+                if(--remainingDependencies[successor] == 0) {
+                    launch(successor);
+                }
+            }
+            finishedSystems++;
+        });
+    };
+
+    // collect the roots before launching anything, running systems already
+    // decrement the counters of their successors
+    std::vector<size_t> roots;
+    for(size_t i = 0; i < systemCount; i++) {
+        if(remainingDependencies[i] == 0) {
+            roots.push_back(i);
+        }
+    }
+    for(size_t root : roots) {
+        launch(root);
+    }
+
+    while(finishedSystems < systemCount) {
+        if(!m_ThreadPool.runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+
+    systems.clear();
+}
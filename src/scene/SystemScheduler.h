@@ -0,0 +1,67 @@
+#ifndef GRAPHICSPRAKTIKUM_SYSTEMSCHEDULER_H
+#define GRAPHICSPRAKTIKUM_SYSTEMSCHEDULER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "Entity.h"
+#include "utils/ThreadPool.h"
+
+// state outside of the ECS that systems can access, needed so the scheduler
+// also orders systems that share e.g. the box2d world
+typedef uint32_t ResourceMask;
+
+const ResourceMask PHYSICS_WORLD_RESOURCE  = 0x01;
+const ResourceMask CAMERA_RESOURCE         = 0x02;
+const ResourceMask LEVEL_DATA_RESOURCE     = 0x04;
+const ResourceMask RENDER_CONTEXT_RESOURCE = 0x08;
+const ResourceMask INPUT_RESOURCE          = 0x10;
+
+// Which components and resources a system reads and writes. Only component
+// data counts, which entities have a component only changes when the command
+// buffer is played back between the runs. The same goes for the matrices of a
+// Transformation and the world bounds, they are only recalculated by
+// updateTransformations(), so a write of Transformation means translation,
+// rotation or scaling.
+struct SystemAccess
+{
+    ComponentMask componentReads;
+    ComponentMask componentWrites;
+    ResourceMask  resourceReads  = 0;
+    ResourceMask  resourceWrites = 0;
+
+    // two systems conflict if one of them writes something the other accesses
+    bool conflictsWith(const SystemAccess& other) const {
+        return (componentWrites & (other.componentReads | other.componentWrites)).any()
+               || (other.componentWrites & componentReads).any()
+               || (resourceWrites & (other.resourceReads | other.resourceWrites)) != 0
+               || (other.resourceWrites & resourceReads) != 0;
+    }
+};
+
+// Runs systems on the thread pool. Systems that conflict are executed in the
+// order they were added, all others can run at the same time.
+class SystemScheduler
+{
+  private:
+    struct System
+    {
+        std::string           name;
+        SystemAccess          access;
+        std::function<void()> run;
+    };
+
+    ThreadPool&         m_ThreadPool;
+    std::vector<System> systems;
+
+  public:
+    explicit SystemScheduler(ThreadPool& threadPool);
+
+    void addSystem(std::string name, SystemAccess access, std::function<void()> run);
+
+    // builds the dependency graph of all added systems, executes them and
+    // removes them afterwards, returns once every system finished
+    void run();
+};
+
+#endif  // GRAPHICSPRAKTIKUM_SYSTEMSCHEDULER_H
@@ -0,0 +1,286 @@
+#include "TransformBatch.h"
+#include <cmath>
+
+#if defined(TRANSFORM_SIMD_AVX2) || defined(TRANSFORM_SIMD_SSE4)
+#include <immintrin.h>
+#endif
+
+void TransformBatch::resize(size_t count) {
+    for(auto* values : {&translationX, &translationY, &translationZ, &rotationX, &rotationY,
+                        &rotationZ, &scalingX, &scalingY, &scalingZ}) {
+        values->resize(count);
+    }
+    transformations.resize(count);
+    normalsTransformations.resize(count);
+}
+
+void TransformBatch::set(size_t index, const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scaling) {
+    translationX[index] = translation.x;
+    translationY[index] = translation.y;
+    translationZ[index] = translation.z;
+    rotationX[index]    = rotation.x;
+    rotationY[index]    = rotation.y;
+    rotationZ[index]    = rotation.z;
+    scalingX[index]     = scaling.x;
+    scalingY[index]     = scaling.y;
+    scalingZ[index]     = scaling.z;
+}
+
+// The rotation matrix of glm::eulerAngleXYZ(x, y, z) is Rx * Ry * Rz, with
+// c1/s1 = cos/sin of x, c2/s2 of y and c3/s3 of z its rows are
+//   | c2c3              -c2s3              s2    |
+//   | c1s3 + s1s2c3      c1c3 - s1s2s3    -s1c2  |
+//   | s1s3 - c1s2c3      s1c3 + c1s2s3     c1c2  |
+// For M = T * R * S the upper 3x3 of the inverse transpose is R * S^-1 and its
+// bottom row is -(R^T * t) / s, since the inverse of R is its transpose.
+// The results are column major like glm, indexed [column][row].
+template <typename T, typename Ops>
+static void composeMatrices(T c1, T s1, T c2, T s2, T c3, T s3, const T t[3], const T s[3],
+                            T (&transformation)[4][4], T (&normalsTransformation)[4][4]) {
+    T r[3][3];
+    r[0][0] = Ops::mul(c2, c3);
+    r[0][1] = Ops::neg(Ops::mul(c2, s3));
+    r[0][2] = s2;
+    r[1][0] = Ops::add(Ops::mul(c1, s3), Ops::mul(Ops::mul(s1, s2), c3));
+    r[1][1] = Ops::sub(Ops::mul(c1, c3), Ops::mul(Ops::mul(s1, s2), s3));
+    r[1][2] = Ops::neg(Ops::mul(s1, c2));
+    r[2][0] = Ops::sub(Ops::mul(s1, s3), Ops::mul(Ops::mul(c1, s2), c3));
+    r[2][1] = Ops::add(Ops::mul(s1, c3), Ops::mul(Ops::mul(c1, s2), s3));
+    r[2][2] = Ops::mul(c1, c2);
+
+    T zero = Ops::set(0.0f);
+    T one  = Ops::set(1.0f);
+
+    for(int column = 0; column < 3; column++) {
+        T inverseScaling = Ops::div(one, s[column]);
+        T translated     = zero;
+
+        for(int row = 0; row < 3; row++) {
+            transformation[column][row] = Ops::mul(r[row][column], s[column]);
+            normalsTransformation[column][row] = Ops::mul(r[row][column], inverseScaling);
+
+            translated = Ops::add(translated, Ops::mul(r[row][column], t[row]));
+        }
+        transformation[column][3]        = zero;
+        normalsTransformation[column][3] = Ops::neg(Ops::mul(translated, inverseScaling));
+    }
+
+    for(int row = 0; row < 3; row++) {
+        transformation[3][row]        = t[row];
+        normalsTransformation[3][row] = zero;
+    }
+    transformation[3][3]        = one;
+    normalsTransformation[3][3] = one;
+}
+
+struct ScalarOps
+{
+    static float set(float value) { return value; }
+    static float add(float a, float b) { return a + b; }
+    static float sub(float a, float b) { return a - b; }
+    static float mul(float a, float b) { return a * b; }
+    static float div(float a, float b) { return a / b; }
+    static float neg(float a) { return -a; }
+};
+
+void composeTransformationsScalar(TransformBatch& batch, size_t begin, size_t end) {
+    float transformation[4][4];
+    float normalsTransformation[4][4];
+
+    for(size_t i = begin; i < end; i++) {
+        float t[3] = {batch.translationX[i], batch.translationY[i], batch.translationZ[i]};
+        float s[3] = {batch.scalingX[i], batch.scalingY[i], batch.scalingZ[i]};
+
+        composeMatrices<float, ScalarOps>(
+            std::cos(batch.rotationX[i]), std::sin(batch.rotationX[i]),
+            std::cos(batch.rotationY[i]), std::sin(batch.rotationY[i]),
+            std::cos(batch.rotationZ[i]), std::sin(batch.rotationZ[i]), t, s,
+            transformation, normalsTransformation);
+
+        for(int column = 0; column < 4; column++) {
+            for(int row = 0; row < 4; row++) {
+                batch.transformations[i][column][row]        = transformation[column][row];
+                batch.normalsTransformations[i][column][row] = normalsTransformation[column][row];
+            }
+        }
+    }
+}
+
+#if defined(TRANSFORM_SIMD_AVX2) || defined(TRANSFORM_SIMD_SSE4)
+
+#if defined(TRANSFORM_SIMD_AVX2)
+struct SimdOps
+{
+    using Float = __m256;
+    using Int   = __m256i;
+
+    static constexpr size_t width = 8;
+
+    static Float load(const float* values) { return _mm256_loadu_ps(values); }
+    static void  store(float* values, Float a) { _mm256_storeu_ps(values, a); }
+    static Float set(float value) { return _mm256_set1_ps(value); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+    static Float neg(Float a) { return _mm256_xor_ps(a, set(-0.0f)); }
+    static Float bitAnd(Float a, Float b) { return _mm256_and_ps(a, b); }
+    static Float bitXor(Float a, Float b) { return _mm256_xor_ps(a, b); }
+    // takes b where the mask is set, a otherwise
+    static Float select(Float a, Float b, Float mask) { return _mm256_blendv_ps(a, b, mask); }
+
+    static Int   toInt(Float a) { return _mm256_cvttps_epi32(a); }
+    static Float toFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+    static Float asFloat(Int a) { return _mm256_castsi256_ps(a); }
+    static Int   setInt(int value) { return _mm256_set1_epi32(value); }
+    static Int   addInt(Int a, Int b) { return _mm256_add_epi32(a, b); }
+    static Int   subInt(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+    static Int   andInt(Int a, Int b) { return _mm256_and_si256(a, b); }
+    static Int   andNotInt(Int a, Int b) { return _mm256_andnot_si256(a, b); }
+    static Int   shiftToSignBit(Int a) { return _mm256_slli_epi32(a, 29); }
+    static Int   equalInt(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+};
+#else
+struct SimdOps
+{
+    using Float = __m128;
+    using Int   = __m128i;
+
+    static constexpr size_t width = 4;
+
+    static Float load(const float* values) { return _mm_loadu_ps(values); }
+    static void  store(float* values, Float a) { _mm_storeu_ps(values, a); }
+    static Float set(float value) { return _mm_set1_ps(value); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+    static Float neg(Float a) { return _mm_xor_ps(a, set(-0.0f)); }
+    static Float bitAnd(Float a, Float b) { return _mm_and_ps(a, b); }
+    static Float bitXor(Float a, Float b) { return _mm_xor_ps(a, b); }
+    // takes b where the mask is set, a otherwise
+    static Float select(Float a, Float b, Float mask) { return _mm_blendv_ps(a, b, mask); }
+
+    static Int   toInt(Float a) { return _mm_cvttps_epi32(a); }
+    static Float toFloat(Int a) { return _mm_cvtepi32_ps(a); }
+    static Float asFloat(Int a) { return _mm_castsi128_ps(a); }
+    static Int   setInt(int value) { return _mm_set1_epi32(value); }
+    static Int   addInt(Int a, Int b) { return _mm_add_epi32(a, b); }
+    static Int   subInt(Int a, Int b) { return _mm_sub_epi32(a, b); }
+    static Int   andInt(Int a, Int b) { return _mm_and_si128(a, b); }
+    static Int   andNotInt(Int a, Int b) { return _mm_andnot_si128(a, b); }
+    static Int   shiftToSignBit(Int a) { return _mm_slli_epi32(a, 29); }
+    static Int   equalInt(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+};
+#endif
+
+// sine and cosine with the range reduction and minimax polynomials of the
+// Cephes library (see also sse_mathfun.h by Julien Pommier), accurate to
+// about 1e-7 for |x| < 8192
+static void sinCos(SimdOps::Float x, SimdOps::Float& sine, SimdOps::Float& cosine) {
+    using Ops   = SimdOps;
+    using Float = Ops::Float;
+    using Int   = Ops::Int;
+
+    Float signMask = Ops::set(-0.0f);
+    Float sinSign  = Ops::bitAnd(x, signMask);
+    x              = Ops::bitXor(x, sinSign);
+
+    // octant of x, rounded up to an even number
+    Int   octant = Ops::toInt(Ops::mul(x, Ops::set(1.27323954473516f)));
+    octant       = Ops::andInt(Ops::addInt(octant, Ops::setInt(1)), Ops::setInt(~1));
+    Float y      = Ops::toFloat(octant);
+
+    sinSign = Ops::bitXor(sinSign, Ops::asFloat(Ops::shiftToSignBit(Ops::andInt(octant, Ops::setInt(4)))));
+    Float cosSign = Ops::asFloat(Ops::shiftToSignBit(
+        Ops::andNotInt(Ops::subInt(octant, Ops::setInt(2)), Ops::setInt(4))));
+
+    // the polynomials get swapped for octants 2 and 6
+    Float usePolynomialSwap =
+        Ops::asFloat(Ops::equalInt(Ops::andInt(octant, Ops::setInt(2)), Ops::setInt(0)));
+
+    // extended precision modular arithmetic, x - y * pi / 4
+    x = Ops::sub(x, Ops::mul(y, Ops::set(0.78515625f)));
+    x = Ops::sub(x, Ops::mul(y, Ops::set(2.4187564849853515625e-4f)));
+    x = Ops::sub(x, Ops::mul(y, Ops::set(3.77489497744594108e-8f)));
+
+    Float z = Ops::mul(x, x);
+
+    Float cosPolynomial = Ops::set(2.443315711809948e-5f);
+    cosPolynomial = Ops::add(Ops::mul(cosPolynomial, z), Ops::set(-1.388731625493765e-3f));
+    cosPolynomial = Ops::add(Ops::mul(cosPolynomial, z), Ops::set(4.166664568298827e-2f));
+    cosPolynomial = Ops::mul(Ops::mul(cosPolynomial, z), z);
+    cosPolynomial = Ops::sub(cosPolynomial, Ops::mul(z, Ops::set(0.5f)));
+    cosPolynomial = Ops::add(cosPolynomial, Ops::set(1.0f));
+
+    Float sinPolynomial = Ops::set(-1.9515295891e-4f);
+    sinPolynomial = Ops::add(Ops::mul(sinPolynomial, z), Ops::set(8.3321608736e-3f));
+    sinPolynomial = Ops::add(Ops::mul(sinPolynomial, z), Ops::set(-1.6666654611e-1f));
+    sinPolynomial = Ops::add(Ops::mul(Ops::mul(sinPolynomial, z), x), x);
+
+    sine   = Ops::select(cosPolynomial, sinPolynomial, usePolynomialSwap);
+    cosine = Ops::select(sinPolynomial, cosPolynomial, usePolynomialSwap);
+
+    sine   = Ops::bitXor(sine, sinSign);
+    cosine = Ops::bitXor(cosine, cosSign);
+}
+
+static void composeTransformationsSimd(TransformBatch& batch, size_t begin) {
+    using Ops   = SimdOps;
+    using Float = Ops::Float;
+
+    Float c1, s1, c2, s2, c3, s3;
+    sinCos(Ops::load(&batch.rotationX[begin]), s1, c1);
+    sinCos(Ops::load(&batch.rotationY[begin]), s2, c2);
+    sinCos(Ops::load(&batch.rotationZ[begin]), s3, c3);
+
+    Float t[3] = {Ops::load(&batch.translationX[begin]), Ops::load(&batch.translationY[begin]),
+                  Ops::load(&batch.translationZ[begin])};
+    Float s[3] = {Ops::load(&batch.scalingX[begin]), Ops::load(&batch.scalingY[begin]),
+                  Ops::load(&batch.scalingZ[begin])};
+
+    Float transformationLanes[4][4];
+    Float normalsTransformationLanes[4][4];
+    composeMatrices<Float, Ops>(c1, s1, c2, s2, c3, s3, t, s, transformationLanes,
+                                normalsTransformationLanes);
+
+    // transpose the lanes back into one matrix per transformation
+    alignas(32) float transformations[4][4][Ops::width];
+    alignas(32) float normalsTransformations[4][4][Ops::width];
+    for(int column = 0; column < 4; column++) {
+        for(int row = 0; row < 4; row++) {
+            Ops::store(transformations[column][row], transformationLanes[column][row]);
+            Ops::store(normalsTransformations[column][row], normalsTransformationLanes[column][row]);
+        }
+    }
+
+    for(size_t lane = 0; lane < Ops::width; lane++) {
+        glm::mat4& transformation        = batch.transformations[begin + lane];
+        glm::mat4& normalsTransformation = batch.normalsTransformations[begin + lane];
+
+        for(int column = 0; column < 4; column++) {
+            for(int row = 0; row < 4; row++) {
+                transformation[column][row] = transformations[column][row][lane];
+                normalsTransformation[column][row] = normalsTransformations[column][row][lane];
+            }
+        }
+    }
+}
+
+void composeTransformations(TransformBatch& batch) {
+    size_t count = batch.size();
+    size_t begin = 0;
+
+    for(; begin + SimdOps::width <= count; begin += SimdOps::width) {
+        composeTransformationsSimd(batch, begin);
+    }
+    composeTransformationsScalar(batch, begin, count);
+}
+
+#else
+
+void composeTransformations(TransformBatch& batch) {
+    composeTransformationsScalar(batch, 0, batch.size());
+}
+
+#endif
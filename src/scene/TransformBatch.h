@@ -0,0 +1,39 @@
+#ifndef GRAPHICSPRAKTIKUM_TRANSFORMBATCH_H
+#define GRAPHICSPRAKTIKUM_TRANSFORMBATCH_H
+
+#include <vector>
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+
+// Translation, rotation (euler XYZ) and scaling of many transformations stored
+// as structure of arrays, so they can be composed several at a time.
+struct TransformBatch
+{
+    std::vector<float> translationX, translationY, translationZ;
+    std::vector<float> rotationX, rotationY, rotationZ;
+    std::vector<float> scalingX, scalingY, scalingZ;
+
+    // results of composeTransformations()
+    std::vector<glm::mat4> transformations;
+    // transpose inverse of transformations
+    std::vector<glm::mat4> normalsTransformations;
+
+    void resize(size_t count);
+
+    size_t size() const { return translationX.size(); }
+
+    void set(size_t index, const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scaling);
+};
+
+// Computes translate * eulerAngleXYZ * scale and its inverse transpose for all
+// transformations of the batch. Uses AVX2 or SSE4.1 if enabled at compile time
+// (see TRANSFORM_SIMD in CMakeLists.txt). The inverse transpose is built from
+// the rotation and the reciprocal scaling instead of a general 4x4 inverse, so
+// scaling must not be 0.
+void composeTransformations(TransformBatch& batch);
+
+// scalar version of composeTransformations(), used for the remainder that does
+// not fill a whole SIMD register
+void composeTransformationsScalar(TransformBatch& batch, size_t begin, size_t end);
+
+#endif  // GRAPHICSPRAKTIKUM_TRANSFORMBATCH_H
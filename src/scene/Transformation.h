@@ -0,0 +1,42 @@
+#ifndef GRAPHICSPRAKTIKUM_TRANSFORMATION_H
+#define GRAPHICSPRAKTIKUM_TRANSFORMATION_H
+
+#include "glm/ext/matrix_float4x4.hpp"
+#include "glm/ext/matrix_transform.hpp"
+#include "glm/gtc/matrix_inverse.hpp"
+#include <glm/gtx/euler_angles.hpp>
+
+typedef struct transformation_s
+{
+    glm::vec3 translation {glm::vec3(0)};
+    glm::vec3 rotation {glm::vec3(0)};
+    glm::vec3 scaling {glm::vec3(1)};
+
+    // Only recalculated by EntityRegistry::updateTransformations() once per frame.
+    // Code that writes translation, rotation or scaling has to call
+    // EntityRegistry::markTransformationChanged(), which also sets "hasChanged".
+    glm::mat4 transformation {glm::mat4(1)};
+    // transpose inverse of transformation
+    glm::mat4 normalsTransformation{glm::mat4(1)};
+    bool      hasChanged = false;
+
+    const glm::mat4& getTransformationMatrix() const {
+        return transformation;
+    }
+
+    const glm::mat4& getNormalsTransformationMatrix() const {
+        return normalsTransformation;
+    }
+
+    void recalculateMatrices() {
+        glm::mat4 scaleMat = glm::scale(glm::mat4(1), scaling);
+        glm::mat4 rotateMat =
+            glm::eulerAngleXYZ(rotation.x, rotation.y, rotation.z);
+        glm::mat4 translateMat = glm::translate(glm::mat4(1), translation);
+        transformation         = translateMat * rotateMat * scaleMat;
+        normalsTransformation = glm::inverseTranspose(transformation);
+        hasChanged = false;
+    }
+} Transformation;
+
+#endif  // GRAPHICSPRAKTIKUM_TRANSFORMATION_H
@@ -0,0 +1,143 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+// index of the queue owned by the current thread, -1 for non worker threads
+static thread_local int t_workerIndex = -1;
+
+ThreadPool::ThreadPool(uint32_t workerCount) {
+    if(workerCount == 0) {
+        // hardware_concurrency() is 0 if it is not known
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    for(uint32_t i = 0; i < workerCount; i++) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+
+    for(uint32_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    // tasks spawned by a worker stay on its own queue for better locality
+    uint32_t queueIndex = t_workerIndex != -1 ? static_cast<uint32_t>(t_workerIndex)
+                                              : nextQueue++ % queues.size();
+
+    pendingTasks++;
+    {
+        std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+        queues[queueIndex]->tasks.push_back(std::move(task));
+        queuedTasks++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+void ThreadPool::wait() {
+    while(pendingTasks > 0) {
+        if(!runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& fn) {
+    batchSize = std::max<size_t>(1, batchSize);
+    if(count <= batchSize) {
+        if(count > 0) {
+            fn(0, count);
+        }
+        return;
+    }
+
+    std::atomic<size_t> remainingBatches{(count + batchSize - 1) / batchSize};
+
+    for(size_t begin = batchSize; begin < count; begin += batchSize) {
+        size_t end = std::min(begin + batchSize, count);
+        submit([&fn, &remainingBatches, begin, end]() {
+            fn(begin, end);
+            remainingBatches--;
+        });
+    }
+
+    // the calling thread takes the first batch itself
+    fn(0, batchSize);
+    remainingBatches--;
+
+    while(remainingBatches > 0) {
+        if(!runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int ThreadPool::getCurrentWorkerIndex() {
+    return t_workerIndex;
+}
+
+bool ThreadPool::runPendingTask() {
+    uint32_t startIndex = t_workerIndex != -1 ? static_cast<uint32_t>(t_workerIndex) : 0;
+
+    std::function<void()> task;
+    for(uint32_t i = 0; i < queues.size(); i++) {
+        if(popTask((startIndex + i) % queues.size(), task)) {
+            task();
+            pendingTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(uint32_t workerIndex) {
+    t_workerIndex = static_cast<int>(workerIndex);
+
+    while(true) {
+        if(runPendingTask()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]() { return stopping || queuedTasks > 0; });
+        if(stopping) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::popTask(uint32_t queueIndex, std::function<void()>& task) {
+    TaskQueue&                  queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if(queue.tasks.empty()) {
+        return false;
+    }
+
+    // owners work LIFO on their own queue, thieves take the oldest task
+    if(t_workerIndex == static_cast<int>(queueIndex)) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+    } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+    }
+    queuedTasks--;
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef GRAPHICSPRAKTIKUM_THREADPOOL_H
+#define GRAPHICSPRAKTIKUM_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work stealing thread pool. Every worker has its own task queue, workers take
+// new tasks from the back of their own queue and steal from the front of the
+// queues of other workers once theirs is empty. Threads that wait for tasks
+// (wait() or parallelFor()) help executing tasks instead of blocking.
+class ThreadPool
+{
+  private:
+    struct TaskQueue
+    {
+        std::mutex                        mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread>                workers;
+
+    // submitted but not yet finished tasks
+    std::atomic<size_t>   pendingTasks{0};
+    // tasks that still sit in one of the queues
+    std::atomic<size_t>   queuedTasks{0};
+    std::atomic<uint32_t> nextQueue{0};
+    std::atomic<bool>     stopping{false};
+
+    std::mutex              wakeMutex;
+    std::condition_variable wakeCondition;
+
+  public:
+    // 0 uses one worker per hardware thread except the calling one
+    explicit ThreadPool(uint32_t workerCount = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // executes tasks on the calling thread until all submitted tasks finished
+    void wait();
+
+    // Splits [0, count) into batches of at most batchSize elements and calls
+    // fn(begin, end) for each of them in parallel, returns once all batches
+    // are done. Small ranges are executed directly on the calling thread.
+    void parallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& fn);
+
+    uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    // index of the worker the calling thread is, -1 if it is no worker
+    static int getCurrentWorkerIndex();
+
+    // runs one task if there is any, returns false otherwise
+    bool runPendingTask();
+
+  private:
+    void workerLoop(uint32_t workerIndex);
+
+    bool popTask(uint32_t queueIndex, std::function<void()>& task);
+};
+
+#endif  // GRAPHICSPRAKTIKUM_THREADPOOL_H
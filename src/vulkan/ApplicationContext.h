@@ -19,6 +19,20 @@ typedef struct {
 
     uint32_t maxSupportedMinorVersion = 0;
     float    maxSamplerAnisotropy;
+
+    // drawIndirectCount and multiDrawIndirect are enabled, needed for the
+    // culling on the GPU
+    bool supportsIndirectCount = false;
+
+    // multiview or shaderOutputLayer is enabled, the shadow pass needs one of
+    // them to draw all cascades in a single pass
+    bool supportsMultiview         = false;
+    bool supportsShaderOutputLayer = false;
+
+    // nanoseconds per timestamp tick and the valid bits of the timestamps
+    // written on the graphics queue, no valid bits if it has no timestamps
+    float    timestampPeriod    = 0;
+    uint32_t timestampValidBits = 0;
 } VulkanBaseContext;
 
 typedef struct {
@@ -43,9 +57,10 @@ typedef struct {
     // @IMGUI
     VkDescriptorPool imGuiDescriptorPool = VK_NULL_HANDLE;
 
-    // TODO might want a vector of commandBuffers here later, so we can record
-    // another one while the previous frame is still rendering, that way we can
-    // have multiple frames in flight
+    // one command buffer per frame in flight, so a frame can be recorded while
+    // the previous ones are still rendering
+    VkCommandBuffer commandBuffers[MAX_FRAMES_IN_FLIGHT];
+    // the command buffer of the frame that is being recorded
     VkCommandBuffer commandBuffer;
 } CommandContext;
 
@@ -53,6 +68,10 @@ typedef struct {
     bool useMsaa = false;
     VkSampleCountFlagBits maxMsaaSamples = VK_SAMPLE_COUNT_1_BIT;
     VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // number of frames the CPU may record ahead of the GPU, between 1 and
+    // MAX_FRAMES_IN_FLIGHT, can only be set before initializeGraphicsApplication()
+    uint32_t framesInFlight = 2;
 } GraphicSettings;
 
 typedef struct {
@@ -0,0 +1,179 @@
+#include "GpuProfiler.h"
+#include <algorithm>
+#include <stdexcept>
+
+void GpuProfiler::create(const VulkanBaseContext& baseContext, uint32_t framesInFlight) {
+    device          = baseContext.device;
+    supported       = baseContext.timestampValidBits > 0 && baseContext.timestampPeriod > 0;
+    timestampPeriod = baseContext.timestampPeriod;
+    timestampMask   = baseContext.timestampValidBits >= 64
+                          ? UINT64_MAX
+                          : (1ull << baseContext.timestampValidBits) - 1;
+
+    if(!supported) {
+        return;
+    }
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = GPU_PROFILER_MAX_QUERIES;
+
+    for(uint32_t frame = 0; frame < framesInFlight; frame++) {
+        if(vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPools[frame]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+    }
+}
+
+void GpuProfiler::clean() {
+    for(VkQueryPool& queryPool : queryPools) {
+        if(queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device, queryPool, nullptr);
+            queryPool = VK_NULL_HANDLE;
+        }
+    }
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frame) {
+    if(!supported) {
+        return;
+    }
+
+    currentFrame = frame;
+    openScopes.clear();
+
+    std::vector<RecordedScope>& scopes     = recordedScopes[frame];
+    uint32_t                    queryCount = usedQueries[frame];
+
+    // no wait flag, the fence of the frame was signaled so the queries are
+    // available unless a scope was not ended
+    timestamps.resize(queryCount);
+    VkResult result = VK_NOT_READY;
+    if(queryCount > 0) {
+        result = vkGetQueryPoolResults(device, queryPools[frame], 0, queryCount,
+                                       queryCount * sizeof(uint64_t), timestamps.data(),
+                                       sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    }
+
+    if(result == VK_SUCCESS) {
+        scopeTimes.clear();
+        std::vector<uint64_t> viewTicks;
+        for(const RecordedScope& scope : scopes) {
+            // the views the implementation did not write are zero, so the sum
+            // is the time of the scope either way
+            uint64_t ticks         = 0;
+            bool     viewsMeasured = false;
+            viewTicks.resize(scope.viewCount);
+            for(uint32_t view = 0; view < scope.viewCount; view++) {
+                uint64_t begin  = timestamps[scope.firstQuery + view];
+                uint64_t end    = timestamps[scope.firstQuery + scope.viewCount + view];
+                viewTicks[view] = (end - begin) & timestampMask;
+                ticks += viewTicks[view];
+                if(view > 0 && (begin != 0 || end != 0)) {
+                    viewsMeasured = true;
+                }
+            }
+
+            addSample(scope.history, ticks);
+            if(viewsMeasured) {
+                for(uint32_t view = 0; view < scope.viewCount; view++) {
+                    addSample(scope.viewHistories[view], viewTicks[view]);
+                }
+            }
+        }
+    }
+
+    scopes.clear();
+    usedQueries[frame] = 0;
+    vkCmdResetQueryPool(commandBuffer, queryPools[frame], 0, GPU_PROFILER_MAX_QUERIES);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name) {
+    beginViewScope(commandBuffer, name, "", 1);
+}
+
+void GpuProfiler::beginViewScope(VkCommandBuffer    commandBuffer,
+                                 const std::string& name,
+                                 const std::string& viewName,
+                                 uint32_t           viewCount) {
+    if(!supported) {
+        return;
+    }
+
+    std::vector<RecordedScope>& scopes  = recordedScopes[currentFrame];
+    uint32_t&                   queries = usedQueries[currentFrame];
+    if(queries + 2 * viewCount > GPU_PROFILER_MAX_QUERIES) {
+        openScopes.push_back(NOT_MEASURED);
+        return;
+    }
+
+    auto depth = static_cast<uint32_t>(openScopes.size());
+
+    RecordedScope scope;
+    scope.history    = findHistory(name, depth);
+    scope.firstQuery = queries;
+    scope.viewCount  = viewCount;
+    if(viewCount > 1) {
+        for(uint32_t view = 0; view < viewCount; view++) {
+            scope.viewHistories.push_back(
+                findHistory(viewName + " " + std::to_string(view), depth + 1));
+        }
+    }
+
+    openScopes.push_back(static_cast<uint32_t>(scopes.size()));
+    scopes.push_back(scope);
+    queries += 2 * viewCount;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        queryPools[currentFrame], scope.firstQuery);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer) {
+    if(!supported) {
+        return;
+    }
+
+    uint32_t scope = openScopes.back();
+    openScopes.pop_back();
+    if(scope == NOT_MEASURED) {
+        return;
+    }
+
+    const RecordedScope& recordedScope = recordedScopes[currentFrame][scope];
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        queryPools[currentFrame],
+                        recordedScope.firstQuery + recordedScope.viewCount);
+}
+
+uint32_t GpuProfiler::findHistory(const std::string& name, uint32_t depth) {
+    for(size_t i = 0; i < histories.size(); i++) {
+        if(histories[i].name == name && histories[i].depth == depth) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    ScopeHistory history;
+    history.name  = name;
+    history.depth = depth;
+    histories.push_back(history);
+    return static_cast<uint32_t>(histories.size() - 1);
+}
+
+void GpuProfiler::addSample(uint32_t historyIndex, uint64_t ticks) {
+    ScopeHistory& history = histories[historyIndex];
+
+    history.samples[history.nextSample] =
+        static_cast<float>(static_cast<double>(ticks) * timestampPeriod * 1e-6);
+    history.nextSample  = (history.nextSample + 1) % GPU_PROFILER_HISTORY;
+    history.sampleCount = std::min(history.sampleCount + 1, GPU_PROFILER_HISTORY);
+
+    float sum = 0;
+    float max = 0;
+    for(uint32_t i = 0; i < history.sampleCount; i++) {
+        sum += history.samples[i];
+        max = std::max(max, history.samples[i]);
+    }
+    scopeTimes.push_back(
+        {history.name, history.depth, sum / static_cast<float>(history.sampleCount), max});
+}
@@ -0,0 +1,116 @@
+#ifndef GRAPHICSPRAKTIKUM_GPUPROFILER_H
+#define GRAPHICSPRAKTIKUM_GPUPROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+#include "ApplicationContext.h"
+
+// the times of a scope are averaged over the last frames it was measured in
+const uint32_t GPU_PROFILER_HISTORY = 64;
+// queries per frame, a scope takes two of them and two per view inside of a
+// multiview render pass, the scopes that do not fit are not measured
+const uint32_t GPU_PROFILER_MAX_QUERIES = 64;
+
+// Measures the GPU time of nested scopes of a frame with timestamp queries.
+// Every frame in flight has its own query pool whose timestamps are read once
+// the fence of the frame was waited for, so the CPU never waits for them and
+// the times are as many frames late as there are frames in flight.
+class GpuProfiler
+{
+  public:
+    // average and maximum of a scope over its last GPU_PROFILER_HISTORY frames
+    struct ScopeTimes
+    {
+        std::string name;
+        // 0 for the outermost scopes
+        uint32_t depth;
+        float    averageMs;
+        float    maxMs;
+    };
+
+  private:
+    // a scope writes viewCount begin timestamps starting at firstQuery and
+    // viewCount end timestamps after them
+    struct RecordedScope
+    {
+        uint32_t history;
+        uint32_t firstQuery;
+        uint32_t viewCount;
+        // the history of every view if the scope has more than one
+        std::vector<uint32_t> viewHistories;
+    };
+
+    struct ScopeHistory
+    {
+        std::string name;
+        uint32_t    depth;
+        float       samples[GPU_PROFILER_HISTORY] = {};
+        uint32_t    sampleCount = 0;
+        uint32_t    nextSample  = 0;
+    };
+
+    VkDevice device          = VK_NULL_HANDLE;
+    bool     supported       = false;
+    float    timestampPeriod = 0;
+    uint64_t timestampMask   = 0;
+
+    VkQueryPool queryPools[MAX_FRAMES_IN_FLIGHT] = {};
+    // the scopes the frame in flight recorded the last time
+    std::vector<RecordedScope> recordedScopes[MAX_FRAMES_IN_FLIGHT];
+    uint32_t                   usedQueries[MAX_FRAMES_IN_FLIGHT] = {};
+    uint32_t                   currentFrame = 0;
+    // the scopes that were begun but not ended yet, NOT_MEASURED if they did
+    // not fit into the query pool
+    std::vector<uint32_t> openScopes;
+
+    std::vector<ScopeHistory> histories;
+    std::vector<uint64_t>     timestamps;
+    std::vector<ScopeTimes>   scopeTimes;
+
+    static constexpr uint32_t NOT_MEASURED = UINT32_MAX;
+
+  public:
+    // does nothing if the graphics queue has no timestamps
+    void create(const VulkanBaseContext& baseContext, uint32_t framesInFlight);
+
+    void clean();
+
+    bool isSupported() const { return supported; }
+
+    // Reads the timestamps of the last time the frame was recorded, its fence
+    // was waited for, and resets its queries. Has to be recorded outside of a
+    // render pass before the first scope.
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    // Both timestamps wait for the commands before them, so the times of
+    // consecutive scopes add up to the time of the frame.
+    void beginScope(VkCommandBuffer commandBuffer, const std::string& name);
+    void endScope(VkCommandBuffer commandBuffer);
+
+    // A scope inside of a render pass whose view mask has viewCount views,
+    // its timestamps are written into secondary command buffers executed in
+    // the render pass. A timestamp there writes one query per view, either
+    // the time of every view or the time in the first query and zeros in
+    // the others. The views are only added as child scopes named
+    // "<viewName> <view>" if the implementation wrote their times, otherwise
+    // the scope only has the time of all views. A layered render pass without
+    // multiview has a single view, the layers have no own times.
+    void beginViewScope(VkCommandBuffer    commandBuffer,
+                        const std::string& name,
+                        const std::string& viewName,
+                        uint32_t           viewCount);
+
+    // the scopes of the latest frame that was read back in recording order
+    const std::vector<ScopeTimes>& getScopeTimes() const { return scopeTimes; }
+
+  private:
+    // index of the history of the scope, added if it was never measured
+    uint32_t findHistory(const std::string& name, uint32_t depth);
+
+    // adds the time to the history and the average and maximum to scopeTimes
+    void addSample(uint32_t historyIndex, uint64_t ticks);
+};
+
+#endif  // GRAPHICSPRAKTIKUM_GPUPROFILER_H
@@ -1,7 +1,9 @@
 #include <stdexcept>
 #include <array>
+#include <algorithm>
 #include "VulkanRenderer.h"
 #include "VulkanSetup.h"
+#include "VulkanUtils.h"
 
 #include <iostream>
 #include "rendering/RenderContext.h"
@@ -10,17 +12,31 @@
 #include "game/PlayerComponent.h"
 #include "rendering/CSMUtils.h"
 
-VulkanRenderer::VulkanRenderer(ApplicationVulkanContext& context, RenderContext& renderContext)
+VulkanRenderer::VulkanRenderer(ApplicationVulkanContext& context, RenderContext& renderContext,
+                               ThreadPool& threadPool)
     : m_Context(context)
-    , m_RenderContext(renderContext) {
+    , m_RenderContext(renderContext)
+    , m_ThreadPool(threadPool) {
     createSyncObjects(context.baseContext);
+    createRecordingPools();
+    gpuProfiler.create(context.baseContext, context.graphicSettings.framesInFlight);
 }
 
 
 void VulkanRenderer::cleanVulkanRessources() {
-    vkDestroySemaphore(m_Context.baseContext.device, m_ImageAvailableSemaphore, nullptr);
-    vkDestroySemaphore(m_Context.baseContext.device, m_RenderFinishedSemaphore, nullptr);
-    vkDestroyFence(m_Context.baseContext.device, m_InFlightFence, nullptr);
+    for(uint32_t frame = 0; frame < m_Context.graphicSettings.framesInFlight; frame++) {
+        vkDestroySemaphore(m_Context.baseContext.device, m_ImageAvailableSemaphores[frame], nullptr);
+        vkDestroySemaphore(m_Context.baseContext.device, m_RenderFinishedSemaphores[frame], nullptr);
+        vkDestroyFence(m_Context.baseContext.device, m_InFlightFences[frame], nullptr);
+    }
+
+    // destroying a pool frees its command buffers
+    for(RecordingPool& recordingPool : recordingPools) {
+        vkDestroyCommandPool(m_Context.baseContext.device, recordingPool.commandPool, nullptr);
+    }
+    recordingPools.clear();
+
+    gpuProfiler.clean();
 }
 
 void VulkanRenderer::render(Scene& scene) {
@@ -31,18 +47,28 @@ void VulkanRenderer::render(Scene& scene) {
     }
      */
     // reset imgui per frame counters
-    m_RenderContext.imguiData.meshDrawCalls  = 0;
-    m_RenderContext.imguiData.lightDrawCalls = 0;
+    m_RenderContext.imguiData.meshDrawCalls       = 0;
+    m_RenderContext.imguiData.lightDrawCalls      = 0;
     m_RenderContext.imguiData.shadowPassDrawCalls = 0;
-
-    vkWaitForFences(m_Context.baseContext.device, 1, &m_InFlightFence, VK_TRUE, UINT64_MAX);
+    m_RenderContext.imguiData.meshInstances       = 0;
+    m_RenderContext.imguiData.shadowPassInstances = 0;
+    m_RenderContext.imguiData.visibleObjects      = 0;
+    m_RenderContext.imguiData.culledObjects       = 0;
+    m_RenderContext.imguiData.skippedBinds        = 0;
+    m_RenderContext.imguiData.cachedCascades      = 0;
+    m_RenderContext.imguiData.culledLights        = 0;
+
+    // only waits for the frame that used the resources of this frame the last
+    // time, the frames after it can still be rendering
+    vkWaitForFences(m_Context.baseContext.device, 1, &m_InFlightFences[m_CurrentFrame], VK_TRUE,
+                    UINT64_MAX);
 
     // TODO this causes validation layer errors on some machines because
     // semaphore is signalled after recreation
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(m_Context.baseContext.device,
                                             m_Context.swapchainContext.swapChain,
-                                            UINT64_MAX, m_ImageAvailableSemaphore,
+                                            UINT64_MAX, m_ImageAvailableSemaphores[m_CurrentFrame],
                                             VK_NULL_HANDLE, &imageIndex);
 
     if(result == VK_ERROR_OUT_OF_DATE_KHR || m_Context.window->wasResized()) {
@@ -53,9 +79,12 @@ void VulkanRenderer::render(Scene& scene) {
         throw std::runtime_error("failed to acquire swap chain image!");
     }
 
-    vkResetFences(m_Context.baseContext.device, 1, &m_InFlightFence);
+    vkResetFences(m_Context.baseContext.device, 1, &m_InFlightFences[m_CurrentFrame]);
 
+    m_Context.commandContext.commandBuffer =
+        m_Context.commandContext.commandBuffers[m_CurrentFrame];
     vkResetCommandBuffer(m_Context.commandContext.commandBuffer, 0);
+    resetRecordingPools();
 
     if(m_RenderContext.usesImgui) {
         scene.registerSceneImgui(m_RenderContext);
@@ -63,26 +92,61 @@ void VulkanRenderer::render(Scene& scene) {
         if(ImGui::Button("Recompile Shaders")) {
             recompileToSecondaryPipeline();
         }
+        ImGui::Checkbox("Parallel Recording", &m_RenderContext.imguiData.parallelRecording);
         ImGui::End();
     }
 
-    scene.doCameraUpdate(m_RenderContext);
-    scene.doGameplayUpdate();
+    // the view mask of multiview only contains the active cascades, the other
+    // frames in flight still use the old render passes
+    ShadowPass& shadowPass     = m_RenderContext.renderPasses.shadowPass;
+    int         numberCascades = m_RenderContext.renderSettings.shadowMappingSettings.numberCascades;
+    if(shadowPass.useMultiview && shadowPass.cascadeCount != numberCascades) {
+        vkDeviceWaitIdle(m_Context.baseContext.device);
+        recreateShadowRenderPasses(m_Context, shadowPass, numberCascades);
+    }
 
-    updateUniformBuffer(scene);
+    // the structural changes of the systems of the last frame, then new
+    // matrices for the entities that moved since. The systems below do not
+    // change either, so the draw list is extracted while they run.
+    scene.playbackCommands();
+    scene.updateTransformations();
+
+    // runs together with the physics and input systems added by main()
+    SystemScheduler& scheduler = scene.getScheduler();
+
+    // follows the player with the matrix of the last updateTransformations()
+    SystemAccess cameraAccess;
+    cameraAccess.resourceWrites = CAMERA_RESOURCE | RENDER_CONTEXT_RESOURCE;
+    scheduler.addSystem("camera update", cameraAccess,
+                        [&]() { scene.doCameraUpdate(m_RenderContext); });
+
+    // the bodies are part of the physics world, the PhysicsComponents only
+    // point to them
+    SystemAccess gameplayAccess;
+    gameplayAccess.componentReads  = getComponentMask<PhysicsComponent>();
+    gameplayAccess.componentWrites = getComponentMask<PlayerComponent, Transformation>();
+    gameplayAccess.resourceWrites  = PHYSICS_WORLD_RESOURCE | LEVEL_DATA_RESOURCE;
+    scheduler.addSystem("gameplay update", gameplayAccess,
+                        [&]() { scene.doGameplayUpdate(); });
+
+    // waits for the camera update, but not for the simulation
+    SystemAccess drawListAccess;
+    drawListAccess.componentReads =
+        getComponentMask<ModelComponent, BoundsComponent, PhysicsComponent>();
+    drawListAccess.resourceReads = CAMERA_RESOURCE | RENDER_CONTEXT_RESOURCE;
+    scheduler.addSystem("draw list extraction", drawListAccess,
+                        [&]() { extractDrawList(scene); });
+
+    scheduler.run();
 
-    // TODO iterate render passes (or "hardcode" them), use Pipeline barriers
-    // between frame buffer writes or whatever needed ?
-    // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdPipelineBarrier.html
-    // pipeline barriers implicit ordering for all stages before and after ?
-    // https://themaister.net/blog/2019/08/14/yet-another-blog-explaining-vulkan-synchronization/
+    updateUniformBuffer(scene);
 
     recordCommandBuffer(scene, imageIndex);
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = {m_ImageAvailableSemaphore};
+    VkSemaphore waitSemaphores[] = {m_ImageAvailableSemaphores[m_CurrentFrame]};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     submitInfo.waitSemaphoreCount = 1;
     submitInfo.pWaitSemaphores    = waitSemaphores;
@@ -92,11 +156,12 @@ void VulkanRenderer::render(Scene& scene) {
     submitInfo.pCommandBuffers    = &m_Context.commandContext.commandBuffer;
 
     // TODO Vulkan Layers throw error one reisze to very small window ?
-    VkSemaphore signalSemaphores[]  = {m_RenderFinishedSemaphore};
+    VkSemaphore signalSemaphores[]  = {m_RenderFinishedSemaphores[m_CurrentFrame]};
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores    = signalSemaphores;
 
-    if(vkQueueSubmit(m_Context.baseContext.graphicsQueue, 1, &submitInfo, m_InFlightFence)
+    if(vkQueueSubmit(m_Context.baseContext.graphicsQueue, 1, &submitInfo,
+                     m_InFlightFences[m_CurrentFrame])
        != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
@@ -113,6 +178,19 @@ void VulkanRenderer::render(Scene& scene) {
     presentInfo.pImageIndices   = &imageIndex;
 
     vkQueuePresentKHR(m_Context.baseContext.presentQueue, &presentInfo);
+
+    m_CurrentFrame = (m_CurrentFrame + 1) % m_Context.graphicSettings.framesInFlight;
+    frameNumber++;
+}
+
+// the copies and clears of the shadow maps need the stencil aspect as well if
+// the depth format has one
+static VkImageAspectFlags getShadowMapAspect(const VulkanBaseContext& baseContext) {
+    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if(findDepthFormat(baseContext) != VK_FORMAT_D32_SFLOAT) {
+        aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+    return aspectMask;
 }
 
 void VulkanRenderer::recordCommandBuffer(Scene& scene, uint32_t imageIndex) {
@@ -125,74 +203,319 @@ void VulkanRenderer::recordCommandBuffer(Scene& scene, uint32_t imageIndex) {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
+    // the fence of this frame was waited for, so the timestamps its command
+    // buffer wrote the last time can be read
+    gpuProfiler.beginFrame(m_Context.commandContext.commandBuffer, m_CurrentFrame);
+
+    cullLights(scene);
+    uploadLights(scene);
+
     if(m_RenderContext.imguiData.shadows) {
+        updateShadowCascades(scene);
+    }
 
-        recordShadowPass(scene, imageIndex);
+    // the culling needs the cascades, the secondary command buffers draw
+    // the commands it writes
+    if(useGpuCulling()) {
+        updateCullingBuffers(scene);
+    } else {
+        culledViews[m_CurrentFrame] = 0;
+    }
 
-        VkMemoryBarrier memoryBarrier;
-        memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-        memoryBarrier.pNext         = VK_NULL_HANDLE;
-        memoryBarrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-        memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    recordSecondaryCommandBuffers(scene);
 
-        vkCmdPipelineBarrier(m_Context.commandContext.commandBuffer,
-                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1,
-                             &memoryBarrier, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+    buildRenderGraph(scene, imageIndex);
+    renderGraph.execute(m_Context.commandContext.commandBuffer, gpuProfiler);
+
+    if(vkEndCommandBuffer(m_Context.commandContext.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
     }
+}
 
-    recordGeometryPass(scene);
+void VulkanRenderer::buildRenderGraph(Scene& scene, uint32_t imageIndex) {
+    MainPass&        mainPass        = m_RenderContext.renderPasses.mainPass;
+    ShadowPass&      shadowPass      = m_RenderContext.renderPasses.shadowPass;
+    CullingPass&     cullingPass     = m_RenderContext.renderPasses.cullingPass;
+    LightTilingPass& lightTilingPass = m_RenderContext.renderPasses.lightTilingPass;
+    uint32_t         frame           = m_CurrentFrame;
+
+    renderGraph.clear();
+
+    // the gBuffer is written again every frame, the shadow maps keep the
+    // cascades that are not updated
+    RenderResource normal =
+        renderGraph.addImage(mainPass.normalAttachment, VK_IMAGE_ASPECT_COLOR_BIT, 1, true);
+    RenderResource albedo =
+        renderGraph.addImage(mainPass.albedoAttachment, VK_IMAGE_ASPECT_COLOR_BIT, 1, true);
+    RenderResource aoRoughnessMetallic = renderGraph.addImage(
+        mainPass.aoRoughnessMetallicAttachment, VK_IMAGE_ASPECT_COLOR_BIT, 1, true);
+    RenderResource depth = renderGraph.addImage(
+        mainPass.depthAttachment, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, 1,
+        true);
+    RenderResource shadowMaps = renderGraph.addImage(
+        shadowPass.depthImage, getShadowMapAspect(m_Context.baseContext), MAX_CASCADES, false);
+
+    RenderResource drawCommands = renderGraph.addBuffer(cullingPass.drawCommandBuffers[frame]);
+    RenderResource drawCounts   = renderGraph.addBuffer(cullingPass.drawCountBuffers[frame]);
+    RenderResource tileLights   = renderGraph.addBuffer(lightTilingPass.tileLightBuffers[frame]);
+
+    if(useGpuCulling()) {
+        uint32_t culling = renderGraph.addPass("culling", [this]() { recordCullingPass(); });
+        renderGraph.use(culling, drawCommands, ResourceUsage::ComputeStorageWrite);
+        // the counts are cleared before the dispatch
+        renderGraph.use(culling, drawCounts, ResourceUsage::TransferWrite,
+                        ResourceUsage::ComputeStorageWrite);
+        // read back for the statistics once the fence of the frame is signaled
+        renderGraph.setFinalUsage(drawCounts, ResourceUsage::HostRead);
+    }
 
-    VkMemoryBarrier memoryBarrier2;
-    memoryBarrier2.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-    memoryBarrier2.pNext         = VK_NULL_HANDLE;
-    memoryBarrier2.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-    memoryBarrier2.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    // the shadow maps of an earlier frame are still used if no cascade is
+    // updated
+    if(m_RenderContext.imguiData.shadows && updatedCascades != 0) {
+        uint32_t shadow = renderGraph.addPass(
+            "shadow", [this, &scene, imageIndex]() { recordShadowPass(scene, imageIndex); });
+        // the layers are cleared or copied from the cache before the render
+        // pass draws them
+        renderGraph.use(shadow, shadowMaps, ResourceUsage::TransferWrite,
+                        ResourceUsage::DepthStencilAttachment);
+        renderGraph.use(shadow, drawCommands, ResourceUsage::IndirectRead);
+        renderGraph.use(shadow, drawCounts, ResourceUsage::IndirectRead);
+    }
 
-    vkCmdPipelineBarrier(m_Context.commandContext.commandBuffer,
-                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1,
-                         &memoryBarrier2, 0, VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+    uint32_t geometry =
+        renderGraph.addPass("geometry", [this, &scene]() { recordGeometryPass(scene); });
+    renderGraph.use(geometry, normal, ResourceUsage::ColorAttachment);
+    renderGraph.use(geometry, albedo, ResourceUsage::ColorAttachment);
+    renderGraph.use(geometry, aoRoughnessMetallic, ResourceUsage::ColorAttachment);
+    // the light volumes write the stencil in the same render pass
+    renderGraph.use(geometry, depth, ResourceUsage::DepthStencilAttachment);
+    renderGraph.use(geometry, drawCommands, ResourceUsage::IndirectRead);
+    renderGraph.use(geometry, drawCounts, ResourceUsage::IndirectRead);
+
+    if(useTiledLighting()) {
+        uint32_t lightTiling = renderGraph.addPass(
+            "light tiling", [this, &scene]() { recordLightTilingPass(scene); });
+        renderGraph.use(lightTiling, depth, ResourceUsage::ComputeDepthSampled);
+        renderGraph.use(lightTiling, tileLights, ResourceUsage::ComputeStorageWrite);
+    }
 
-    recordMainRenderPass(scene, imageIndex);
+    // the primary light, the point lights, the skybox and ImGui are drawn in
+    // the single subpass of the main render pass
+    uint32_t lighting = renderGraph.addPass(
+        "lighting", [this, &scene, imageIndex]() { recordMainRenderPass(scene, imageIndex); });
+    renderGraph.use(lighting, normal, ResourceUsage::FragmentSampled);
+    renderGraph.use(lighting, albedo, ResourceUsage::FragmentSampled);
+    renderGraph.use(lighting, aoRoughnessMetallic, ResourceUsage::FragmentSampled);
+    renderGraph.use(lighting, depth, ResourceUsage::DepthReadStencilAttachment);
+    renderGraph.use(lighting, shadowMaps, ResourceUsage::FragmentDepthSampled);
+    renderGraph.use(lighting, tileLights, ResourceUsage::FragmentStorageRead);
+}
 
-    if(vkEndCommandBuffer(m_Context.commandContext.commandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+// entities that are moved by the physics or the player, everything else is
+// drawn into the cache of the static shadow casters
+static bool isDynamicEntity(Scene& scene, EntityId id) {
+    PhysicsComponent* physicsComponent = scene.getComponent<PhysicsComponent>(id);
+    return (physicsComponent != nullptr && physicsComponent->dynamic)
+           || scene.getComponent<PlayerComponent>(id) != nullptr;
+}
+
+void VulkanRenderer::extractDrawList(Scene& scene) {
+    modelEntities.clear();
+    modelBounds.clear();
+    drawList.clear();
+
+    SceneData& sceneData      = scene.getSceneData();
+    glm::vec3  cameraPosition = scene.getCameraRef().getWorldPos();
+    float      farPlane = m_RenderContext.renderSettings.perspectiveSettings.farPlane;
+    size_t     staticCount = 0;
+
+    SceneView<ModelComponent, Transformation, BoundsComponent>(scene).each(
+        [&](EntityId id, ModelComponent& modelComponent, Transformation& transformComponent,
+            BoundsComponent& boundsComponent) {
+            uint32_t entityIndex = static_cast<uint32_t>(modelEntities.size());
+            bool     dynamic     = isDynamicEntity(scene, id);
+            modelEntities.push_back({id, &modelComponent, &transformComponent, dynamic});
+            if(!dynamic) {
+                staticCount++;
+            }
+            modelBounds.add(boundsComponent.world);
+
+            float depth = glm::length(boundsComponent.world.center - cameraPosition) / farPlane;
+
+            Model& model = sceneData.models[modelComponent.modelIndex];
+            for(uint32_t partIndex = 0; partIndex < model.meshPartIndices.size(); partIndex++) {
+                MeshPart& meshPart = sceneData.meshParts[model.meshPartIndices[partIndex]];
+
+                // every MeshPart uses the same pipeline in each pass so far
+                uint64_t sortKey =
+                    makeDrawSortKey(0, meshPart.materialIndex, meshPart.meshIndex, depth);
+                drawList.items.push_back({sortKey, entityIndex, partIndex,
+                                          meshPart.meshIndex, meshPart.materialIndex});
+            }
+        });
+
+    sortDrawList(drawList);
+    splitDrawList(drawList, RECORDING_SLICE_ITEMS, drawSlices);
+
+    // the cached static shadow casters are outdated when one of them was
+    // added, removed or moved
+    staticCastersChanged = staticCount != staticModelCount;
+    staticModelCount     = staticCount;
+    for(EntityId id : scene.getUpdatedTransformations()) {
+        if(staticCastersChanged) {
+            break;
+        }
+        staticCastersChanged =
+            scene.getComponent<ModelComponent>(id) != nullptr && !isDynamicEntity(scene, id);
+    }
+
+    playerEntity = INVALID_ENTITY_ID;
+    for(EntityId id : SceneView<PlayerComponent, Transformation>(scene)) {
+        playerEntity = id;
     }
+
+    // each item is drawn at most once in the geometry pass and once per
+    // cascade into the cached static casters and the shadow maps, the
+    // geometry pass gets a range as large as the draw list and the two
+    // shadow passes one with MAX_CASCADES instances per item. Every item gets
+    // the instances at its own position in the range, so the ranges can be
+    // written in parallel. The fence of this frame was waited for, so its
+    // instance buffer is not in use anymore.
+    resizeInstanceBuffer(m_Context, m_RenderContext, m_CurrentFrame,
+                         static_cast<uint32_t>(drawList.items.size() * (2 * MAX_CASCADES + 1)));
+
+    updateObjectBuffer(scene);
 }
 
-void VulkanRenderer::recordShadowPass(Scene& scene, uint32_t imageIndex) {
-    ShadowPass&      shadowPass    = m_RenderContext.renderPasses.shadowPass;
-    VkCommandBuffer& commandBuffer = m_Context.commandContext.commandBuffer;
+void VulkanRenderer::updateObjectBuffer(Scene& scene) {
+    uint32_t frame = m_CurrentFrame;
 
-    VkExtent2D shadowExtent;
-    shadowExtent.width  = shadowPass.shadowMapWidth;
-    shadowExtent.height = shadowPass.shadowMapHeight;
+    // the matrices and the world bounds only change in updateTransformations(),
+    // so its entities are outdated in the object buffers of all frames
+    for(EntityId id : scene.getUpdatedTransformations()) {
+        uint32_t slot = getEntityIndex(id);
+        for(std::vector<EntityId>& objects : writtenObjects) {
+            if(slot < objects.size()) {
+                objects[slot] = INVALID_ENTITY_ID;
+            }
+        }
+    }
 
+    // an entity uses the slot at the index of its handle, which only moves
+    // to another entity once it was removed. The fence of this frame was
+    // waited for, so its object buffer is not in use anymore.
+    auto slotCount = static_cast<uint32_t>(scene.getEntities().size());
+    resizeObjectBuffer(m_Context, m_RenderContext, frame, slotCount);
+    writtenObjects[frame].resize(slotCount, INVALID_ENTITY_ID);
+
+    auto* objects = static_cast<ObjectData*>(
+        m_RenderContext.renderPasses.mainPass.objectBuffers[frame].bufferMemoryMapping);
+    for(uint32_t entity = 0; entity < modelEntities.size(); entity++) {
+        EntityId  id   = modelEntities[entity].id;
+        EntityId& slot = writtenObjects[frame][getEntityIndex(id)];
+        if(slot == id) {
+            continue;
+        }
+        slot = id;
+
+        Transformation& transformComponent = *modelEntities[entity].transformation;
+
+        ObjectData& object           = objects[getEntityIndex(id)];
+        object.transformation        = transformComponent.getTransformationMatrix();
+        object.normalsTransformation = transformComponent.getNormalsTransformationMatrix();
+        object.sphere =
+            glm::vec4(modelBounds.sphereCenterX[entity], modelBounds.sphereCenterY[entity],
+                      modelBounds.sphereCenterZ[entity], modelBounds.sphereRadius[entity]);
+        object.boxCenter = glm::vec4(modelBounds.boxCenterX[entity], modelBounds.boxCenterY[entity],
+                                     modelBounds.boxCenterZ[entity], 0);
+        object.boxExtent = glm::vec4(modelBounds.boxExtentX[entity], modelBounds.boxExtentY[entity],
+                                     modelBounds.boxExtentZ[entity], 0);
+    }
+}
 
-    VkClearValue clearValue;
-    clearValue.depthStencil = {1.0f, 0};
+template<typename Filter>
+void VulkanRenderer::recordInstancedDraws(Scene& scene, VkCommandBuffer commandBuffer, size_t begin,
+                                          size_t end, uint32_t firstInstance, bool splitCascades,
+                                          const Filter&   getCascadeMask,
+                                          DrawStatistics& statistics) {
+    auto* instances = static_cast<InstanceData*>(
+        m_RenderContext.renderPasses.mainPass.instanceBuffers[m_CurrentFrame].bufferMemoryMapping);
+
+    // the draw list is sorted by material and mesh, so all instances of a
+    // MeshPart follow each other and become one draw
+    int      groupMesh     = -1;
+    int      groupMaterial = -1;
+    uint32_t nextInstance  = firstInstance;
+    int64_t  boundBlock    = -1;
+
+    auto drawGroup = [&]() {
+        uint32_t groupSize = nextInstance - firstInstance;
+        if(groupSize == 0) {
+            return;
+        }
+        Mesh& mesh = scene.getSceneData().meshes[groupMesh];
+
+        // the buffers only change with the block of the geometry pool
+        if(mesh.geometryBlock != boundBlock) {
+            bindGeometryBlock(commandBuffer, scene, mesh.geometryBlock);
+            boundBlock = mesh.geometryBlock;
+        } else {
+            statistics.skippedBinds += 2;
+        }
 
-    VkViewport viewport{};
-    viewport.x        = 0.0f;
-    viewport.y        = 0.0f;
-    viewport.width    = shadowExtent.width;
-    viewport.height   = shadowExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        statistics.drawCalls++;
+        statistics.instances += static_cast<int>(groupSize);
+        vkCmdDrawIndexed(commandBuffer, mesh.indicesCount, groupSize, mesh.firstIndex,
+                         mesh.vertexOffset, firstInstance);
+        firstInstance = nextInstance;
+    };
+
+    for(size_t i = begin; i < end; i++) {
+        const DrawItem& item        = drawList.items[i];
+        uint32_t        cascadeMask = getCascadeMask(item);
+        if(cascadeMask == 0) {
+            continue;
+        }
+        if(item.meshIndex != groupMesh || item.materialIndex != groupMaterial) {
+            drawGroup();
+            groupMesh     = item.meshIndex;
+            groupMaterial = item.materialIndex;
+        }
 
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = shadowExtent;
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        uint32_t objectIndex = getEntityIndex(modelEntities[item.entityIndex].id);
+
+        while(cascadeMask != 0) {
+            // the lowest bit only if the instances are split
+            uint32_t instanceMask = splitCascades ? cascadeMask & (~cascadeMask + 1) : cascadeMask;
+            cascadeMask &= ~instanceMask;
+
+            InstanceData& instance = instances[nextInstance++];
+            instance.objectIndex   = objectIndex;
+            instance.materialIndex = item.materialIndex;
+            instance.cascadeMask   = instanceMask;
+        }
+    }
+    drawGroup();
+}
+
+void VulkanRenderer::bindGeometryBlock(VkCommandBuffer commandBuffer, Scene& scene,
+                                       uint32_t blockIndex) {
+    GeometryBlock& block = scene.getSceneData().geometryPool.blocks[blockIndex];
+
+    VkBuffer     vertexBuffers[] = {block.vertexBuffer};
+    VkDeviceSize offsets[]       = {0};
 
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
+    vkCmdBindIndexBuffer(commandBuffer, block.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+void VulkanRenderer::updateShadowCascades(Scene& scene) {
     int numberCascades = m_RenderContext.renderSettings.shadowMappingSettings.numberCascades;
 
-    std::vector<glm::mat4>        VPMats(numberCascades);
+    std::vector<glm::mat4>&       VPMats = cascadeViewProjections;
     std::vector<SplitDummyStruct> splitDepths(numberCascades);
-
+    VPMats.resize(numberCascades);
 
     glm::mat4 invViewProj = glm::inverse(
         getPerspectiveMatrix(m_RenderContext.renderSettings.perspectiveSettings,
@@ -202,114 +525,1022 @@ void VulkanRenderer::recordShadowPass(Scene& scene, uint32_t imageIndex) {
 
     scene.getCameraRef().normalizeViewDir();
 
-    calculateShadowCascades(m_RenderContext.renderSettings.perspectiveSettings, invViewProj,
-                            m_RenderContext.renderSettings.shadowMappingSettings,
-                            scene.getCameraRef().getViewDir(), VPMats, splitDepths);
-
+    if(m_RenderContext.renderSettings.shadowMappingSettings.stabilizeCascades) {
+        updateStableCascades(invViewProj, splitDepths);
+    } else {
+        calculateShadowCascades(m_RenderContext.renderSettings.perspectiveSettings, invViewProj,
+                                m_RenderContext.renderSettings.shadowMappingSettings,
+                                scene.getCameraRef().getViewDir(), VPMats, splitDepths);
+
+        // the cascades follow the camera rotation, they change every frame
+        for(int i = 0; i < numberCascades; i++) {
+            cascadeCaches[i].valid = false;
+            cascadeUpdates[i]      = CascadeUpdate::Full;
+        }
+    }
 
-    memcpy(m_RenderContext.renderPasses.mainPass.cascadeSplitsBuffer.bufferMemoryMapping,
+    memcpy(m_RenderContext.renderPasses.mainPass.cascadeSplitsBuffers[m_CurrentFrame]
+               .bufferMemoryMapping,
            splitDepths.data(), numberCascades * sizeof(SplitDummyStruct));
 
-    memcpy(m_RenderContext.renderPasses.shadowPass.transformBuffer.bufferMemoryMapping,
+    memcpy(m_RenderContext.renderPasses.shadowPass.transformBuffers[m_CurrentFrame]
+               .bufferMemoryMapping,
            VPMats.data(), numberCascades * sizeof(glm::mat4));
+}
 
+void VulkanRenderer::updateStableCascades(glm::mat4                      inverseViewProjection,
+                                          std::vector<SplitDummyStruct>& splitDepths) {
+    ShadowMappingSettings& shadowSettings = m_RenderContext.renderSettings.shadowMappingSettings;
+    ImguiData&             imguiData      = m_RenderContext.imguiData;
+
+    std::vector<CascadeSphere> spheres;
+    calculateCascadeSpheres(m_RenderContext.renderSettings.perspectiveSettings,
+                            inverseViewProjection, shadowSettings, spheres, splitDepths);
+
+    // the cascades have to be redrawn with the new settings
+    bool settingsChanged = shadowSettings.lightDirection != cachedLightDirection
+                           || shadowSettings.lightCameraZOffset != cachedLightCameraZOffset
+                           || shadowSettings.cacheMargin != cachedCacheMargin
+                           || shadowSettings.numberCascades != cachedNumberCascades
+                           || imguiData.depthBiasConstant != cachedDepthBiasConstant
+                           || imguiData.depthBiasSlope != cachedDepthBiasSlope;
+
+    cachedLightDirection     = shadowSettings.lightDirection;
+    cachedLightCameraZOffset = shadowSettings.lightCameraZOffset;
+    cachedCacheMargin        = shadowSettings.cacheMargin;
+    cachedNumberCascades     = shadowSettings.numberCascades;
+    cachedDepthBiasConstant  = imguiData.depthBiasConstant;
+    cachedDepthBiasSlope     = imguiData.depthBiasSlope;
+
+    bool     useCache      = useShadowCache();
+    uint32_t shadowMapSize = m_RenderContext.renderPasses.shadowPass.shadowMapWidth;
+
+    for(int i = 0; i < shadowSettings.numberCascades; i++) {
+        CascadeCache&        cache  = cascadeCaches[i];
+        const CascadeSphere& sphere = spheres[i];
+
+        // the cascade only moves once the part of the camera frustum it has
+        // to cover leaves its bounds
+        bool contained = glm::length(sphere.center - cache.sphere.center) + sphere.radius
+                         <= cache.sphere.radius;
+        bool moved = !cache.valid || settingsChanged || !contained;
+
+        if(moved) {
+            cache.valid         = true;
+            cache.staticCached  = false;
+            cache.sphere.center = sphere.center;
+            cache.sphere.radius = sphere.radius * (1.0f + shadowSettings.cacheMargin);
+            cache.viewProjection =
+                calculateStableCascadeMatrix(cache.sphere, shadowSettings.lightDirection,
+                                             shadowSettings.lightCameraZOffset, shadowMapSize);
+        }
+        if(staticCastersChanged || !useCache) {
+            cache.staticCached = false;
+        }
+        cascadeViewProjections[i] = cache.viewProjection;
+
+        bool isFarCascade = i >= shadowSettings.firstFarCascade;
+        bool updateDue    = !isFarCascade
+                         || frameNumber - cache.lastUpdateFrame >= shadowSettings.farCascadeInterval;
+
+        CascadeUpdate& update = cascadeUpdates[i];
+        if(!moved && !updateDue) {
+            update = CascadeUpdate::Skip;
+        } else if(!useCache) {
+            update = CascadeUpdate::Full;
+        } else if(!cache.staticCached) {
+            update             = CascadeUpdate::StaticAndDynamic;
+            cache.staticCached = true;
+        } else {
+            update = CascadeUpdate::Dynamic;
+        }
 
-    for(size_t i = 0; i < MAX_CASCADES; i++) {
-        VkRenderPassBeginInfo renderPassInfo{};
-        renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass  = shadowPass.renderPassContext.renderPass;
-        renderPassInfo.framebuffer = shadowPass.depthFrameBuffers[i];
+        if(update != CascadeUpdate::Skip) {
+            cache.lastUpdateFrame = frameNumber;
+        }
+        if(update == CascadeUpdate::Skip || update == CascadeUpdate::Dynamic) {
+            imguiData.cachedCascades++;
+        }
+    }
+}
 
-        renderPassInfo.clearValueCount = 1;
-        renderPassInfo.pClearValues    = &clearValue;
+Frustum VulkanRenderer::getCameraFrustum(Scene& scene) {
+    glm::mat4 projection =
+        getPerspectiveMatrix(m_RenderContext.renderSettings.perspectiveSettings,
+                             m_Context.swapchainContext.swapChainExtent.width,
+                             m_Context.swapchainContext.swapChainExtent.height);
+    projection[1][1] *= -1;
 
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = shadowExtent;
+    return extractFrustum(projection * scene.getCameraRef().getCameraMatrix());
+}
 
-        vkCmdBeginRenderPass(commandBuffer,
-                             &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+void VulkanRenderer::updateCullingBuffers(Scene& scene) {
+    CullingPass& cullingPass = m_RenderContext.renderPasses.cullingPass;
+
+    uint32_t frame = m_CurrentFrame;
+
+    // the fence of this frame was waited for, so the counts written the last
+    // time its buffers were used can be read (the statistics are as many
+    // frames late as there are frames in flight)
+    auto* counts =
+        static_cast<uint32_t*>(cullingPass.drawCountBuffers[frame].bufferMemoryMapping);
+    for(uint32_t view = 0; view < culledViews[frame]; view++) {
+        int& instanceCount = view == 0 ? m_RenderContext.imguiData.meshInstances
+                                       : m_RenderContext.imguiData.shadowPassInstances;
+        for(uint32_t batch = 0; batch < countsPerView[frame]; batch++) {
+            instanceCount += static_cast<int>(counts[view * countsPerView[frame] + batch]);
+        }
+    }
 
-        vkCmdBindPipeline(m_Context.commandContext.commandBuffer,
-                          VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPass.shadowPipeline);
+    uint32_t instanceCount = static_cast<uint32_t>(drawList.items.size());
+    resizeCullingBuffers(m_Context, m_RenderContext, frame, instanceCount);
+
+    // one batch per block of the geometry pool (usually a single one), the
+    // draws of a batch are a range of the commands of every view that is large
+    // enough for all instances in the block
+    SceneData& sceneData = scene.getSceneData();
+    indirectBatches.clear();
+    blockBatches.assign(sceneData.geometryPool.blocks.size(), -1);
+    for(const DrawItem& item : drawList.items) {
+        uint32_t geometryBlock = sceneData.meshes[item.meshIndex].geometryBlock;
+        int&     batch         = blockBatches[geometryBlock];
+        if(batch == -1) {
+            batch = static_cast<int>(indirectBatches.size());
+            indirectBatches.push_back({geometryBlock, 0, 0});
+        }
+        indirectBatches[batch].commandCount++;
+    }
+    uint32_t firstCommand = 0;
+    for(IndirectBatch& batch : indirectBatches) {
+        batch.firstCommand = firstCommand;
+        firstCommand += batch.commandCount;
+    }
+
+    auto* instances = static_cast<InstanceData*>(
+        m_RenderContext.renderPasses.mainPass.instanceBuffers[m_CurrentFrame].bufferMemoryMapping);
+    auto* cullInstances =
+        static_cast<CullInstance*>(cullingPass.cullInstanceBuffers[frame].bufferMemoryMapping);
+
+    for(uint32_t i = 0; i < instanceCount; i++) {
+        const DrawItem& item        = drawList.items[i];
+        uint32_t        entity      = item.entityIndex;
+        uint32_t        objectIndex = getEntityIndex(modelEntities[entity].id);
+
+        // the matrices and the bounds are in the object buffer
+        instances[i].objectIndex   = objectIndex;
+        instances[i].materialIndex = item.materialIndex;
+        instances[i].cascadeMask   = 0;
+
+        CullInstance& cullInstance = cullInstances[i];
+        cullInstance.objectIndex   = objectIndex;
+
+        const Mesh&          mesh       = sceneData.meshes[item.meshIndex];
+        int                  batchIndex = blockBatches[mesh.geometryBlock];
+        const IndirectBatch& batch      = indirectBatches[batchIndex];
+        cullInstance.firstCommand       = batch.firstCommand;
+        cullInstance.batchIndex         = batchIndex;
+        cullInstance.indexCount         = mesh.indicesCount;
+        cullInstance.firstIndex         = mesh.firstIndex;
+        cullInstance.vertexOffset       = mesh.vertexOffset;
+
+        // same hardcoded exception for the spikes of the player as in
+        // recordShadowSlice()
+        bool castsShadow = m_RenderContext.imguiData.playerSpikesShadow
+                           || modelEntities[entity].id != playerEntity
+                           || (item.partIndex != 1 && item.partIndex != 2);
+        cullInstance.flags = castsShadow ? CULL_SHADOW_CASTER_BIT : 0;
+    }
+
+    // the camera is view 0, the cascades follow
+    std::vector<Frustum> frustums;
+    frustums.push_back(getCameraFrustum(scene));
+    if(m_RenderContext.imguiData.shadows) {
+        for(const glm::mat4& VPMat : cascadeViewProjections) {
+            frustums.push_back(extractShadowCasterFrustum(VPMat));
+        }
+    }
+
+    auto* cullingUniform =
+        static_cast<CullingUniform*>(cullingPass.cullingUniformBuffers[frame].bufferMemoryMapping);
+    for(size_t view = 0; view < frustums.size(); view++) {
+        for(int plane = 0; plane < 6; plane++) {
+            // a plane without normal keeps everything
+            cullingUniform->planes[view * 6 + plane] = m_RenderContext.imguiData.frustumCulling
+                                                           ? frustums[view].planes[plane]
+                                                           : glm::vec4(0, 0, 0, 1);
+        }
+    }
+
+    culledViews[frame]     = static_cast<uint32_t>(frustums.size());
+    commandsPerView[frame] = instanceCount;
+    countsPerView[frame]   = static_cast<uint32_t>(indirectBatches.size());
+
+    cullingUniform->instanceCount   = instanceCount;
+    cullingUniform->viewCount       = culledViews[frame];
+    cullingUniform->commandsPerView = commandsPerView[frame];
+    cullingUniform->countsPerView   = countsPerView[frame];
+}
+
+void VulkanRenderer::recordCullingPass() {
+    CullingPass&     cullingPass   = m_RenderContext.renderPasses.cullingPass;
+    VkCommandBuffer& commandBuffer = m_Context.commandContext.commandBuffer;
+
+    uint32_t frame         = m_CurrentFrame;
+    uint32_t instanceCount = commandsPerView[frame];
+    if(instanceCount == 0) {
+        return;
+    }
+
+    vkCmdFillBuffer(commandBuffer, cullingPass.drawCountBuffers[frame].buffer, 0,
+                    culledViews[frame] * countsPerView[frame] * sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0,
+                         VK_NULL_HANDLE, 0, VK_NULL_HANDLE);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullingPass.pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            cullingPass.pipelineLayout, 0, 1, &cullingPass.descriptorSets[frame],
+                            0, nullptr);
+
+    vkCmdDispatch(commandBuffer,
+                  (instanceCount + CULLING_WORKGROUP_SIZE - 1) / CULLING_WORKGROUP_SIZE, 1, 1);
+}
 
+void VulkanRenderer::recordIndirectDraws(VkCommandBuffer commandBuffer, Scene& scene, uint32_t view,
+                                         int& drawCalls) {
+    CullingPass& cullingPass = m_RenderContext.renderPasses.cullingPass;
+    uint32_t     frame       = m_CurrentFrame;
 
-        if(i < m_RenderContext.renderSettings.shadowMappingSettings.numberCascades) {
+    if(view >= culledViews[frame]) {
+        return;
+    }
+
+    for(uint32_t batchIndex = 0; batchIndex < indirectBatches.size(); batchIndex++) {
+        const IndirectBatch& batch = indirectBatches[batchIndex];
+
+        bindGeometryBlock(commandBuffer, scene, batch.geometryBlock);
+
+        drawCalls++;
+        vkCmdDrawIndexedIndirectCount(
+            commandBuffer, cullingPass.drawCommandBuffers[frame].buffer,
+            (view * commandsPerView[frame] + batch.firstCommand) * sizeof(DrawCommand),
+            cullingPass.drawCountBuffers[frame].buffer,
+            (view * countsPerView[frame] + batchIndex) * sizeof(uint32_t), batch.commandCount,
+            sizeof(DrawCommand));
+    }
+}
 
+void VulkanRenderer::createRecordingPools() {
+    recordingThreads = m_ThreadPool.getWorkerCount() + 1;
+    recordingPools.resize(m_Context.graphicSettings.framesInFlight * recordingThreads);
 
-            vkCmdSetDepthBias(commandBuffer,
-                              m_RenderContext.imguiData.depthBiasConstant, 0.0f,
-                              m_RenderContext.imguiData.depthBiasSlope * (i + 1));
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = m_Context.baseContext.graphicsQueueFamily;
 
-            vkCmdBindDescriptorSets(m_Context.commandContext.commandBuffer,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    shadowPass.shadowPipelineLayout, 0, 1,
-                                    &m_RenderContext.renderPasses.shadowPass.transformDescriptorSet,
-                                    0, nullptr);
+    for(RecordingPool& recordingPool : recordingPools) {
+        if(vkCreateCommandPool(m_Context.baseContext.device, &poolInfo, nullptr,
+                               &recordingPool.commandPool)
+           != VK_SUCCESS) {
+            throw std::runtime_error("failed to create command pool for recording thread!");
+        }
+    }
+}
+
+void VulkanRenderer::resetRecordingPools() {
+    for(uint32_t thread = 0; thread < recordingThreads; thread++) {
+        RecordingPool& recordingPool = recordingPools[m_CurrentFrame * recordingThreads + thread];
+        vkResetCommandPool(m_Context.baseContext.device, recordingPool.commandPool, 0);
+        recordingPool.usedCommandBuffers = 0;
+    }
+}
+
+VkCommandBuffer VulkanRenderer::beginSecondaryCommandBuffer(VkRenderPass  renderPass,
+                                                            VkFramebuffer framebuffer) {
+    // a command pool must only be used by one thread at a time, so every
+    // thread takes its command buffers from its own pool
+    int      workerIndex = ThreadPool::getCurrentWorkerIndex();
+    uint32_t thread =
+        workerIndex < 0 ? recordingThreads - 1 : static_cast<uint32_t>(workerIndex);
+    RecordingPool& recordingPool = recordingPools[m_CurrentFrame * recordingThreads + thread];
+
+    if(recordingPool.usedCommandBuffers == recordingPool.commandBuffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool        = recordingPool.commandPool;
+        allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if(vkAllocateCommandBuffers(m_Context.baseContext.device, &allocInfo, &commandBuffer)
+           != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate secondary command buffer!");
+        }
+        recordingPool.commandBuffers.push_back(commandBuffer);
+    }
+    VkCommandBuffer commandBuffer = recordingPool.commandBuffers[recordingPool.usedCommandBuffers++];
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass  = renderPass;
+    inheritanceInfo.subpass     = 0;
+    inheritanceInfo.framebuffer = framebuffer;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+                      | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
+    return commandBuffer;
+}
+
+void VulkanRenderer::recordSecondaryCommandBuffers(Scene& scene) {
+    // the camera frustum is tested once for all slices
+    if(!useGpuCulling()) {
+        size_t visibleCount = modelEntities.size();
+        if(m_RenderContext.imguiData.frustumCulling) {
+            visibleCount = cullBatch(getCameraFrustum(scene), modelBounds, visibleModels);
+        } else {
+            visibleModels.assign(modelEntities.size(), 1);
+        }
+        m_RenderContext.imguiData.visibleObjects = static_cast<int>(visibleCount);
+        m_RenderContext.imguiData.culledObjects =
+            static_cast<int>(modelEntities.size() - visibleCount);
+    }
 
-            vkCmdBindDescriptorSets(m_Context.commandContext.commandBuffer,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    shadowPass.shadowPipelineLayout, 1, 1,
-                                    &m_RenderContext.renderPasses.shadowPass.materialDescriptorSet,
-                                    0, nullptr);
+    // the draw list is split into the same slices as for the geometry pass,
+    // every slice is drawn into all updated cascades, see recordShadowPass()
+    shadowTasks.clear();
+    staticCommandBufferCount = 0;
+    if(m_RenderContext.imguiData.shadows) {
+        updateCascadeMasks();
 
-            ShadowPushConstant shadowPushConstant;
-            shadowPushConstant.cascadeIndex  = i;
-            shadowPushConstant.materialIndex = 0;
+        // only objects that can cast a shadow into an updated cascade, they
+        // are tested once for all slices
+        for(uint32_t cascade = 0; cascade < cascadeViewProjections.size(); cascade++) {
+            if(useGpuCulling() || (updatedCascades & (1u << cascade)) == 0) {
+                continue;
+            }
+            if(m_RenderContext.imguiData.frustumCulling) {
+                cullBatch(extractShadowCasterFrustum(cascadeViewProjections[cascade]),
+                          modelBounds, shadowCasters[cascade]);
+            } else {
+                shadowCasters[cascade].assign(modelEntities.size(), 1);
+            }
+        }
 
-            EntityId playerID = -1;
+        uint32_t shadowSlices =
+            useGpuCulling() ? 1 : static_cast<uint32_t>(drawSlices.size() - 1);
+        if(staticCascades != 0) {
+            for(uint32_t slice = 0; slice < shadowSlices; slice++) {
+                shadowTasks.push_back({true, slice});
+            }
+            staticCommandBufferCount = shadowSlices;
+        }
+        if(updatedCascades != 0) {
+            for(uint32_t slice = 0; slice < shadowSlices; slice++) {
+                shadowTasks.push_back({false, slice});
+            }
+        }
+    }
+    shadowCommandBufferCount = static_cast<uint32_t>(shadowTasks.size());
+    // the indirect draws of the GPU culling are few, they need no slices
+    uint32_t sliceCount =
+        useGpuCulling() ? 1 : static_cast<uint32_t>(drawSlices.size() - 1);
+    // the tiled lighting needs no light volumes in the stencil buffer
+    uint32_t lightCount =
+        m_RenderContext.imguiData.pointLights && !useTiledLighting() ? 1 : 0;
+
+    size_t taskCount = shadowCommandBufferCount + sliceCount + lightCount;
+    secondaryCommandBuffers.assign(taskCount, VK_NULL_HANDLE);
+    secondaryStatistics.assign(taskCount, DrawStatistics());
+
+    auto recordTask = [&](size_t task) {
+        uint32_t        index      = static_cast<uint32_t>(task);
+        DrawStatistics& statistics = secondaryStatistics[task];
+
+        if(index < shadowCommandBufferCount) {
+            secondaryCommandBuffers[task] =
+                recordShadowSlice(scene, shadowTasks[index], statistics);
+        } else if(index < shadowCommandBufferCount + sliceCount) {
+            secondaryCommandBuffers[task] =
+                recordGeometrySlice(scene, index - shadowCommandBufferCount, statistics);
+        } else {
+            secondaryCommandBuffers[task] = recordLightStencil(scene, statistics);
+        }
+    };
 
-            for(EntityId id : SceneView<PlayerComponent, Transformation>(scene)) {
-                playerID = id;
+    if(m_RenderContext.imguiData.parallelRecording) {
+        m_ThreadPool.parallelFor(taskCount, 1, [&](size_t begin, size_t end) {
+            for(size_t task = begin; task < end; task++) {
+                recordTask(task);
             }
+        });
+    } else {
+        for(size_t task = 0; task < taskCount; task++) {
+            recordTask(task);
+        }
+    }
+
+    ImguiData& imguiData = m_RenderContext.imguiData;
+    for(size_t task = 0; task < taskCount; task++) {
+        const DrawStatistics& statistics = secondaryStatistics[task];
+        if(task < shadowCommandBufferCount) {
+            imguiData.shadowPassDrawCalls += statistics.drawCalls;
+            imguiData.shadowPassInstances += statistics.instances;
+        } else if(task < shadowCommandBufferCount + sliceCount) {
+            imguiData.meshDrawCalls += statistics.drawCalls;
+            imguiData.meshInstances += statistics.instances;
+        } else {
+            imguiData.lightDrawCalls += statistics.drawCalls;
+        }
+        imguiData.skippedBinds += statistics.skippedBinds;
+    }
+}
+
+void VulkanRenderer::updateCascadeMasks() {
+    updatedCascades = 0;
+    clearedCascades = 0;
+    copiedCascades  = 0;
+    staticCascades  = 0;
+
+    for(uint32_t cascade = 0; cascade < cascadeViewProjections.size(); cascade++) {
+        uint32_t bit = 1u << cascade;
+        switch(cascadeUpdates[cascade]) {
+            case CascadeUpdate::Skip:
+                break;
+            case CascadeUpdate::Full:
+                updatedCascades |= bit;
+                clearedCascades |= bit;
+                break;
+            case CascadeUpdate::StaticAndDynamic:
+                staticCascades |= bit;
+                updatedCascades |= bit;
+                copiedCascades |= bit;
+                break;
+            case CascadeUpdate::Dynamic:
+                updatedCascades |= bit;
+                copiedCascades |= bit;
+                break;
+        }
+    }
+
+    // the unused cascades are only cleared once, they are not sampled but
+    // the whole image has to be in a defined layout
+    if(!shadowMapsDefined) {
+        uint32_t allCascades = (1u << MAX_CASCADES) - 1;
+        updatedCascades |= allCascades;
+        clearedCascades |= allCascades & ~copiedCascades;
+    }
+}
+
+// A cascade needs (cascade + 1) times the slope factor of the first one. All
+// cascades share the draws and so the depth bias of the pipeline, the rest is
+// a constant depth offset added by the vertex shader: "cascade" times the
+// depth difference across one texel of a surface at 45 degrees to the light,
+// which grows with the texel size of the cascade.
+static float getCascadeDepthBias(const glm::mat4& viewProjection, uint32_t cascade,
+                                 float slopeFactor, uint32_t shadowMapSize) {
+    // the rows of the orthographic light matrix scale the world units
+    float unitsPerTexel =
+        2.0f / glm::length(glm::vec3(viewProjection[0][0], viewProjection[1][0],
+                                     viewProjection[2][0]))
+        / static_cast<float>(shadowMapSize);
+    // the shadow vertex shaders map the depth from [-1, 1] to [0, 1]
+    float depthPerUnit = 0.5f * glm::length(glm::vec3(viewProjection[0][2], viewProjection[1][2],
+                                                      viewProjection[2][2]));
+
+    return slopeFactor * static_cast<float>(cascade) * unitsPerTexel * depthPerUnit;
+}
 
-            for(EntityId id : SceneView<ModelComponent, Transformation>(scene)) {
-                auto* modelComponent = scene.getComponent<ModelComponent>(id);
-                auto* transformComponent = scene.getComponent<Transformation>(id);
+VkCommandBuffer VulkanRenderer::recordShadowSlice(Scene& scene, const ShadowTask& task,
+                                                  DrawStatistics& statistics) {
+    ShadowPass& shadowPass = m_RenderContext.renderPasses.shadowPass;
+
+    VkRenderPass  renderPass  = shadowPass.renderPassContext.renderPass;
+    VkFramebuffer framebuffer = shadowPass.depthFrameBuffer;
+    if(task.staticCasters) {
+        renderPass  = shadowPass.staticRenderPass;
+        framebuffer = shadowPass.staticDepthFrameBuffer;
+    }
+    VkCommandBuffer commandBuffer = beginSecondaryCommandBuffer(renderPass, framebuffer);
+
+    VkExtent2D shadowExtent;
+    shadowExtent.width  = shadowPass.shadowMapWidth;
+    shadowExtent.height = shadowPass.shadowMapHeight;
 
-                Model& model = scene.getSceneData().models[modelComponent->modelIndex];
+    VkViewport viewport{};
+    viewport.x        = 0.0f;
+    viewport.y        = 0.0f;
+    viewport.width    = shadowExtent.width;
+    viewport.height   = shadowExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = shadowExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPass.shadowPipeline);
+
+    // all cascades are drawn by the same draws, so they share the bias of the
+    // pipeline, the vertex shader adds the part that grows with the cascade
+    vkCmdSetDepthBias(commandBuffer, m_RenderContext.imguiData.depthBiasConstant, 0.0f,
+                      m_RenderContext.imguiData.depthBiasSlope);
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            shadowPass.shadowPipelineLayout, 0, 1,
+                            &shadowPass.transformDescriptorSets[m_CurrentFrame], 0, nullptr);
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            shadowPass.shadowPipelineLayout, 1, 1,
+                            &shadowPass.materialDescriptorSet, 0, nullptr);
+
+    ShadowPushConstant shadowPushConstant;
+    shadowPushConstant.cascadeMask = 0;
+    for(uint32_t cascade = 0; cascade < MAX_CASCADES; cascade++) {
+        shadowPushConstant.cascadeDepthBias[cascade] =
+            cascade < cascadeViewProjections.size()
+                ? getCascadeDepthBias(cascadeViewProjections[cascade], cascade,
+                                      m_RenderContext.imguiData.depthBiasSlope,
+                                      shadowPass.shadowMapWidth)
+                : 0.0f;
+    }
+
+    if(useGpuCulling()) {
+        // the culling pass writes separate draws per cascade, the camera is
+        // view 0 of the culling pass
+        for(uint32_t cascade = 0; cascade < cascadeViewProjections.size(); cascade++) {
+            if((updatedCascades & (1u << cascade)) == 0) {
+                continue;
+            }
+            shadowPushConstant.cascadeMask = 1u << cascade;
+            vkCmdPushConstants(commandBuffer, shadowPass.shadowPipelineLayout,
+                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                               0,  // offset
+                               sizeof(ShadowPushConstant), &shadowPushConstant);
 
-                int counter = 0;
-                for(auto& meshPartIndex : model.meshPartIndices) {
-                    // this is fairly hardcoded so that the spiky mesh of the
-                    // player has no shadow the meshes of the spikes are at
-                    // position 1 and 2 (this is the hardcoded part)
-                    if(!m_RenderContext.imguiData.playerSpikesShadow
-                       && id == playerID && (counter == 1 || counter == 2)) {
-                        counter++;
+            recordIndirectDraws(commandBuffer, scene, cascade + 1, statistics.drawCalls);
+        }
+    } else {
+        vkCmdPushConstants(commandBuffer, shadowPass.shadowPipelineLayout,
+                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0,  // offset
+                           sizeof(ShadowPushConstant), &shadowPushConstant);
+
+        // the geometry pass uses the first range of the instance buffer, the
+        // shadow maps and the cached static casters the two ranges after it
+        size_t   begin         = drawSlices[task.slice];
+        size_t   end           = drawSlices[task.slice + 1];
+        size_t   itemCount     = drawList.items.size();
+        size_t   range         = task.staticCasters ? itemCount * (1 + MAX_CASCADES) : itemCount;
+        uint32_t firstInstance = static_cast<uint32_t>(range + begin * MAX_CASCADES);
+
+        uint32_t cascadeMask = task.staticCasters ? staticCascades : updatedCascades;
+        uint32_t cascadeCount = static_cast<uint32_t>(cascadeViewProjections.size());
+
+        recordInstancedDraws(
+            scene, commandBuffer, begin, end, firstInstance, !shadowPass.useMultiview,
+            [&](const DrawItem& item) {
+                // this is fairly hardcoded so that the spiky mesh of the
+                // player has no shadow the meshes of the spikes are at
+                // position 1 and 2 (this is the hardcoded part)
+                if(!m_RenderContext.imguiData.playerSpikesShadow
+                   && modelEntities[item.entityIndex].id == playerEntity
+                   && (item.partIndex == 1 || item.partIndex == 2)) {
+                    return 0u;
+                }
+                // the static casters are in the cache, they are only drawn
+                // into the cascades that are cleared
+                bool dynamic = modelEntities[item.entityIndex].dynamic;
+                if(task.staticCasters && dynamic) {
+                    return 0u;
+                }
+                uint32_t itemMask = 0;
+                for(uint32_t cascade = 0; cascade < cascadeCount; cascade++) {
+                    uint32_t bit = 1u << cascade;
+                    if((cascadeMask & bit) == 0
+                       || shadowCasters[cascade][item.entityIndex] == 0) {
                         continue;
                     }
-                    MeshPart& meshPart = scene.getSceneData().meshParts[meshPartIndex];
-                    Mesh& mesh = scene.getSceneData().meshes[meshPart.meshIndex];
-                    VkBuffer     vertexBuffers[] = {mesh.vertexBuffer};
-                    VkDeviceSize offsets[]       = {0};
+                    if(!task.staticCasters && !dynamic && (copiedCascades & bit) != 0) {
+                        continue;
+                    }
+                    itemMask |= bit;
+                }
+                return itemMask;
+            },
+            statistics);
+    }
+
+    if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+    return commandBuffer;
+}
+
+VkCommandBuffer VulkanRenderer::beginGeometryCommandBuffer() {
+    MainPass&       mainPass = m_RenderContext.renderPasses.mainPass;
+    VkCommandBuffer commandBuffer =
+        beginSecondaryCommandBuffer(mainPass.geometryPass, mainPass.gBuffer);
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width =
+        static_cast<float>(m_Context.swapchainContext.swapChainExtent.width);
+    viewport.height =
+        static_cast<float>(m_Context.swapchainContext.swapChainExtent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = m_Context.swapchainContext.swapChainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    return commandBuffer;
+}
+
+VkCommandBuffer VulkanRenderer::recordGeometrySlice(Scene& scene, uint32_t slice,
+                                                    DrawStatistics& statistics) {
+    MainPass&       mainPass      = m_RenderContext.renderPasses.mainPass;
+    VkCommandBuffer commandBuffer = beginGeometryCommandBuffer();
+
+    vkCmdBindPipeline(commandBuffer,
+                      VK_PIPELINE_BIND_POINT_GRAPHICS, mainPass.geometryPassPipeline);
+
+    // bind DescriptorSet 0 (Camera Transformations)
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            mainPass.geometryPassPipelineLayout, 0, 1,
+                            &mainPass.transformDescriptorSets[m_CurrentFrame], 0, nullptr);
+
+    // bind DescriptorSet 1 (Materials)
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            mainPass.geometryPassPipelineLayout, 1, 1,
+                            &mainPass.materialDescriptorSet, 0, nullptr);
+
+    // bind DescriptorSet 2 (Shadows)
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            mainPass.geometryPassPipelineLayout, 2, 1,
+                            &mainPass.depthDescriptorSets[m_CurrentFrame], 0, nullptr);
+
+    if(useGpuCulling()) {
+        recordIndirectDraws(commandBuffer, scene, 0, statistics.drawCalls);
+    } else {
+        // the instances of the slice are at the positions of its items
+        size_t begin = drawSlices[slice];
+        size_t end   = drawSlices[slice + 1];
+        recordInstancedDraws(
+            scene, commandBuffer, begin, end, static_cast<uint32_t>(begin), false,
+            [&](const DrawItem& item) { return visibleModels[item.entityIndex] != 0 ? 1u : 0u; },
+            statistics);
+    }
+
+    if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+    return commandBuffer;
+}
+
+VkCommandBuffer VulkanRenderer::recordLightStencil(Scene& scene, DrawStatistics& statistics) {
+    MainPass&       mainPass      = m_RenderContext.renderPasses.mainPass;
+    VkCommandBuffer commandBuffer = beginGeometryCommandBuffer();
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      mainPass.stencilPipeline);
+
+    // bind DescriptorSet 0 (Lights)
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            mainPass.stencilPipelineLayout, 0, 1,
+                            &mainPass.transformDescriptorSets[m_CurrentFrame], 0, nullptr);
+
+    // bind point light mesh (it will remain the same for each light source
+    Mesh pointLightMesh = scene.getSceneData().pointLightMesh;
+    bindGeometryBlock(commandBuffer, scene, pointLightMesh.geometryBlock);
+
+    glm::mat4 projection =
+        getPerspectiveMatrix(m_RenderContext.renderSettings.perspectiveSettings,
+                             m_Context.swapchainContext.swapChainExtent.width,
+                             m_Context.swapchainContext.swapChainExtent.height);
+    // one tutorial says openGL has different convention for Y
+    // coordinates in clip space than vulkan, need to flip it
+    projection[1][1] *= -1;
+    StencilPushConstant& stencilPushConstant = mainPass.stencilPushConstant;
+    stencilPushConstant.projView =
+        projection * scene.getCameraRef().getCameraMatrix();
+
+    // sending push constant to GPU
+    vkCmdPushConstants(commandBuffer,
+                       mainPass.stencilPipelineLayout,
+                       VK_SHADER_STAGE_VERTEX_BIT,
+                       0,  // offset
+                       sizeof(StencilPushConstant), &stencilPushConstant);
+
+    // one icosphere instance per point light
+    uint32_t lightCount = static_cast<uint32_t>(visibleLights.size());
+    if(lightCount > 0) {
+        statistics.drawCalls++;
+
+        vkCmdDrawIndexed(commandBuffer, pointLightMesh.indicesCount, lightCount,
+                         pointLightMesh.firstIndex, pointLightMesh.vertexOffset, 0);
+    }
+
+    if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+    return commandBuffer;
+}
+
+void VulkanRenderer::cullLights(Scene& scene) {
+    SceneData& sceneData  = scene.getSceneData();
+    ImguiData& imguiData  = m_RenderContext.imguiData;
+    size_t     lightCount = sceneData.lights.size();
+
+    if(lightBoundsVersion != sceneData.lightsVersion) {
+        lightBounds.clear();
+        for(const PointLight& pointLight : sceneData.lights) {
+            Bounds bounds;
+            bounds.center = pointLight.position;
+            bounds.radius = pointLight.radius;
+            bounds.min    = pointLight.position - glm::vec3(pointLight.radius);
+            bounds.max    = pointLight.position + glm::vec3(pointLight.radius);
+            lightBounds.add(bounds);
+        }
+        lightBoundsVersion = sceneData.lightsVersion;
+    }
+
+    visibleLights.clear();
+    if(!imguiData.pointLights) {
+        imguiData.culledLights = 0;
+        return;
+    }
+
+    // a light has no influence outside of its radius, so the sphere is exact
+    if(imguiData.frustumCulling) {
+        cullBatch(getCameraFrustum(scene), lightBounds, lightVisibility);
+    } else {
+        lightVisibility.assign(lightCount, 1);
+    }
+    for(uint32_t i = 0; i < lightCount; i++) {
+        if(lightVisibility[i]) {
+            visibleLights.push_back(i);
+        }
+    }
+
+    size_t budget = static_cast<size_t>(std::max(imguiData.maxLights, 0));
+    if(imguiData.lightBudget && visibleLights.size() > budget) {
+        glm::mat4 projection =
+            getPerspectiveMatrix(m_RenderContext.renderSettings.perspectiveSettings,
+                                 m_Context.swapchainContext.swapChainExtent.width,
+                                 m_Context.swapchainContext.swapChainExtent.height);
+        glm::vec3 cameraPosition = scene.getCameraRef().getWorldPos();
+
+        // the squared radius of the projected sphere (relative to the screen
+        // height) approximates the covered part of the screen, it is weighted
+        // by the brightness of the light
+        std::vector<float> importance(lightCount, 0.0f);
+        for(uint32_t i : visibleLights) {
+            const PointLight& pointLight = sceneData.lights[i];
+            float distance = glm::length(pointLight.position - cameraPosition);
+
+            float coverage = 1.0f;
+            if(distance > pointLight.radius) {
+                coverage = std::min(pointLight.radius * projection[1][1] / distance, 1.0f);
+            }
+            float luminance =
+                glm::dot(pointLight.intensity, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+            importance[i] = coverage * coverage * luminance;
+        }
+
+        std::nth_element(visibleLights.begin(), visibleLights.begin() + budget,
+                         visibleLights.end(), [&](uint32_t a, uint32_t b) {
+                             return importance[a] > importance[b];
+                         });
+        visibleLights.resize(budget);
+    }
+
+    imguiData.culledLights = static_cast<int>(lightCount - visibleLights.size());
+}
+
+void VulkanRenderer::uploadLights(Scene& scene) {
+    SceneData& sceneData = scene.getSceneData();
+    if(uploadedLightsVersions[m_CurrentFrame] == sceneData.lightsVersion
+       && uploadedLights[m_CurrentFrame] == visibleLights) {
+        return;
+    }
 
-                    shadowPushConstant.materialIndex = meshPart.materialIndex;
+    // the fence of this frame was waited for, so its light buffer is not in
+    // use anymore
+    uint32_t lightCount = static_cast<uint32_t>(visibleLights.size());
+    resizeLightBuffer(m_Context, m_RenderContext, m_CurrentFrame, lightCount);
+
+    auto* lights = static_cast<LightData*>(
+        m_RenderContext.renderPasses.mainPass.lightBuffers[m_CurrentFrame].bufferMemoryMapping);
+    for(uint32_t i = 0; i < lightCount; i++) {
+        const PointLight& pointLight = sceneData.lights[visibleLights[i]];
+        lights[i].position           = pointLight.position;
+        lights[i].radius             = pointLight.radius;
+        lights[i].intensity          = pointLight.intensity;
+    }
 
-                    vkCmdBindVertexBuffers(commandBuffer,
-                                           0, 1, vertexBuffers, offsets);
+    uploadedLightsVersions[m_CurrentFrame] = sceneData.lightsVersion;
+    uploadedLights[m_CurrentFrame]         = visibleLights;
+}
 
-                    vkCmdBindIndexBuffer(commandBuffer,
-                                         mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+void VulkanRenderer::recordLightTilingPass(Scene& scene) {
+    MainPass&        mainPass        = m_RenderContext.renderPasses.mainPass;
+    LightTilingPass& lightTilingPass = m_RenderContext.renderPasses.lightTilingPass;
+    VkCommandBuffer& commandBuffer   = m_Context.commandContext.commandBuffer;
+    uint32_t         frame           = m_CurrentFrame;
+
+    VkExtent2D extent     = m_Context.swapchainContext.swapChainExtent;
+    uint32_t   tileCountX = getTileCountX(extent);
+    uint32_t   tileCountY = getTileCountY(extent);
+
+    // the fence of this frame was waited for, so its tile buffer can be
+    // recreated if the window got bigger
+    resizeTileLightBuffer(m_Context, m_RenderContext, frame, tileCountX * tileCountY);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lightTilingPass.pipeline);
+
+    std::array<VkDescriptorSet, 3> descriptorSets = {mainPass.transformDescriptorSets[frame],
+                                                     mainPass.gBufferDescriptorSet,
+                                                     lightTilingPass.descriptorSets[frame]};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            lightTilingPass.pipelineLayout, 0,
+                            static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(),
+                            0, nullptr);
+
+    LightTilePushConstant lightTilePushConstant;
+    lightTilePushConstant.resolution = glm::ivec2(extent.width, extent.height);
+    lightTilePushConstant.lightCount = static_cast<uint32_t>(visibleLights.size());
+    lightTilePushConstant.tileCountX = tileCountX;
+
+    vkCmdPushConstants(commandBuffer, lightTilingPass.pipelineLayout,
+                       VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(LightTilePushConstant),
+                       &lightTilePushConstant);
+
+    // one workgroup per tile
+    vkCmdDispatch(commandBuffer, tileCountX, tileCountY, 1);
+}
 
-                    // only updates transformation matrix if the transformation has changed
-                    shadowPushConstant.transform = transformComponent->getTransformationMatrix();
+void VulkanRenderer::recordShadowPass(Scene& scene, uint32_t imageIndex) {
+    ShadowPass&      shadowPass    = m_RenderContext.renderPasses.shadowPass;
+    VkCommandBuffer& commandBuffer = m_Context.commandContext.commandBuffer;
 
-                    vkCmdPushConstants(m_Context.commandContext.commandBuffer,
-                                       shadowPass.shadowPipelineLayout,
-                                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                                       0,  // offset
-                                       sizeof(ShadowPushConstant), &shadowPushConstant);
+    VkExtent2D shadowExtent;
+    shadowExtent.width  = shadowPass.shadowMapWidth;
+    shadowExtent.height = shadowPass.shadowMapHeight;
 
-                    m_RenderContext.imguiData.shadowPassDrawCalls++;
-                    vkCmdDrawIndexed(commandBuffer,
-                                     mesh.indicesCount, 1, 0, 0, 0);
+    // with multiview every cascade is a view of the render passes, the
+    // layered render passes have a single view
+    uint32_t viewCount =
+        shadowPass.useMultiview ? static_cast<uint32_t>(shadowPass.cascadeCount) : 1;
 
-                    counter++;
+    // the render passes load all layers, the layers of the cascades that are
+    // not drawn stay as they are
+    auto recordRenderPass = [&](VkRenderPass renderPass, VkFramebuffer framebuffer,
+                                uint32_t firstTask, uint32_t taskCount,
+                                const std::string& scopeName) {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass  = renderPass;
+        renderPassInfo.framebuffer = framebuffer;
+
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = shadowExtent;
+
+        auto firstCommandBuffer = secondaryCommandBuffers.begin() + firstTask;
+        std::vector<VkCommandBuffer> commandBuffers(firstCommandBuffer,
+                                                    firstCommandBuffer + taskCount);
+
+        // the contents of the render pass are secondary command buffers, so
+        // the timestamps of the scope are written into two more of them
+        if(gpuProfiler.isSupported()) {
+            VkCommandBuffer beginCommandBuffer =
+                beginSecondaryCommandBuffer(renderPass, framebuffer);
+            gpuProfiler.beginViewScope(beginCommandBuffer, scopeName, "cascade", viewCount);
+            VkCommandBuffer endCommandBuffer =
+                beginSecondaryCommandBuffer(renderPass, framebuffer);
+            gpuProfiler.endScope(endCommandBuffer);
+
+            for(VkCommandBuffer timestampCommandBuffer : {beginCommandBuffer, endCommandBuffer}) {
+                if(vkEndCommandBuffer(timestampCommandBuffer) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to record secondary command buffer!");
                 }
             }
+            commandBuffers.insert(commandBuffers.begin(), beginCommandBuffer);
+            commandBuffers.push_back(endCommandBuffer);
+        }
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo,
+                             VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        if(!commandBuffers.empty()) {
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(commandBuffers.size()),
+                                 commandBuffers.data());
         }
         vkCmdEndRenderPass(commandBuffer);
+    };
+
+    // the cache stays in the transfer source layout between the frames
+    if(staticCascades != 0) {
+        recordShadowMapTransition(shadowPass.staticDepthImage.image,
+                                  staticShadowMapsDefined ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                                          : VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT);
+        recordShadowClear(shadowPass.staticDepthImage.image, staticCascades);
+        recordRenderPass(shadowPass.staticRenderPass, shadowPass.staticDepthFrameBuffer, 0,
+                         staticCommandBufferCount, "static casters");
+        staticShadowMapsDefined = true;
+    }
+
+    // the render graph moved the shadow maps to the transfer destination layout
+    if(clearedCascades != 0) {
+        recordShadowClear(shadowPass.depthImage.image, clearedCascades);
+    }
+    if(copiedCascades != 0) {
+        recordStaticShadowCopy();
+    }
+    recordRenderPass(shadowPass.renderPassContext.renderPass, shadowPass.depthFrameBuffer,
+                     staticCommandBufferCount, shadowCommandBufferCount - staticCommandBufferCount,
+                     "shadow maps");
+    shadowMapsDefined = true;
+}
+
+void VulkanRenderer::recordShadowMapTransition(VkImage image, VkImageLayout oldLayout,
+                                               VkPipelineStageFlags srcStage) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask                   = 0;
+    barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout                       = oldLayout;
+    barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = image;
+    barrier.subresourceRange.aspectMask     = getShadowMapAspect(m_Context.baseContext);
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = MAX_CASCADES;
+
+    vkCmdPipelineBarrier(m_Context.commandContext.commandBuffer, srcStage,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, VK_NULL_HANDLE, 0,
+                         VK_NULL_HANDLE, 1, &barrier);
+}
+
+void VulkanRenderer::recordShadowClear(VkImage image, uint32_t cascadeMask) {
+    std::vector<VkImageSubresourceRange> ranges;
+    for(uint32_t cascade = 0; cascade < MAX_CASCADES; cascade++) {
+        if((cascadeMask & (1u << cascade)) != 0) {
+            ranges.push_back({getShadowMapAspect(m_Context.baseContext), 0, 1, cascade, 1});
+        }
     }
+
+    VkClearDepthStencilValue clearValue = {1.0f, 0};
+    vkCmdClearDepthStencilImage(m_Context.commandContext.commandBuffer, image,
+                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearValue,
+                                static_cast<uint32_t>(ranges.size()), ranges.data());
+}
+
+void VulkanRenderer::recordStaticShadowCopy() {
+    ShadowPass& shadowPass = m_RenderContext.renderPasses.shadowPass;
+
+    // one region per layer, the cache has the same layers as the shadow maps
+    std::vector<VkImageCopy> regions;
+    for(uint32_t cascade = 0; cascade < MAX_CASCADES; cascade++) {
+        if((copiedCascades & (1u << cascade)) == 0) {
+            continue;
+        }
+        VkImageCopy region{};
+        region.srcSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, cascade, 1};
+        region.dstSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, cascade, 1};
+        region.extent         = {shadowPass.shadowMapWidth, shadowPass.shadowMapHeight, 1};
+        regions.push_back(region);
+    }
+
+    vkCmdCopyImage(m_Context.commandContext.commandBuffer, shadowPass.staticDepthImage.image,
+                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, shadowPass.depthImage.image,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()),
+                   regions.data());
 }
 
 void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
@@ -353,13 +1584,14 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
     if(m_RenderContext.imguiData.visualizeShadowBuffer) {
+        gpuProfiler.beginScope(commandBuffer, "shadow visualization");
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                           mainPass.visualizePipeline);
 
         vkCmdBindDescriptorSets(
             commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
             mainPass.visualizePipelineLayout, 0, 1,
-            &mainPass.depthDescriptorSet, 0, nullptr);
+            &mainPass.depthDescriptorSets[m_CurrentFrame], 0, nullptr);
 
         ShadowControlPushConstant& shadowControlPushConstant = mainPass.shadowControlPushConstant;
 
@@ -380,9 +1612,10 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
                            sizeof(ShadowControlPushConstant), &shadowControlPushConstant);
 
         vkCmdDraw(commandBuffer, 6, 1, 0, 0);
-
+        gpuProfiler.endScope(commandBuffer);
     } else {
         // render screen quad for primary light source
+        gpuProfiler.beginScope(commandBuffer, "primary light");
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                           mainPass.primaryLightingPipeline);
 
@@ -390,12 +1623,12 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
         vkCmdBindDescriptorSets(
             commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
             mainPass.primaryLightingPipelineLayout, 0,
-            1, &mainPass.transformDescriptorSet, 0, nullptr);
+            1, &mainPass.transformDescriptorSets[m_CurrentFrame], 0, nullptr);
         // bind DescriptorSet 1 (Shadow)
         vkCmdBindDescriptorSets(
             commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
             mainPass.primaryLightingPipelineLayout, 1,
-            1, &mainPass.depthDescriptorSet, 0, nullptr);
+            1, &mainPass.depthDescriptorSets[m_CurrentFrame], 0, nullptr);
         // bind DescriptorSet 2 (gBuffer)
         vkCmdBindDescriptorSets(
             commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -409,12 +1642,10 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
 
         // create PushConstant object and initialize with default values
         PushConstant& pushConstant    = mainPass.pushConstant;
-        pushConstant.transformation   = glm::mat4(1);
         pushConstant.worldCamPosition = scene.getCameraRef().getWorldPos();
         pushConstant.resolution =
             glm::ivec2(m_Context.swapchainContext.swapChainExtent.width,
                        m_Context.swapchainContext.swapChainExtent.height);
-        pushConstant.materialIndex = 0;
         pushConstant.cascadeCount =
             m_RenderContext.renderSettings.shadowMappingSettings.numberCascades;
 
@@ -431,8 +1662,42 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
                            sizeof(PushConstant), &pushConstant);
 
         vkCmdDraw(commandBuffer, 6, 1, 0, 0);
-        
+        gpuProfiler.endScope(commandBuffer);
+
         if(m_RenderContext.imguiData.pointLights) {
+            gpuProfiler.beginScope(commandBuffer, "point lights");
+        }
+        if(useTiledLighting()) {
+            LightTilingPass& lightTilingPass = m_RenderContext.renderPasses.lightTilingPass;
+
+            // render screen quad that adds the point lights of every tile
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              lightTilingPass.shadingPipeline);
+
+            // same sets as the light tiling compute pass
+            std::array<VkDescriptorSet, 3> descriptorSets = {
+                mainPass.transformDescriptorSets[m_CurrentFrame], mainPass.gBufferDescriptorSet,
+                lightTilingPass.descriptorSets[m_CurrentFrame]};
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    lightTilingPass.shadingPipelineLayout, 0,
+                                    static_cast<uint32_t>(descriptorSets.size()),
+                                    descriptorSets.data(), 0, nullptr);
+
+            VkExtent2D            extent = m_Context.swapchainContext.swapChainExtent;
+            LightTilePushConstant lightTilePushConstant;
+            lightTilePushConstant.resolution = glm::ivec2(extent.width, extent.height);
+            lightTilePushConstant.lightCount =
+                static_cast<uint32_t>(visibleLights.size());
+            lightTilePushConstant.tileCountX = getTileCountX(extent);
+
+            vkCmdPushConstants(commandBuffer, lightTilingPass.shadingPipelineLayout,
+                               VK_SHADER_STAGE_FRAGMENT_BIT,
+                               0,  // offset
+                               sizeof(LightTilePushConstant), &lightTilePushConstant);
+
+            m_RenderContext.imguiData.lightDrawCalls++;
+            vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+        } else if(m_RenderContext.imguiData.pointLights) {
             // render point lights for shading
             {
                 vkCmdBindPipeline(commandBuffer,
@@ -443,7 +1708,7 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
                 vkCmdBindDescriptorSets(
                     commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                     mainPass.pointLightsPipelineLayout,
-                    0, 1, &mainPass.transformDescriptorSet,
+                    0, 1, &mainPass.transformDescriptorSets[m_CurrentFrame],
                     0, nullptr);
 
                 // bind DescriptorSet 1 (gBuffer)
@@ -454,13 +1719,8 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
                     0, nullptr);
 
                 // bind point light mesh (it will remain the same for each light source
-                Mesh     pointLightMesh  = scene.getSceneData().pointLightMesh;
-                VkBuffer vertexBuffers[] = {pointLightMesh.vertexBuffer};
-                VkDeviceSize offsets[]   = {0};
-                vkCmdBindVertexBuffers(commandBuffer,
-                                       0, 1, vertexBuffers, offsets);
-                vkCmdBindIndexBuffer(commandBuffer,
-                                     pointLightMesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+                Mesh pointLightMesh = scene.getSceneData().pointLightMesh;
+                bindGeometryBlock(commandBuffer, scene, pointLightMesh.geometryBlock);
 
                 PointLightPushConstant& pointLightPushConstant = mainPass.pointLightPushConstant;
                 pointLightPushConstant.worldCamPosition =
@@ -469,34 +1729,31 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
                     glm::ivec2(m_Context.swapchainContext.swapChainExtent.width,
                                m_Context.swapchainContext.swapChainExtent.height);
 
-                // draw icosphere per point light
-                for(PointLight& pointLight : scene.getSceneData().lights) {
-                    // build transformation matrix for vertex shader
-                    glm::mat4 scaleMat =
-                        glm::scale(glm::mat4(1), glm::vec3(pointLight.radius));
-                    glm::mat4 translateMat =
-                        glm::translate(glm::mat4(1), pointLight.position);
-
-                    pointLightPushConstant.transformation = translateMat * scaleMat;
-                    pointLightPushConstant.position  = pointLight.position;
-                    pointLightPushConstant.intensity = pointLight.intensity;
-                    pointLightPushConstant.radius    = pointLight.radius;
-
-                    // sending push constant to GPU
-                    vkCmdPushConstants(
-                        commandBuffer,
-                        mainPass.pointLightsPipelineLayout,
-                        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                        0,  // offset
-                        sizeof(PointLightPushConstant), &pointLightPushConstant);
-
-                    vkCmdDrawIndexed(commandBuffer,
-                                     pointLightMesh.indicesCount, 1, 0, 0, 0);
+                // sending push constant to GPU
+                vkCmdPushConstants(
+                    commandBuffer,
+                    mainPass.pointLightsPipelineLayout,
+                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                    0,  // offset
+                    sizeof(PointLightPushConstant), &pointLightPushConstant);
+
+                // one icosphere instance per point light, the shaders fetch
+                // the light of the instance from the light buffer
+                uint32_t lightCount =
+                    static_cast<uint32_t>(visibleLights.size());
+                if(lightCount > 0) {
+                    m_RenderContext.imguiData.lightDrawCalls++;
+                    vkCmdDrawIndexed(commandBuffer, pointLightMesh.indicesCount, lightCount,
+                                     pointLightMesh.firstIndex, pointLightMesh.vertexOffset, 0);
                 }
             }
         }
+        if(m_RenderContext.imguiData.pointLights) {
+            gpuProfiler.endScope(commandBuffer);
+        }
 
         // render skybpx
+        gpuProfiler.beginScope(commandBuffer, "skybox");
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                           mainPass.skyboxPipeline);
 
@@ -504,7 +1761,7 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
         vkCmdBindDescriptorSets(
             commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
             mainPass.skyboxPipelineLayout, 0, 1,
-            &mainPass.transformDescriptorSet, 0, nullptr);
+            &mainPass.transformDescriptorSets[m_CurrentFrame], 0, nullptr);
 
         // bind DescriptorSet 1 (Materials)
         vkCmdBindDescriptorSets(
@@ -523,13 +1780,16 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
                            sizeof(SkyboxPushConstant), &skyboxPushConstant);
 
         vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+        gpuProfiler.endScope(commandBuffer);
     }
 
     if(m_RenderContext.usesImgui) {
         // @IMGUI
+        gpuProfiler.beginScope(commandBuffer, "ImGui");
         ImGui::Render();
         ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(),
                                         commandBuffer);
+        gpuProfiler.endScope(commandBuffer);
     }
 
     vkCmdEndRenderPass(commandBuffer);
@@ -537,9 +1797,8 @@ void VulkanRenderer::recordMainRenderPass(Scene& scene, uint32_t imageIndex) {
 
 void VulkanRenderer::recordGeometryPass(Scene& scene) {
     // geometry pass
-    MainPass&          mainPass       = m_RenderContext.renderPasses.mainPass;
-    RenderPassContext& mainRenderPass = mainPass.renderPassContext;
-    VkCommandBuffer&   commandBuffer  = m_Context.commandContext.commandBuffer;
+    MainPass&        mainPass      = m_RenderContext.renderPasses.mainPass;
+    VkCommandBuffer& commandBuffer = m_Context.commandContext.commandBuffer;
 
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -559,153 +1818,15 @@ void VulkanRenderer::recordGeometryPass(Scene& scene) {
     renderPassInfo.pClearValues    = clearValues.data();
 
     vkCmdBeginRenderPass(commandBuffer,
-                         &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width =
-        static_cast<float>(m_Context.swapchainContext.swapChainExtent.width);
-    viewport.height =
-        static_cast<float>(m_Context.swapchainContext.swapChainExtent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = m_Context.swapchainContext.swapChainExtent;
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-    // render meshes
-    {
-        vkCmdBindPipeline(commandBuffer,
-                          VK_PIPELINE_BIND_POINT_GRAPHICS, mainPass.geometryPassPipeline);
-
-        // bind DescriptorSet 0 (Camera Transformations)
-        vkCmdBindDescriptorSets(commandBuffer,
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                mainPass.geometryPassPipelineLayout, 0, 1,
-                                &mainPass.transformDescriptorSet, 0, nullptr);
-
-        // bind DescriptorSet 1 (Materials)
-        vkCmdBindDescriptorSets(commandBuffer,
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                mainPass.geometryPassPipelineLayout, 1, 1,
-                                &mainPass.materialDescriptorSet, 0, nullptr);
-
-        // bind DescriptorSet 2 (Shadows)
-        vkCmdBindDescriptorSets(commandBuffer,
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                mainPass.geometryPassPipelineLayout, 2, 1,
-                                &mainPass.depthDescriptorSet, 0, nullptr);
-
-
-        // create PushConstant object and initialize with default values
-        PushConstant& pushConstant = mainPass.pushConstant;
-        pushConstant.transformation   = glm::mat4(1);
-        pushConstant.worldCamPosition = scene.getCameraRef().getWorldPos();
-        pushConstant.materialIndex    = 0;
-        pushConstant.cascadeCount =
-            m_RenderContext.renderSettings.shadowMappingSettings.numberCascades;
-
-        pushConstant.controlFlags = 0;
-        if(m_RenderContext.imguiData.doPCF)
-            pushConstant.controlFlags |= PCF_CONTROL_BIT;
-        if(m_RenderContext.renderSettings.shadowMappingSettings.visualizeCascades)
-            pushConstant.controlFlags |= CASCADE_VIS_CONTROL_BIT;
-
-        for(EntityId id : SceneView<ModelComponent, Transformation>(scene)) {
-            auto* modelComponent     = scene.getComponent<ModelComponent>(id);
-            auto* transformComponent = scene.getComponent<Transformation>(id);
-
-            Model& model = scene.getSceneData().models[modelComponent->modelIndex];
-
-            // only update transformation matrix if the transformation has changed
-            pushConstant.transformation = transformComponent->getTransformationMatrix();
-            pushConstant.normalsTransformation =
-                transformComponent->getNormalsTransformationMatrix();
-
-            for(auto& meshPartIndex : model.meshPartIndices) {
-                MeshPart& meshPart = scene.getSceneData().meshParts[meshPartIndex];
-                Mesh&     mesh = scene.getSceneData().meshes[meshPart.meshIndex];
-                VkBuffer vertexBuffers[] = {mesh.vertexBuffer};
-                VkDeviceSize offsets[]   = {0};
-
-                pushConstant.materialIndex = meshPart.materialIndex;
-
-                vkCmdBindVertexBuffers(commandBuffer,
-                                       0, 1, vertexBuffers, offsets);
-
-                vkCmdBindIndexBuffer(commandBuffer,
-                                     mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-                vkCmdPushConstants(commandBuffer,
-                                   mainPass.geometryPassPipelineLayout,
-                                   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                                   0,  // offset
-                                   sizeof(PushConstant), &pushConstant);
-
-                m_RenderContext.imguiData.meshDrawCalls++;
-                vkCmdDrawIndexed(commandBuffer,
-                                 mesh.indicesCount, 1, 0, 0, 0);
-            }
-        }
-    }
-
-    // render point lights for stencil shadow volumes
-    if(m_RenderContext.imguiData.pointLights) {
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          m_RenderContext.renderPasses.mainPass.stencilPipeline);
-
-        // bind point light mesh (it will remain the same for each light source
-        Mesh         pointLightMesh  = scene.getSceneData().pointLightMesh;
-        VkBuffer     vertexBuffers[] = {pointLightMesh.vertexBuffer};
-        VkDeviceSize offsets[]       = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1,
-                               vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer,
-                             pointLightMesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-        glm::mat4 projection =
-            getPerspectiveMatrix(m_RenderContext.renderSettings.perspectiveSettings,
-                                 m_Context.swapchainContext.swapChainExtent.width,
-                                 m_Context.swapchainContext.swapChainExtent.height);
-        // one tutorial says openGL has different convention for Y
-        // coordinates in clip space than vulkan, need to flip it
-        projection[1][1] *= -1;
-        StencilPushConstant& stencilPushConstant = mainPass.stencilPushConstant;
-        stencilPushConstant.projView =
-            projection * scene.getCameraRef().getCameraMatrix();
-
-        // sending push constant to GPU
-        vkCmdPushConstants(commandBuffer,
-                           m_RenderContext.renderPasses.mainPass.stencilPipelineLayout,
-                           VK_SHADER_STAGE_VERTEX_BIT,
-                           0,  // offset
-                           sizeof(StencilPushConstant), &stencilPushConstant);
-
-        // draw icosphere per point light
-        for(PointLight& pointLight : scene.getSceneData().lights) {
-            // build transformation matrix for vertex shader
-            glm::mat4 scaleMat = glm::scale(glm::mat4(1), glm::vec3(pointLight.radius));
-            glm::mat4 translateMat = glm::translate(glm::mat4(1), pointLight.position);
-
-            stencilPushConstant.transformation = translateMat * scaleMat;
-
-            // sending push constant to GPU
-            vkCmdPushConstants(commandBuffer,
-                               m_RenderContext.renderPasses.mainPass.stencilPipelineLayout,
-                               VK_SHADER_STAGE_VERTEX_BIT,
-                               0,  // offset
-                               sizeof(StencilPushConstant), &stencilPushConstant);
-
-            m_RenderContext.imguiData.lightDrawCalls++;
-
-            vkCmdDrawIndexed(commandBuffer,
-                             pointLightMesh.indicesCount, 1, 0, 0, 0);
-        }
+                         &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    // the slices of the meshes followed by the point lights for the stencil
+    // shadow volumes
+    uint32_t geometryCommandBufferCount =
+        static_cast<uint32_t>(secondaryCommandBuffers.size()) - shadowCommandBufferCount;
+    if(geometryCommandBufferCount > 0) {
+        vkCmdExecuteCommands(commandBuffer, geometryCommandBufferCount,
+                             &secondaryCommandBuffers[shadowCommandBufferCount]);
     }
 
     vkCmdEndRenderPass(commandBuffer);
@@ -713,12 +1834,6 @@ void VulkanRenderer::recordGeometryPass(Scene& scene) {
 
 
 void VulkanRenderer::createSyncObjects(VulkanBaseContext& baseContext) {
-    /*
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    */
-
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
@@ -726,16 +1841,13 @@ void VulkanRenderer::createSyncObjects(VulkanBaseContext& baseContext) {
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    /*
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    }
-     */
+    for(uint32_t frame = 0; frame < m_Context.graphicSettings.framesInFlight; frame++) {
+        if(vkCreateSemaphore(baseContext.device, &semaphoreInfo, nullptr, &m_ImageAvailableSemaphores[frame]) != VK_SUCCESS
+           || vkCreateSemaphore(baseContext.device, &semaphoreInfo, nullptr, &m_RenderFinishedSemaphores[frame]) != VK_SUCCESS
+           || vkCreateFence(baseContext.device, &fenceInfo, nullptr, &m_InFlightFences[frame]) != VK_SUCCESS) {
 
-    if(vkCreateSemaphore(baseContext.device, &semaphoreInfo, nullptr, &m_ImageAvailableSemaphore) != VK_SUCCESS
-       || vkCreateSemaphore(baseContext.device, &semaphoreInfo, nullptr, &m_RenderFinishedSemaphore) != VK_SUCCESS
-       || vkCreateFence(baseContext.device, &fenceInfo, nullptr, &m_InFlightFence) != VK_SUCCESS) {
-
-        throw std::runtime_error("failed to create synchronization objects for a frame!");
+            throw std::runtime_error("failed to create synchronization objects for a frame!");
+        }
     }
 }
 
@@ -756,7 +1868,8 @@ void VulkanRenderer::updateUniformBuffer(Scene& scene) {
 
     // PushConstants would be more efficient for often changing small data buffers
 
-    memcpy(m_RenderContext.renderPasses.mainPass.transformBuffer.bufferMemoryMapping,
+    memcpy(m_RenderContext.renderPasses.mainPass.transformBuffers[m_CurrentFrame]
+               .bufferMemoryMapping,
            &cameraUniform, sizeof(CameraUniform));
 
 
@@ -769,7 +1882,8 @@ void VulkanRenderer::updateUniformBuffer(Scene& scene) {
     lightingInformation.shadows = m_RenderContext.imguiData.shadows;
     lightingInformation.iblFactor = m_RenderContext.imguiData.iblFactor;
 
-    memcpy(m_RenderContext.renderPasses.mainPass.lightingBuffer.bufferMemoryMapping,
+    memcpy(m_RenderContext.renderPasses.mainPass.lightingBuffers[m_CurrentFrame]
+               .bufferMemoryMapping,
            &lightingInformation, sizeof(LightingInformation));
     // memcpy(scene.getUniformBufferMapping(), &sceneTransform, sizeof(sceneTransform));
 }
@@ -822,6 +1936,18 @@ void VulkanRenderer::recompileToSecondaryPipeline() {
         mainPass.renderPassContext.renderPassDescription,
         mainPass);
 
+    // rebuild GPU culling pipeline
+    CullingPass& cullingPass = m_RenderContext.renderPasses.cullingPass;
+    cleanCullingPipeline(baseContext, cullingPass);
+    createCullingPipeline(m_Context, cullingPass);
+
+    // rebuild light tiling and tiled lighting pipeline
+    LightTilingPass& lightTilingPass = m_RenderContext.renderPasses.lightTilingPass;
+    cleanLightTilingPipeline(baseContext, lightTilingPass);
+    createLightTilingPipeline(m_Context, m_RenderContext);
+    cleanTiledLightingPipeline(baseContext, lightTilingPass);
+    createTiledLightingPipeline(m_Context, m_RenderContext);
+
     // rebuild skybox pipeline
     cleanSkyboxPipeline(baseContext, mainPass);
     createSkyboxPipeline(m_Context, m_RenderContext,
@@ -6,25 +6,205 @@
 
 
 #include "ApplicationContext.h"
+#include "GpuProfiler.h"
 #include "window.h"
 #include "scene/Scene.h"
+#include "scene/FrustumCulling.h"
+#include "rendering/DrawList.h"
+#include "rendering/CSMUtils.h"
 #include "rendering/RenderContext.h"
+#include "rendering/RenderGraph.h"
+#include "utils/ThreadPool.h"
 #include <vulkan/vulkan_core.h>
 
 class VulkanRenderer {
 
 private:
-    VkSemaphore m_ImageAvailableSemaphore;
-    VkSemaphore m_RenderFinishedSemaphore;
-    VkFence m_InFlightFence;
+    // one set per frame in flight, only the first framesInFlight are created
+    VkSemaphore m_ImageAvailableSemaphores[MAX_FRAMES_IN_FLIGHT];
+    VkSemaphore m_RenderFinishedSemaphores[MAX_FRAMES_IN_FLIGHT];
+    VkFence m_InFlightFences[MAX_FRAMES_IN_FLIGHT];
+
+    // the frame in flight that is being recorded, selects the command buffer
+    // and the per frame resources of the passes
+    uint32_t m_CurrentFrame = 0;
 
     ApplicationVulkanContext &m_Context;
     RenderContext &m_RenderContext;
+    // the workers of the pool and the main thread record the secondary
+    // command buffers of the shadow and the geometry pass
+    ThreadPool &m_ThreadPool;
+
+    // command pool of one recording thread for one frame in flight, it is
+    // reset once the frame is done and its command buffers get reused
+    struct RecordingPool
+    {
+        VkCommandPool                commandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> commandBuffers;
+        uint32_t                     usedCommandBuffers = 0;
+    };
 
+    // [frame * recordingThreads + thread], the last thread of each frame is
+    // the one that is not a worker of the thread pool
+    std::vector<RecordingPool> recordingPools;
+    uint32_t                   recordingThreads = 0;
+
+    // counts the rendered frames, the far cascades are updated at intervals
     int frameNumber = 0;
 
+    // an entity with a model and the components needed to draw it
+    struct ModelEntity
+    {
+        EntityId        id;
+        ModelComponent* model;
+        Transformation* transformation;
+        // moved by the physics or the player, drawn on top of the cached
+        // static shadow casters each frame
+        bool dynamic;
+    };
+
+    // all entities with a model, their world bounds and one draw per MeshPart
+    // sorted by sort key, extracted once per frame by extractDrawList() for
+    // both passes and kept between frames so the storage is reused
+    std::vector<ModelEntity> modelEntities;
+    CullingBatch             modelBounds;
+    DrawList                 drawList;
+    // 1 for each entry of modelEntities inside the camera frustum or inside
+    // the shadow caster volume of a cascade
+    std::vector<uint8_t> visibleModels;
+    std::vector<uint8_t> shadowCasters[MAX_CASCADES];
+    // the entity of the player, some of its MeshParts may not cast shadows
+    EntityId playerEntity = INVALID_ENTITY_ID;
+    // the entity whose ObjectData every slot of the object buffer of a frame
+    // in flight holds, INVALID_ENTITY_ID if it is outdated
+    std::vector<EntityId> writtenObjects[MAX_FRAMES_IN_FLIGHT];
+
+    // first draw list item of every slice of the geometry pass followed by the
+    // number of items, see splitDrawList()
+    std::vector<size_t> drawSlices;
+
+    struct DrawStatistics
+    {
+        int drawCalls    = 0;
+        int instances    = 0;
+        int skippedBinds = 0;
+    };
+
+    // the secondary command buffers of the shadow pass followed by the ones
+    // of the geometry pass, each recorded by one task
+    std::vector<VkCommandBuffer> secondaryCommandBuffers;
+    std::vector<DrawStatistics>  secondaryStatistics;
+    uint32_t                     shadowCommandBufferCount = 0;
+    // the first ones of the shadow pass draw into the cache
+    uint32_t                     staticCommandBufferCount = 0;
+
+    // light projection * view matrices of the active cascades
+    std::vector<glm::mat4> cascadeViewProjections;
+
+    // how the shadow map of a cascade is brought up to date this frame
+    enum class CascadeUpdate
+    {
+        // the shadow map of an earlier frame is still used
+        Skip,
+        // all shadow casters are drawn
+        Full,
+        // the cached static casters are copied and the dynamic casters are
+        // drawn on top of them
+        Dynamic,
+        // the static casters are drawn into the cache before Dynamic
+        StaticAndDynamic
+    };
+
+    // a slice of the draw list drawn into all updated cascades at once, the
+    // GPU culling records a single task
+    struct ShadowTask
+    {
+        // draws the static casters into the cache instead of the shadow map
+        bool     staticCasters;
+        uint32_t slice;
+    };
+
+    // bounds of a stabilized cascade, kept until the part of the camera
+    // frustum the cascade has to cover leaves them
+    struct CascadeCache
+    {
+        bool          valid = false;
+        // the static casters were drawn into the cache for these bounds
+        bool          staticCached = false;
+        CascadeSphere sphere{};
+        glm::mat4     viewProjection;
+        int           lastUpdateFrame = 0;
+    };
+
+    CascadeCache            cascadeCaches[MAX_CASCADES];
+    CascadeUpdate           cascadeUpdates[MAX_CASCADES];
+    std::vector<ShadowTask> shadowTasks;
+
+    // bit i stands for cascade i: the cascades drawn this frame, the ones of
+    // them that are cleared before, the ones that start with a copy of the
+    // cached static casters and the ones whose cache is drawn first
+    uint32_t updatedCascades = 0;
+    uint32_t clearedCascades = 0;
+    uint32_t copiedCascades  = 0;
+    uint32_t staticCascades  = 0;
+    // the layers of the shadow maps and the cache are undefined until the
+    // first shadow pass
+    bool shadowMapsDefined       = false;
+    bool staticShadowMapsDefined = false;
+
+    // the settings the cached cascades were drawn with, all caches are
+    // invalidated when one of them changes
+    glm::vec3 cachedLightDirection     = glm::vec3(0);
+    float     cachedLightCameraZOffset = 0;
+    float     cachedCacheMargin        = 0;
+    float     cachedDepthBiasConstant  = 0;
+    float     cachedDepthBiasSlope     = 0;
+    int       cachedNumberCascades     = 0;
+    // a static model entity was added, removed or moved since the last frame
+    bool   staticCastersChanged = true;
+    size_t staticModelCount     = 0;
+
+    // all draws of the meshes in a block of the geometry pool, they are a
+    // range of the indirect commands of every view of the culling pass
+    struct IndirectBatch
+    {
+        uint32_t geometryBlock;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    std::vector<IndirectBatch> indirectBatches;
+    // index into indirectBatches for every geometry block, -1 if unused
+    std::vector<int> blockBatches;
+    // layout of the command and the count buffer of the last culling pass of
+    // every frame in flight
+    uint32_t culledViews[MAX_FRAMES_IN_FLIGHT]     = {};
+    uint32_t commandsPerView[MAX_FRAMES_IN_FLIGHT] = {};
+    uint32_t countsPerView[MAX_FRAMES_IN_FLIGHT]   = {};
+
+    // spheres of all point lights, rebuilt when SceneData::lightsVersion changes
+    CullingBatch         lightBounds;
+    uint32_t             lightBoundsVersion = 0;
+    std::vector<uint8_t> lightVisibility;
+    // indices into SceneData::lights of the lights drawn this frame, the light
+    // buffer of the frame holds them in this order
+    std::vector<uint32_t> visibleLights;
+    // SceneData::lightsVersion and visibleLights of the lights in the light
+    // buffer of every frame in flight
+    uint32_t              uploadedLightsVersions[MAX_FRAMES_IN_FLIGHT] = {};
+    std::vector<uint32_t> uploadedLights[MAX_FRAMES_IN_FLIGHT];
+
+    // the passes of the frame and the barriers between them, rebuilt every
+    // frame from the enabled passes
+    RenderGraph renderGraph;
+
+    // GPU times of the passes of the render graph and of the draws of the
+    // lighting pass
+    GpuProfiler gpuProfiler;
+
 public:
-    VulkanRenderer(ApplicationVulkanContext &context, RenderContext &renderContext);
+    VulkanRenderer(ApplicationVulkanContext &context, RenderContext &renderContext,
+                   ThreadPool &threadPool);
 
     void cleanVulkanRessources();
 
@@ -36,9 +216,130 @@ public:
 
     ApplicationVulkanContext getContext();
 
+    const GpuProfiler &getGpuProfiler() const { return gpuProfiler; }
+
 private:
     void recordCommandBuffer(Scene &scene, uint32_t imageIndex);
 
+    // Adds the enabled passes of this frame and the resources they read and
+    // write to the render graph, which records the barriers between them.
+    void buildRenderGraph(Scene &scene, uint32_t imageIndex);
+
+    // A system that runs while the simulation of the frame runs, it only reads
+    // the matrices and the world bounds of the last updateTransformations().
+    void extractDrawList(Scene &scene);
+
+    // writes the ObjectData of the model entities that changed since the
+    // object buffer of the current frame was written the last time
+    void updateObjectBuffer(Scene &scene);
+
+    // Writes the InstanceData of the items [begin, end) of the draw list for
+    // which getCascadeMask(item) is not 0 to the instance buffer starting at
+    // firstInstance and records one instanced draw per MeshPart. With
+    // splitCascades every item gets one instance per bit of its mask, so each
+    // instance is drawn into a single layer of the shadow maps.
+    template<typename Filter>
+    void recordInstancedDraws(Scene &scene, VkCommandBuffer commandBuffer, size_t begin,
+                              size_t end, uint32_t firstInstance, bool splitCascades,
+                              const Filter &getCascadeMask, DrawStatistics &statistics);
+
+    // binds the vertex and index buffer of a block of the geometry pool
+    void bindGeometryBlock(VkCommandBuffer commandBuffer, Scene &scene, uint32_t blockIndex);
+
+    void createRecordingPools();
+
+    // resets the command pools of the current frame, its fence was waited for
+    void resetRecordingPools();
+
+    // Takes a command buffer from the pool of the calling thread and begins it
+    // as secondary command buffer inside the first subpass of renderPass.
+    VkCommandBuffer beginSecondaryCommandBuffer(VkRenderPass renderPass, VkFramebuffer framebuffer);
+
+    // Records the secondary command buffers of the shadow pass and of the
+    // slices of the geometry pass in parallel. The passes only execute them.
+    void recordSecondaryCommandBuffers(Scene &scene);
+
+    // decides which layers of the shadow maps are cleared, copied and drawn
+    void updateCascadeMasks();
+
+    VkCommandBuffer recordShadowSlice(Scene &scene, const ShadowTask &task,
+                                      DrawStatistics &statistics);
+
+    // binds the pipeline and the descriptor sets of the geometry pass
+    VkCommandBuffer beginGeometryCommandBuffer();
+
+    // draws the items of a slice of the draw list, or all items with indirect
+    // draws if the culling is done on the GPU
+    VkCommandBuffer recordGeometrySlice(Scene &scene, uint32_t slice, DrawStatistics &statistics);
+
+    // the point light volumes for the stencil test
+    VkCommandBuffer recordLightStencil(Scene &scene, DrawStatistics &statistics);
+
+    // Culls the point lights against the camera frustum and keeps the
+    // maxLights most important ones if the light budget is enabled.
+    void cullLights(Scene &scene);
+
+    // writes the visible lights into the light buffer of the current frame
+    void uploadLights(Scene &scene);
+
+    // calculates the cascades and uploads their matrices and split depths
+    void updateShadowCascades(Scene &scene);
+
+    // Keeps the bounds of every stabilized cascade until the camera moved too
+    // far and decides which casters of the cascades have to be drawn.
+    void updateStableCascades(glm::mat4 inverseViewProjection,
+                              std::vector<SplitDummyStruct> &splitDepths);
+
+    bool useShadowCache() const {
+        const ShadowMappingSettings &shadowSettings =
+            m_RenderContext.renderSettings.shadowMappingSettings;
+        // the indirect draws of the GPU culling do not know the static casters
+        return shadowSettings.stabilizeCascades && shadowSettings.cacheStaticShadows
+               && !useGpuCulling();
+    }
+
+    // clears the layers of the cascades in the mask, the image is in the
+    // transfer destination layout
+    void recordShadowClear(VkImage image, uint32_t cascadeMask);
+
+    // copies the cached static casters of the copied cascades into the
+    // shadow maps
+    void recordStaticShadowCopy();
+
+    // moves all layers of the cache of the static casters to the transfer
+    // destination layout, the layers that are not cleared or drawn keep their
+    // content (the render graph does this for the shadow maps)
+    void recordShadowMapTransition(VkImage image, VkImageLayout oldLayout,
+                                   VkPipelineStageFlags srcStage);
+
+    Frustum getCameraFrustum(Scene &scene);
+
+    bool useGpuCulling() const {
+        return m_RenderContext.imguiData.gpuCulling && m_Context.baseContext.supportsIndirectCount;
+    }
+
+    // Uploads the instances and their bounds for the culling pass and decides
+    // the layout of its command and count buffers.
+    void updateCullingBuffers(Scene &scene);
+
+    // records the compute pass that writes the indirect draws of the camera
+    // and the cascades
+    void recordCullingPass();
+
+    // one vkCmdDrawIndexedIndirectCount per batch for a view of the culling
+    // pass, so a single one if all meshes are in one block
+    void recordIndirectDraws(VkCommandBuffer commandBuffer, Scene &scene, uint32_t view,
+                             int &drawCalls);
+
+    // the point lights are shaded per screen tile instead of with light volumes
+    bool useTiledLighting() const {
+        return m_RenderContext.imguiData.pointLights && m_RenderContext.imguiData.tiledLighting;
+    }
+
+    // Records the compute pass that bins the point lights into the screen
+    // tiles with the depth of the geometry pass.
+    void recordLightTilingPass(Scene &scene);
+
     void recordShadowPass(Scene &scene, uint32_t imageIndex);
 
     void recordMainRenderPass(Scene &scene, uint32_t imageIndex);
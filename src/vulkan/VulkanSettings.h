@@ -1,10 +1,19 @@
 #ifndef GRAPHICSPRAKTIKUM_VULKANSETTINGS_H
 #define GRAPHICSPRAKTIKUM_VULKANSETTINGS_H
 
+#include <cstdint>
 #include <vector>
 
 static const bool enableValidationLayers = true;
 
+// upper limit of GraphicSettings::framesInFlight, the per frame resources are
+// arrays of this size
+const uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
+// minimum number of draw list items per secondary command buffer of the
+// geometry pass, smaller slices are not worth a task of their own
+const uint32_t RECORDING_SLICE_ITEMS = 512;
+
 const std::vector<const char *> validationLayers = {
         "VK_LAYER_KHRONOS_validation"
 };
@@ -39,7 +39,8 @@ void initializeSwapChain(ApplicationVulkanContext &appContext) {
 
 void initializeCommandContext(ApplicationVulkanContext &appContext) {
     createCommandPool(appContext.baseContext, appContext.commandContext);
-    createCommandBuffers(appContext.baseContext, appContext.commandContext);
+    createCommandBuffers(appContext.baseContext, appContext.commandContext,
+                         appContext.graphicSettings.framesInFlight);
 }
 
 void createInstance(VulkanBaseContext &context) {
@@ -196,6 +197,7 @@ void pickPhysicalDevice(VulkanBaseContext &context, GraphicSettings &graphicSett
 
     context.maxSupportedMinorVersion = VK_API_VERSION_MINOR(deviceProperties.apiVersion);
     context.maxSamplerAnisotropy = deviceProperties.limits.maxSamplerAnisotropy;
+    context.timestampPeriod = deviceProperties.limits.timestampPeriod;
 
     if (context.physicalDevice == VK_NULL_HANDLE) {
         throw std::runtime_error("failed to find a suitable GPU!");
@@ -218,9 +220,37 @@ void createLogicalDevice(VulkanBaseContext &context) {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // indirect draws with a count buffer are core since Vulkan 1.2 (lavapipe
+    // supports them as well), without them the culling stays on the CPU
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, nullptr};
+    VkPhysicalDeviceMultiviewFeatures supportedMultiviewFeatures{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES, nullptr};
+    VkPhysicalDeviceFeatures2 supportedFeatures{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                                                &supportedMultiviewFeatures};
+    // the Vulkan 1.2 features can only be queried from Vulkan 1.2 on
+    if(context.maxSupportedMinorVersion >= 2) {
+        supportedMultiviewFeatures.pNext = &supportedVulkan12Features;
+    }
+    if(context.maxSupportedMinorVersion >= 1) {
+        vkGetPhysicalDeviceFeatures2(context.physicalDevice, &supportedFeatures);
+    }
+    context.supportsIndirectCount = context.maxSupportedMinorVersion >= 2
+                                    && supportedVulkan12Features.drawIndirectCount
+                                    && supportedFeatures.features.multiDrawIndirect;
+
+    // multiview is core since Vulkan 1.1, writing gl_Layer in the vertex
+    // shader since Vulkan 1.2
+    context.supportsMultiview = context.maxSupportedMinorVersion >= 1
+                                && supportedMultiviewFeatures.multiview;
+    context.supportsShaderOutputLayer = context.maxSupportedMinorVersion >= 2
+                                        && supportedVulkan12Features.shaderOutputLayer;
+
     // enabling necessary features
     VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT, nullptr};
+    VkPhysicalDeviceVulkan12Features vulkan12Features{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, nullptr};
     VkPhysicalDeviceFeatures2 deviceFeatures2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
                                               &indexingFeatures};
     indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
@@ -229,6 +259,33 @@ void createLogicalDevice(VulkanBaseContext &context) {
     deviceFeatures2.features.sampleRateShading       = VK_TRUE;
     deviceFeatures2.pNext                            = &indexingFeatures;
 
+    // the descriptor indexing features must be part of the Vulkan 1.2
+    // features if those are used
+    bool useVulkan12Features =
+        context.supportsIndirectCount
+        || (!context.supportsMultiview && context.supportsShaderOutputLayer);
+    if(useVulkan12Features) {
+        vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        vulkan12Features.runtimeDescriptorArray          = VK_TRUE;
+        deviceFeatures2.pNext                            = &vulkan12Features;
+    }
+    if(context.supportsIndirectCount) {
+        vulkan12Features.drawIndirectCount         = VK_TRUE;
+        deviceFeatures2.features.multiDrawIndirect = VK_TRUE;
+    }
+
+    // the shadow pass only uses gl_Layer if multiview is missing
+    VkPhysicalDeviceMultiviewFeatures multiviewFeatures{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES, nullptr};
+    if(context.supportsMultiview) {
+        multiviewFeatures.multiview       = VK_TRUE;
+        multiviewFeatures.pNext           = deviceFeatures2.pNext;
+        deviceFeatures2.pNext             = &multiviewFeatures;
+        context.supportsShaderOutputLayer = false;
+    } else if(context.supportsShaderOutputLayer) {
+        vulkan12Features.shaderOutputLayer = VK_TRUE;
+    }
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
@@ -253,6 +310,13 @@ void createLogicalDevice(VulkanBaseContext &context) {
 
     context.graphicsQueueFamily = indices.graphicsFamily.value();
 
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(context.physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(context.physicalDevice, &queueFamilyCount,
+                                             queueFamilies.data());
+    context.timestampValidBits = queueFamilies[context.graphicsQueueFamily].timestampValidBits;
+
     vkGetDeviceQueue(context.device, indices.graphicsFamily.value(), 0, &context.graphicsQueue);
     vkGetDeviceQueue(context.device, indices.presentFamily.value(), 0, &context.presentQueue);
 }
@@ -434,18 +498,19 @@ void createDepthResources(VulkanBaseContext &baseContext, SwapchainContext &swap
     swapchainContext.depthImage.imageView = createImageView(baseContext, swapchainContext.depthImage.image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
 }
 
-void createCommandBuffers(VulkanBaseContext &baseContext, CommandContext &commandContext) {
-    // context.commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+void createCommandBuffers(VulkanBaseContext &baseContext, CommandContext &commandContext, uint32_t framesInFlight) {
+    if (framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT) {
+        throw std::runtime_error("number of frames in flight is out of range!");
+    }
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = commandContext.commandPool;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = 1;
-    // allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+    allocInfo.commandBufferCount = framesInFlight;
 
-    // if (vkAllocateCommandBuffers(context.device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-    if (vkAllocateCommandBuffers(baseContext.device, &allocInfo, &commandContext.commandBuffer) != VK_SUCCESS) {
+    if (vkAllocateCommandBuffers(baseContext.device, &allocInfo, commandContext.commandBuffers) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate command buffers!");
     }
+    commandContext.commandBuffer = commandContext.commandBuffers[0];
 }
\ No newline at end of file
@@ -50,5 +50,5 @@ void createColorResources(VulkanBaseContext &baseContext, SwapchainContext &swap
 
 void createDepthResources(VulkanBaseContext &baseContext, SwapchainContext &swapchainContext, GraphicSettings &graphicSettings);
 
-void createCommandBuffers(VulkanBaseContext &baseContext, CommandContext &commandContext);
+void createCommandBuffers(VulkanBaseContext &baseContext, CommandContext &commandContext, uint32_t framesInFlight);
 #endif  // GRAPHICSPRAKTIKUM_VULKANSETUP_H
@@ -294,6 +294,32 @@ VkImageView createImageView(const VulkanBaseContext& context,
     return imageView;
 }
 
+VkImageView createImageArrayView(const VulkanBaseContext& context,
+                                 VkImage                  image,
+                                 VkFormat                 format,
+                                 VkImageAspectFlags       aspectFlags,
+                                 uint32_t                 layerCount) {
+    VkImageViewCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    createInfo.image = image;
+
+    createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    createInfo.format   = format;
+
+    createInfo.subresourceRange.aspectMask     = aspectFlags;
+    createInfo.subresourceRange.baseMipLevel   = 0;
+    createInfo.subresourceRange.levelCount     = 1;
+    createInfo.subresourceRange.baseArrayLayer = 0;
+    createInfo.subresourceRange.layerCount     = layerCount;
+
+    VkImageView imageView;
+    if(vkCreateImageView(context.device, &createInfo, nullptr, &imageView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create image view!");
+    }
+
+    return imageView;
+}
+
 void createBuffer(const VulkanBaseContext& context,
                   VkDeviceSize             size,
                   VkBufferUsageFlags       usage,